@@ -277,6 +277,27 @@ class GLEW(Library):
 		else:
 			return flags
 
+class LibDeflate(Library):
+	libName = 'deflate'
+	makeName = 'LIBDEFLATE'
+	header = '<libdeflate.h>'
+	function = 'libdeflate_alloc_decompressor'
+
+	@classmethod
+	def isSystemLibrary(cls, platform):
+		# Optional, so not (yet) part of the 3rd party library builds: only
+		# used when it's installed on the system.
+		return True
+
+	@classmethod
+	def getVersion(cls, platform, linkStatic, distroRoot):
+		def execute(cmd, log):
+			version = cmd.expand(log, cls.getHeaders(platform),
+				'LIBDEFLATE_VERSION_STRING'
+				)
+			return None if version is None else version.strip('"')
+		return execute
+
 class LibPNG(Library):
 	libName = 'png16'
 	makeName = 'PNG'
@@ -68,6 +68,14 @@ class GLEW(DownloadablePackage):
 	def getTarballName(cls):
 		return '%s-%s.tgz' % (cls.sourceName, cls.version)
 
+class LibDeflate(Package):
+	niceName = 'libdeflate'
+	sourceName = 'libdeflate'
+
+	@classmethod
+	def getMakeName(cls):
+		return 'LIBDEFLATE'
+
 class LibPNG(DownloadablePackage):
 	downloadURL = 'http://downloads.sourceforge.net/libpng'
 	niceName = 'libpng'
@@ -17,11 +17,16 @@ set_help_text filepool \
 
   filepool reset
     Reset the filepool settings to the default values.
+
+  filepool reindex
+    Scan all filepool directories in the background and calculate the sha1sums
+    of new or modified files, so that later lookups are fast. Calling this
+    again while indexing is in progress shows the progress.
 }
 
 proc filepool_completion {args} {
 	if {[llength $args] == 2} {
-		return [list list add remove reset]
+		return [list list add remove reset reindex]
 	}
 	return [list -path -types -position system_rom rom disk tape]
 }
@@ -36,8 +41,9 @@ proc filepool {args} {
 		"add"    {filepool_add {*}$args}
 		"remove" {filepool_remove $args}
 		"reset"  {filepool_reset}
+		"reindex" {__filepool_reindex}
 		"default" {
-			error "Invalid subcommand, expected one of 'list add remove reset', but got '$cmd'"
+			error "Invalid subcommand, expected one of 'list add remove reset reindex', but got '$cmd'"
 		}
 	}
 }
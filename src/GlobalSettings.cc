@@ -1,6 +1,8 @@
 #include "GlobalSettings.hh"
 #include "SettingsConfig.hh"
 #include "GlobalCommandController.hh"
+#include "CompressedFileAdapter.hh"
+#include "FileOperations.hh"
 #include "strCat.hh"
 #include "view.hh"
 #include "xrange.hh"
@@ -43,14 +45,27 @@ GlobalSettings::GlobalSettings(GlobalCommandController& commandController_)
 			{"hq",   ResampledSoundDevice::RESAMPLE_HQ},
 			{"fast", ResampledSoundDevice::RESAMPLE_LQ},
 			{"blip", ResampledSoundDevice::RESAMPLE_BLIP}})
+	, decompressCacheSizeSetting(commandController, "decompress_cache_size",
+		"amount of memory (in MB) used to keep recently used decompressed (gz/zip) files",
+		64, 0, 4096)
+	, decompressCacheDirSetting(commandController, "decompress_cache_dir",
+		"directory in which decompressed (gz/zip) files are stored, so that later "
+		"sessions can reuse them; leave empty to disable",
+		"")
 	, speedManager(commandController)
 	, throttleManager(commandController)
 {
 	getPowerSetting().attach(*this);
+	decompressCacheSizeSetting.attach(*this);
+	decompressCacheDirSetting.attach(*this);
+	update(decompressCacheSizeSetting);
+	update(decompressCacheDirSetting);
 }
 
 GlobalSettings::~GlobalSettings()
 {
+	decompressCacheDirSetting.detach(*this);
+	decompressCacheSizeSetting.detach(*this);
 	getPowerSetting().detach(*this);
 	commandController.getSettingsConfig().setSaveSettings(
 		autoSaveSetting.getBoolean());
@@ -69,6 +84,12 @@ void GlobalSettings::update(const Setting& setting) noexcept
 			// Ignore. E.g. can trigger when a Tcl trace on the
 			// pause setting triggers errors in the Tcl script.
 		}
+	} else if (&setting == &decompressCacheSizeSetting) {
+		CompressedFileAdapter::setCacheSize(
+			size_t(decompressCacheSizeSetting.getInt()) * 1024 * 1024);
+	} else if (&setting == &decompressCacheDirSetting) {
+		CompressedFileAdapter::setDiskCacheDirectory(
+			FileOperations::expandTilde(std::string(decompressCacheDirSetting.getString())));
 	}
 }
 
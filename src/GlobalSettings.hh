@@ -4,6 +4,7 @@
 #include "Observer.hh"
 #include "BooleanSetting.hh"
 #include "EnumSetting.hh"
+#include "FilenameSetting.hh"
 #include "IntegerSetting.hh"
 #include "StringSetting.hh"
 #include "SpeedManager.hh"
@@ -69,6 +70,8 @@ private:
 	StringSetting  invalidPsgDirectionsSetting;
 	StringSetting  invalidPpiModeSetting;
 	EnumSetting<ResampledSoundDevice::ResampleType> resampleSetting;
+	IntegerSetting decompressCacheSizeSetting;
+	FilenameSetting decompressCacheDirSetting;
 	SpeedManager speedManager;
 	ThrottleManager throttleManager;
 };
@@ -1,5 +1,6 @@
 #include "MSXMotherBoard.hh"
 
+#include "AccessStats.hh"
 #include "BooleanSetting.hh"
 #include "CartridgeSlotManager.hh"
 #include "CassettePort.hh"
@@ -17,6 +18,7 @@
 #include "InfoTopic.hh"
 #include "JoystickPort.hh"
 #include "LedStatus.hh"
+#include "MemorySearch.hh"
 #include "MSXCPU.hh"
 #include "MSXCPUInterface.hh"
 #include "MSXCliComm.hh"
@@ -33,6 +35,7 @@
 #include "RealTime.hh"
 #include "RenShaTurbo.hh"
 #include "ReverseManager.hh"
+#include "SamplingProfiler.hh"
 #include "Schedulable.hh"
 #include "Scheduler.hh"
 #include "SimpleDebuggable.hh"
@@ -253,6 +256,9 @@ MSXMotherBoard::MSXMotherBoard(Reactor& reactor_)
 	machineMediaInfo = make_unique<MachineMediaInfo>(*this);
 	deviceInfo = make_unique<DeviceInfo>(*this);
 	debugger = make_unique<Debugger>(*this);
+	samplingProfiler = make_unique<SamplingProfiler>(*this);
+	memorySearch = make_unique<MemorySearch>(*this);
+	accessStats = make_unique<AccessStats>(*this);
 
 	msxMixer->mute(); // powered down
 
@@ -18,6 +18,7 @@
 
 namespace openmsx {
 
+class AccessStats;
 class AddRemoveUpdate;
 class CartridgeSlotManager;
 class CassettePortInterface;
@@ -38,6 +39,7 @@ class MachineExtensionInfo;
 class MachineMediaInfo;
 class MachineNameInfo;
 class MachineTypeInfo;
+class MemorySearch;
 class MSXCliComm;
 class MSXCommandController;
 class MSXCPU;
@@ -55,6 +57,7 @@ class RemoveExtCmd;
 class RenShaTurbo;
 class ResetCmd;
 class ReverseManager;
+class SamplingProfiler;
 class SettingObserver;
 class Scheduler;
 class StateChangeDistributor;
@@ -149,6 +152,9 @@ public:
 	[[nodiscard]] CartridgeSlotManager& getSlotManager() { return *slotManager; }
 	[[nodiscard]] RealTime& getRealTime() { return *realTime; }
 	[[nodiscard]] Debugger& getDebugger() { return *debugger; }
+	[[nodiscard]] SamplingProfiler& getSamplingProfiler() { return *samplingProfiler; }
+	[[nodiscard]] MemorySearch& getMemorySearch() { return *memorySearch; }
+	[[nodiscard]] AccessStats& getAccessStats() { return *accessStats; }
 	[[nodiscard]] MSXMixer& getMSXMixer() { return *msxMixer; }
 	[[nodiscard]] PluggingController& getPluggingController();
 	[[nodiscard]] MSXCPU& getCPU();
@@ -272,6 +278,9 @@ private:
 	std::unique_ptr<EventDelay> eventDelay;
 	std::unique_ptr<RealTime> realTime;
 	std::unique_ptr<Debugger> debugger;
+	std::unique_ptr<SamplingProfiler> samplingProfiler;
+	std::unique_ptr<MemorySearch> memorySearch;
+	std::unique_ptr<AccessStats> accessStats;
 	std::unique_ptr<MSXMixer> msxMixer;
 	// machineMediaInfo must be BEFORE PluggingController!
 	std::unique_ptr<MachineMediaInfo> machineMediaInfo;
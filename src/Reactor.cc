@@ -20,6 +20,7 @@
 #include "GlobalCommandController.hh"
 #include "GlobalSettings.hh"
 #include "HardwareConfig.hh"
+#include "HostProfiler.hh"
 #include "ImGuiManager.hh"
 #include "InfoTopic.hh"
 #include "InputEventGenerator.hh"
@@ -31,6 +32,7 @@
 #include "RTScheduler.hh"
 #include "RomDatabase.hh"
 #include "RomInfo.hh"
+#include "SharedMemoryExporter.hh"
 #include "StateChangeDistributor.hh"
 #include "SymbolManager.hh"
 #include "TclCallbackMessages.hh"
@@ -270,6 +272,8 @@ void Reactor::init()
 	setClipboardCommand = make_unique<SetClipboardCommand>(
 		*globalCommandController, *this);
 	aviRecordCommand = make_unique<AviRecorder>(*this);
+	sharedMemoryExporter = make_unique<SharedMemoryExporter>(*this);
+	hostProfiler = make_unique<HostProfiler>(*this);
 	extensionInfo = make_unique<ConfigInfo>(
 		getOpenMSXInfoCommand(), "extensions");
 	machineInfo   = make_unique<ConfigInfo>(
@@ -56,6 +56,8 @@ class AviRecorder;
 class ConfigInfo;
 class RealTimeInfo;
 class SoftwareInfoTopic;
+class SharedMemoryExporter;
+class HostProfiler;
 class SymbolManager;
 
 extern int exitCode;
@@ -97,6 +99,7 @@ public:
 	[[nodiscard]] const HotKey& getHotKey() const;
 	[[nodiscard]] SymbolManager& getSymbolManager() const { return *symbolManager; }
 	[[nodiscard]] AviRecorder& getRecorder() const { return *aviRecordCommand; }
+	[[nodiscard]] HostProfiler& getHostProfiler() const { return *hostProfiler; }
 
 	[[nodiscard]] RomDatabase& getSoftwareDatabase();
 
@@ -187,6 +190,8 @@ private:
 	std::unique_ptr<GetClipboardCommand> getClipboardCommand;
 	std::unique_ptr<SetClipboardCommand> setClipboardCommand;
 	std::unique_ptr<AviRecorder> aviRecordCommand;
+	std::unique_ptr<SharedMemoryExporter> sharedMemoryExporter;
+	std::unique_ptr<HostProfiler> hostProfiler;
 	std::unique_ptr<ConfigInfo> extensionInfo;
 	std::unique_ptr<ConfigInfo> machineInfo;
 	std::unique_ptr<RealTimeInfo> realTimeInfo;
@@ -1,5 +1,6 @@
 #include "Scheduler.hh"
 #include "Schedulable.hh"
+#include "HostProfiler.hh"
 #include "Thread.hh"
 #include "MSXCPU.hh"
 #include "ranges.hh"
@@ -98,7 +99,10 @@ void Scheduler::scheduleHelper(EmuTime::param limit, EmuTime next)
 
 		queue.remove_front();
 
-		device->executeUntil(next);
+		{
+			HostProfiler::Scope scope(HostProfiler::Category::SCHEDULABLE, *device);
+			device->executeUntil(next);
+		}
 
 		next = getNext();
 		if (next > limit) [[likely]] break;
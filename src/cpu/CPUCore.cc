@@ -160,11 +160,13 @@
 
 #include "CPUCore.hh"
 
+#include "AccessStats.hh"
 #include "MSXCPUInterface.hh"
 #include "Scheduler.hh"
 #include "MSXMotherBoard.hh"
 #include "MSXCliComm.hh"
 #include "TclCallback.hh"
+#include "TraceRecorder.hh"
 #include "Dasm.hh"
 #include "Z80.hh"
 #include "R800.hh"
@@ -295,13 +297,15 @@ struct CondTrue { bool operator()(byte /*f*/) const { return true; } };
 
 template<typename T> CPUCore<T>::CPUCore(
 		MSXMotherBoard& motherboard_, const std::string& name,
-		const BooleanSetting& traceSetting_,
+		const BooleanSetting& traceSetting_, TraceRecorder& traceRecorder_,
 		TclCallback& diHaltCallback_, EmuTime::param time)
 	: CPURegs(T::IS_R800)
 	, T(time, motherboard_.getScheduler())
 	, motherboard(motherboard_)
 	, scheduler(motherboard.getScheduler())
 	, traceSetting(traceSetting_)
+	, traceRecorder(traceRecorder_)
+	, accessStats(motherboard.getAccessStats())
 	, diHaltCallback(diHaltCallback_)
 	, IRQStatus(motherboard.getDebugger(), name + ".pendingIRQ",
 	            "Non-zero if there are pending IRQs (thus CPU would enter "
@@ -320,7 +324,8 @@ template<typename T> CPUCore<T>::CPUCore(
 		"custom CPU frequency (only valid when unlocked)",
 		T::CLOCK_FREQ, 1000000, 1000000000)
 	, freq(T::CLOCK_FREQ)
-	, tracingEnabled(traceSetting.getBoolean())
+	, tracingEnabled(traceSetting.getBoolean() || traceRecorder.isRecording() ||
+	                 accessStats.isRunning())
 	, isCMOS(motherboard.hasToshibaEngine())  // Toshiba MSX-ENGINEs embed a CMOS Z80
 {
 	static_assert(!std::is_polymorphic_v<CPUCore<T>>,
@@ -542,10 +547,16 @@ template<typename T> void CPUCore<T>::update(const Setting& setting) noexcept
 	} else if (&setting == &freqValue) {
 		doSetFreq();
 	} else if (&setting == &traceSetting) {
-		tracingEnabled = traceSetting.getBoolean();
+		updateTracing();
 	}
 }
 
+template<typename T> void CPUCore<T>::updateTracing()
+{
+	tracingEnabled = traceSetting.getBoolean() || traceRecorder.isRecording() ||
+	                 accessStats.isRunning();
+}
+
 template<typename T> void CPUCore<T>::setFreq(unsigned freq_)
 {
 	freq = freq_;
@@ -569,6 +580,7 @@ template<typename T> inline byte CPUCore<T>::READ_PORT(word port, unsigned cc)
 	EmuTime time = T::getTimeFast(cc);
 	scheduler.schedule(time);
 	byte result = interface->readIO(port, time);
+	cpuTraceAccess(TraceRecorder::ACCESS_IO_READ, port, result);
 	// note: no forced page-break after IO
 	return result;
 }
@@ -578,6 +590,7 @@ template<typename T> inline void CPUCore<T>::WRITE_PORT(word port, byte value, u
 	EmuTime time = T::getTimeFast(cc);
 	scheduler.schedule(time);
 	interface->writeIO(port, value, time);
+	cpuTraceAccess(TraceRecorder::ACCESS_IO_WRITE, port, value);
 	// note: no forced page-break after IO
 }
 
@@ -736,6 +749,7 @@ ALWAYS_INLINE void CPUCore<T>::WRMEM_impl(
 template<typename T> ALWAYS_INLINE void CPUCore<T>::WRMEM(
 	unsigned address, byte value, unsigned cc)
 {
+	cpuTraceAccess(TraceRecorder::ACCESS_MEM_WRITE, address, value);
 	WRMEM_impl<true, true>(address, value, cc);
 }
 
@@ -748,6 +762,7 @@ template<typename T> NEVER_INLINE void CPUCore<T>::WR_WORD_slow(
 template<typename T> ALWAYS_INLINE void CPUCore<T>::WR_WORD(
 	unsigned address, word value, unsigned cc)
 {
+	cpuTraceAccess(TraceRecorder::ACCESS_MEM_WRITE | TraceRecorder::ACCESS_WORD, address, value);
 	byte* line = writeCacheLine[address >> CacheLine::BITS];
 	if (((address & CacheLine::LOW) != CacheLine::LOW) && (uintptr_t(line) > 1)) [[likely]] {
 		// fast path: cached and two bytes in same cache line
@@ -789,6 +804,7 @@ ALWAYS_INLINE void CPUCore<T>::WR_WORD_rev(
 {
 	constexpr bool PRE  = T::template Normalize<PRE_PB >::value;
 	constexpr bool POST = T::template Normalize<POST_PB>::value;
+	cpuTraceAccess(TraceRecorder::ACCESS_MEM_WRITE | TraceRecorder::ACCESS_WORD, address, value);
 	WR_WORD_rev2<PRE, POST>(address, value, cc);
 }
 
@@ -2463,6 +2479,24 @@ xx_cb: {
 template<typename T> inline void CPUCore<T>::cpuTracePre()
 {
 	start_pc = getPC();
+	if (tracingEnabled) [[unlikely]] {
+		cpuTracePre_slow();
+	}
+}
+template<typename T> void CPUCore<T>::cpuTracePre_slow()
+{
+	accessStats.getCPURegion().count(AccessStats::Type::EXECUTE, start_pc);
+	if (!traceRecorder.isRecording()) return;
+	std::array<uint8_t, 4> opcode;
+	for (auto i : xrange(4)) {
+		opcode[i] = interface->peekMem(narrow_cast<word>(start_pc + i), T::getTimeFast());
+	}
+	uint16_t slots = 0;
+	for (auto page : xrange(4)) {
+		auto s = 4 * interface->getPrimarySlot(page) + interface->getSecondarySlot(page);
+		slots = uint16_t(slots | (s << (4 * page)));
+	}
+	traceRecorder.beginInstruction(start_pc, slots, opcode);
 }
 template<typename T> inline void CPUCore<T>::cpuTracePost()
 {
@@ -2470,8 +2504,19 @@ template<typename T> inline void CPUCore<T>::cpuTracePost()
 		cpuTracePost_slow();
 	}
 }
+template<typename T> inline void CPUCore<T>::cpuTraceAccess(uint8_t type, unsigned address, unsigned value)
+{
+	if (tracingEnabled) [[unlikely]] {
+		traceRecorder.noteAccess(type, address, value);
+	}
+}
 template<typename T> void CPUCore<T>::cpuTracePost_slow()
 {
+	if (traceRecorder.isRecording()) {
+		traceRecorder.endInstruction(T::getTimeFast());
+	}
+	if (!traceSetting.getBoolean()) return;
+
 	std::array<byte, 4> opBuf;
 	std::string dasmOutput;
 	dasm(*interface, start_pc, opBuf, dasmOutput, T::getTimeFast());
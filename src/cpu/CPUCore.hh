@@ -16,8 +16,10 @@
 
 namespace openmsx {
 
+class AccessStats;
 class MSXCPUInterface;
 class Scheduler;
+class TraceRecorder;
 class MSXMotherBoard;
 class TclCallback;
 class TclObject;
@@ -56,7 +58,7 @@ class CPUCore final : public CPUBase, public CPURegs, public CPU_POLICY
 {
 public:
 	CPUCore(MSXMotherBoard& motherboard, const std::string& name,
-	        const BooleanSetting& traceSetting,
+	        const BooleanSetting& traceSetting, TraceRecorder& traceRecorder,
 	        TclCallback& diHaltCallback, EmuTime::param time);
 
 	void setInterface(MSXCPUInterface* interface_) { interface = interface_; }
@@ -137,6 +139,7 @@ private:
 
 	// Observer<Setting>  !! non-virtual !!
 	void update(const Setting& setting) noexcept;
+	void updateTracing();
 
 private:
 	// memory cache
@@ -148,6 +151,8 @@ private:
 	MSXCPUInterface* interface = nullptr;
 
 	const BooleanSetting& traceSetting;
+	TraceRecorder& traceRecorder;
+	AccessStats& accessStats;
 	TclCallback& diHaltCallback;
 
 	Probe<int> IRQStatus;
@@ -171,7 +176,8 @@ private:
 
 	std::atomic<bool> exitLoop = false;
 
-	/** In sync with traceSetting.getBoolean(). */
+	/** In sync with traceSetting.getBoolean() || traceRecorder.isRecording()
+	  * || accessStats.isRunning(). */
 	bool tracingEnabled;
 
 	/** An NMOS Z80 and a CMOS Z80 behave slightly differently */
@@ -179,8 +185,10 @@ private:
 
 private:
 	inline void cpuTracePre();
+	void cpuTracePre_slow();
 	inline void cpuTracePost();
 	void cpuTracePost_slow();
+	inline void cpuTraceAccess(uint8_t type, unsigned address, unsigned value);
 
 	inline byte READ_PORT(word port, unsigned cc);
 	inline void WRITE_PORT(word port, byte value, unsigned cc);
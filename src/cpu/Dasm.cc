@@ -23,30 +23,31 @@ void appendAddrAsHex(std::string& output, uint16_t addr)
 	strAppend(output, '#', hex_string<4>(addr));
 }
 
-unsigned dasm(const MSXCPUInterface& interface, uint16_t pc, std::span<uint8_t, 4> buf,
-              std::string& dest, EmuTime::param time,
-              function_ref<void(std::string&, uint16_t)> appendAddr)
+// 'fetch(i)' returns the byte at address 'pc + i'.
+static unsigned dasmImpl(function_ref<uint8_t(unsigned)> fetch, uint16_t pc,
+                         std::span<uint8_t, 4> buf, std::string& dest,
+                         function_ref<void(std::string&, uint16_t)> appendAddr)
 {
 	const char* r = nullptr;
 
-	buf[0] = interface.peekMem(pc, time);
+	buf[0] = fetch(0);
 	auto [s, i] = [&]() -> std::pair<const char*, unsigned> {
 		switch (buf[0]) {
 			case 0xCB:
-				buf[1] = interface.peekMem(pc + 1, time);
+				buf[1] = fetch(1);
 				return {mnemonic_cb[buf[1]], 2};
 			case 0xED:
-				buf[1] = interface.peekMem(pc + 1, time);
+				buf[1] = fetch(1);
 				return {mnemonic_ed[buf[1]], 2};
 			case 0xDD:
 			case 0xFD:
 				r = (buf[0] == 0xDD) ? "ix" : "iy";
-				buf[1] = interface.peekMem(pc + 1, time);
+				buf[1] = fetch(1);
 				if (buf[1] != 0xcb) {
 					return {mnemonic_xx[buf[1]], 2};
 				} else {
-					buf[2] = interface.peekMem(pc + 2, time);
-					buf[3] = interface.peekMem(pc + 3, time);
+					buf[2] = fetch(2);
+					buf[3] = fetch(3);
 					return {mnemonic_xx_cb[buf[3]], 4};
 				}
 			default:
@@ -57,25 +58,25 @@ unsigned dasm(const MSXCPUInterface& interface, uint16_t pc, std::span<uint8_t,
 	for (int j = 0; s[j]; ++j) {
 		switch (s[j]) {
 		case 'B':
-			buf[i] = interface.peekMem(narrow_cast<uint16_t>(pc + i), time);
+			buf[i] = fetch(i);
 			strAppend(dest, '#', hex_string<2>(
 				static_cast<uint16_t>(buf[i])));
 			i += 1;
 			break;
 		case 'R':
-			buf[i] = interface.peekMem(narrow_cast<uint16_t>(pc + i), time);
+			buf[i] = fetch(i);
 			appendAddr(dest, uint16_t(pc + 2 + static_cast<int8_t>(buf[i])));
 			i += 1;
 			break;
 		case 'A':
 		case 'W':
-			buf[i + 0] = interface.peekMem(narrow_cast<uint16_t>(pc + i + 0), time);
-			buf[i + 1] = interface.peekMem(narrow_cast<uint16_t>(pc + i + 1), time);
+			buf[i + 0] = fetch(i + 0);
+			buf[i + 1] = fetch(i + 1);
 			appendAddr(dest, buf[i] + buf[i + 1] * 256);
 			i += 2;
 			break;
 		case 'X':
-			buf[i] = interface.peekMem(narrow_cast<uint16_t>(pc + i), time);
+			buf[i] = fetch(i);
 			strAppend(dest, '(', r, sign(buf[i]), '#',
 			     hex_string<2>(abs(buf[i])), ')');
 			i += 1;
@@ -111,6 +112,31 @@ unsigned dasm(const MSXCPUInterface& interface, uint16_t pc, std::span<uint8_t,
 	return i;
 }
 
+unsigned dasm(const MSXCPUInterface& interface, uint16_t pc, std::span<uint8_t, 4> buf,
+              std::string& dest, EmuTime::param time,
+              function_ref<void(std::string&, uint16_t)> appendAddr)
+{
+	return dasmImpl(
+		[&](unsigned i) { return interface.peekMem(narrow_cast<uint16_t>(pc + i), time); },
+		pc, buf, dest, appendAddr);
+}
+
+unsigned dasm(std::span<const uint8_t> opcode, uint16_t pc, std::string& dest,
+              function_ref<void(std::string&, uint16_t)> appendAddr)
+{
+	std::array<uint8_t, 4> buf;
+	return dasmImpl(
+		[&](unsigned i) { return (i < opcode.size()) ? opcode[i] : uint8_t(0); },
+		pc, buf, dest, appendAddr);
+}
+
+unsigned instructionLength(uint8_t op0, uint8_t op1)
+{
+	auto t = instr_len_tab[op0];
+	if (t < 4) return t;
+	return instr_len_tab[64 * t + op1];
+}
+
 unsigned instructionLength(const MSXCPUInterface& interface, uint16_t pc,
                            EmuTime::param time)
 {
@@ -126,15 +152,15 @@ unsigned instructionLength(const MSXCPUInterface& interface, uint16_t pc,
 // sure a boundary. Though this is not (yet) necessarily the largest address
 // with this property.
 // In addition return the length of the instruction at the resulting address.
-static std::pair<uint16_t, unsigned> findGuaranteedBoundary(const MSXCPUInterface& interface, uint16_t addr, EmuTime::param time)
+static std::pair<uint16_t, unsigned> findGuaranteedBoundary(function_ref<unsigned(uint16_t)> instrLen, uint16_t addr)
 {
 	if (addr < 3) {
 		// address 0 (the top) is a boundary
-		return {0, instructionLength(interface, 0, time)};
+		return {0, instrLen(0)};
 	}
 	std::array<unsigned, 4> length;
 	for (auto i : xrange(4)) {
-		length[i] = instructionLength(interface, uint16_t(addr - i), time);
+		length[i] = instrLen(uint16_t(addr - i));
 	}
 
 	while (true) {
@@ -155,45 +181,57 @@ static std::pair<uint16_t, unsigned> findGuaranteedBoundary(const MSXCPUInterfac
 		length[0] = length[1];
 		length[1] = length[2];
 		length[2] = length[3];
-		length[3] = instructionLength(interface, addr - 3, time);
+		length[3] = instrLen(addr - 3);
 	}
 }
 
 static std::pair<uint16_t, unsigned> instructionBoundaryAndLength(
-	const MSXCPUInterface& interface, uint16_t addr, EmuTime::param time)
+	function_ref<unsigned(uint16_t)> instrLen, uint16_t addr)
 {
 	// scan backwards for a guaranteed boundary
-	auto [candidate, len] = findGuaranteedBoundary(interface, addr, time);
+	auto [candidate, len] = findGuaranteedBoundary(instrLen, addr);
 	// scan forwards for the boundary with the largest address
 	while (true) {
 		if ((candidate + len) > addr) return {candidate, len};
 		candidate += len;
-		len = instructionLength(interface, candidate, time);
+		len = instrLen(candidate);
 	}
 }
 
+uint16_t instructionBoundary(function_ref<unsigned(uint16_t)> instrLen, uint16_t addr)
+{
+	auto [result, len] = instructionBoundaryAndLength(instrLen, addr);
+	return result;
+}
+
 uint16_t instructionBoundary(const MSXCPUInterface& interface, uint16_t addr,
                              EmuTime::param time)
 {
-	auto [result, len] = instructionBoundaryAndLength(interface, addr, time);
-	return result;
+	return instructionBoundary(
+		[&](uint16_t a) { return instructionLength(interface, a, time); }, addr);
 }
 
-uint16_t nInstructionsBefore(const MSXCPUInterface& interface, uint16_t addr,
-                             EmuTime::param time, int n)
+uint16_t nInstructionsBefore(function_ref<unsigned(uint16_t)> instrLen, uint16_t addr, int n)
 {
 	auto start = uint16_t(std::max(0, int(addr - 4 * n))); // for sure small enough
-	auto [tmp, len] = instructionBoundaryAndLength(interface, start, time);
+	auto [tmp, len] = instructionBoundaryAndLength(instrLen, start);
 
 	std::vector<uint16_t> addresses;
 	while ((tmp + len) <= addr) {
 		addresses.push_back(tmp);
 		tmp += len;
-		len = instructionLength(interface, tmp, time);
+		len = instrLen(tmp);
 	}
 	addresses.push_back(tmp);
 
 	return addresses[std::max(0, narrow<int>(addresses.size()) - 1 - n)];
 }
 
+uint16_t nInstructionsBefore(const MSXCPUInterface& interface, uint16_t addr,
+                             EmuTime::param time, int n)
+{
+	return nInstructionsBefore(
+		[&](uint16_t a) { return instructionLength(interface, a, time); }, addr, n);
+}
+
 } // namespace openmsx
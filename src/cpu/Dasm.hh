@@ -29,6 +29,16 @@ unsigned dasm(const MSXCPUInterface& interface, uint16_t pc, std::span<uint8_t,
               std::string& dest, EmuTime::param time,
               function_ref<void(std::string&, uint16_t)> appendAddr = &appendAddrAsHex);
 
+/** Disassemble an instruction that is not (anymore) in memory, e.g. one
+  * that was recorded in a trace.
+  * @param opcode The bytes of the instruction, missing bytes are taken as 0
+  * @param pc The address of the instruction (for relative jumps)
+  * @param dest String representation of the disassembled opcode
+  * @return Length of the disassembled opcode in bytes
+  */
+unsigned dasm(std::span<const uint8_t> opcode, uint16_t pc, std::string& dest,
+              function_ref<void(std::string&, uint16_t)> appendAddr = &appendAddrAsHex);
+
 /** Calculate the length of the instruction at the given address.
   * This is exactly the same value as calculated by the dasm() function above,
   * though this function executes much faster.
@@ -39,6 +49,10 @@ unsigned dasm(const MSXCPUInterface& interface, uint16_t pc, std::span<uint8_t,
 unsigned instructionLength(const MSXCPUInterface& interface, uint16_t pc,
                            EmuTime::param time);
 
+/** Same as above, but for an instruction that starts with the given two
+  * bytes (the 2nd byte is only needed for some instructions). */
+unsigned instructionLength(uint8_t op0, uint8_t op1);
+
 /** This is only an _heuristic_ to display instructions in a debugger disassembly
   * view. (In reality Z80 instruction can really start at _any_ address).
   *
@@ -60,6 +74,10 @@ unsigned instructionLength(const MSXCPUInterface& interface, uint16_t pc,
 uint16_t instructionBoundary(const MSXCPUInterface& interface, uint16_t addr,
                              EmuTime::param time);
 
+/** Same as above, but the length of the instruction at a given address is
+  * obtained via 'instrLen' (e.g. from a cache instead of from memory). */
+uint16_t instructionBoundary(function_ref<unsigned(uint16_t)> instrLen, uint16_t addr);
+
 /** Get the start address of the 'n'th instruction before the instruction
   * containing the byte at the given address 'addr'.
   * In other words, stepping 'n' instructions forwards from the resulting
@@ -70,6 +88,7 @@ uint16_t instructionBoundary(const MSXCPUInterface& interface, uint16_t addr,
   */
 uint16_t nInstructionsBefore(const MSXCPUInterface& interface, uint16_t addr,
                              EmuTime::param time, int n);
+uint16_t nInstructionsBefore(function_ref<unsigned(uint16_t)> instrLen, uint16_t addr, int n);
 
 } // namespace openmsx
 
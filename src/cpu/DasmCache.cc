@@ -0,0 +1,99 @@
+#include "DasmCache.hh"
+
+#include "Dasm.hh"
+#include "MSXCPUInterface.hh"
+
+#include "narrow.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cassert>
+
+namespace openmsx {
+
+DasmCache::DasmCache()
+{
+	// consistent initial state: all zeros, 'nop' has length 1
+	mem.fill(0);
+	length.fill(1);
+	lineGeneration.fill(0);
+}
+
+void DasmCache::update(const MSXCPUInterface& interface_, EmuTime::param time_)
+{
+	interface = &interface_;
+	time = time_;
+	if (++generation == 0) {
+		// wrapped (after a very long time), make sure all lines get checked
+		lineGeneration.fill(0);
+		generation = 1;
+	}
+}
+
+void DasmCache::validate(unsigned line)
+{
+	if (lineGeneration[line] == generation) [[likely]] return;
+	lineGeneration[line] = generation;
+	assert(interface);
+
+	auto start = narrow<uint16_t>(line * CacheLine::SIZE);
+	std::array<uint8_t, CacheLine::SIZE> buf;
+	if (const auto* p = interface->getReadCacheLine(start)) {
+		std::copy_n(p, CacheLine::SIZE, buf.begin());
+	} else {
+		for (auto i : xrange(CacheLine::SIZE)) {
+			buf[i] = interface->peekMem(narrow<uint16_t>(start + i), time);
+		}
+	}
+	if (line == CacheLine::NUM - 1) {
+		// the secondary slot select register is not part of the cache line
+		buf.back() = interface->peekMem(0xffff, time);
+	}
+
+	auto cached = std::span{mem}.subspan(start, CacheLine::SIZE);
+	if (std::ranges::equal(buf, cached)) return;
+	std::ranges::copy(buf, cached.begin());
+	for (auto i : xrange(CacheLine::SIZE - 1)) {
+		length[start + i] = narrow<uint8_t>(openmsx::instructionLength(buf[i], buf[i + 1]));
+	}
+}
+
+uint8_t DasmCache::peek(uint16_t addr)
+{
+	validate(addr >> CacheLine::BITS);
+	return mem[addr];
+}
+
+unsigned DasmCache::instructionLength(uint16_t addr)
+{
+	if ((addr & CacheLine::LOW) == CacheLine::LOW) {
+		// the 2nd byte is in the next line
+		auto op0 = peek(addr);
+		return openmsx::instructionLength(op0, peek(narrow_cast<uint16_t>(addr + 1)));
+	}
+	validate(addr >> CacheLine::BITS);
+	return length[addr];
+}
+
+uint16_t DasmCache::instructionBoundary(uint16_t addr)
+{
+	return openmsx::instructionBoundary(
+		[&](uint16_t a) { return instructionLength(a); }, addr);
+}
+
+uint16_t DasmCache::nInstructionsBefore(uint16_t addr, int n)
+{
+	return openmsx::nInstructionsBefore(
+		[&](uint16_t a) { return instructionLength(a); }, addr, n);
+}
+
+unsigned DasmCache::dasm(uint16_t addr, std::span<uint8_t, 4> buf, std::string& dest,
+                         function_ref<void(std::string&, uint16_t)> appendAddr)
+{
+	for (auto i : xrange(4)) {
+		buf[i] = peek(narrow_cast<uint16_t>(addr + i));
+	}
+	return openmsx::dasm(buf, addr, dest, appendAddr);
+}
+
+} // namespace openmsx
@@ -0,0 +1,68 @@
+#ifndef DASMCACHE_HH
+#define DASMCACHE_HH
+
+#include "CacheLine.hh"
+#include "EmuTime.hh"
+
+#include "function_ref.hh"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace openmsx {
+
+class MSXCPUInterface;
+
+/** Keeps a copy of the (visible) CPU memory together with the length of the
+  * instruction starting at each address. This allows the debugger to
+  * disassemble a (large) region of memory, and to (repeatedly) search for
+  * instruction boundaries, without going through MSXCPUInterface::peekMem()
+  * for every byte on every (GUI) frame.
+  *
+  * The memory is (re)read per CacheLine, but only the first time that line is
+  * used after a call to update(). The instruction lengths of a line are only
+  * recalculated when the content of that line actually changed. So changes in
+  * memory (writes, but also switching slots or mapper segments) are picked up
+  * on the next update(), without requiring any hooks in the emulation itself.
+  */
+class DasmCache
+{
+public:
+	DasmCache();
+
+	/** Must be called before the methods below, typically once per frame.
+	  * Marks all cached memory as 'possibly outdated'. */
+	void update(const MSXCPUInterface& interface, EmuTime::param time);
+
+	/** Same result as MSXCPUInterface::peekMem(). */
+	[[nodiscard]] uint8_t peek(uint16_t addr);
+
+	/** Same as the functions with the same name in Dasm.hh, but using the
+	  * cached memory content. */
+	[[nodiscard]] unsigned instructionLength(uint16_t addr);
+	[[nodiscard]] uint16_t instructionBoundary(uint16_t addr);
+	[[nodiscard]] uint16_t nInstructionsBefore(uint16_t addr, int n);
+	unsigned dasm(uint16_t addr, std::span<uint8_t, 4> buf, std::string& dest,
+	              function_ref<void(std::string&, uint16_t)> appendAddr);
+
+private:
+	void validate(unsigned line);
+
+private:
+	std::array<uint8_t, 0x10000> mem;
+	// Length of the instruction starting at each address. Except for the
+	// last address in each line, that one depends on the next line.
+	std::array<uint8_t, 0x10000> length;
+	// Value of 'generation' when a line was last compared with memory.
+	std::array<unsigned, CacheLine::NUM> lineGeneration;
+	unsigned generation = 0;
+
+	const MSXCPUInterface* interface = nullptr;
+	EmuTime time = EmuTime::zero();
+};
+
+} // namespace openmsx
+
+#endif
@@ -23,17 +23,18 @@ MSXCPU::MSXCPU(MSXMotherBoard& motherboard_)
 	, traceSetting(
 		motherboard.getCommandController(), "cputrace",
 		"CPU tracing on/off", false, Setting::DONT_SAVE)
+	, traceRecorder(motherboard, *this)
 	, diHaltCallback(
 		motherboard.getCommandController(), "di_halt_callback",
 		"Tcl proc called when the CPU executed a DI/HALT sequence",
 		"default_di_halt_callback",
 		Setting::SaveSetting::SAVE) // user must be able to override
 	, z80(std::make_unique<CPUCore<Z80TYPE>>(
-		motherboard, "z80", traceSetting,
+		motherboard, "z80", traceSetting, traceRecorder,
 		diHaltCallback, EmuTime::zero()))
 	, r800(motherboard.isTurboR()
 		? std::make_unique<CPUCore<R800TYPE>>(
-			motherboard, "r800", traceSetting,
+			motherboard, "r800", traceSetting, traceRecorder,
 			diHaltCallback, EmuTime::zero())
 		: nullptr)
 	, timeInfo(motherboard.getMachineInfoCommand())
@@ -352,6 +353,13 @@ void MSXCPU::update(const Setting& setting) noexcept
 	exitCPULoopSync();
 }
 
+void MSXCPU::updateTracing()
+{
+	          z80 ->updateTracing();
+	if (r800) r800->updateTracing();
+	exitCPULoopSync();
+}
+
 // Command
 
 void MSXCPU::disasmCommand(
@@ -8,6 +8,7 @@
 #include "CacheLine.hh"
 #include "EmuTime.hh"
 #include "TclCallback.hh"
+#include "TraceRecorder.hh"
 #include "serialize_meta.hh"
 #include "openmsx.hh"
 #include <array>
@@ -135,6 +136,10 @@ public:
 
 	void setInterface(MSXCPUInterface* interface);
 
+	/** Re-evaluate whether instructions must be traced (printed or
+	  * recorded), called when the trace recorder starts or stops. */
+	void updateTracing();
+
 	void disasmCommand(Interpreter& interp,
 	                   std::span<const TclObject> tokens,
 	                   TclObject& result) const;
@@ -181,6 +186,7 @@ private:
 private:
 	MSXMotherBoard& motherboard;
 	BooleanSetting traceSetting;
+	TraceRecorder traceRecorder;
 	TclCallback diHaltCallback;
 	const std::unique_ptr<CPUCore<Z80TYPE>> z80;
 	const std::unique_ptr<CPUCore<R800TYPE>> r800; // can be nullptr
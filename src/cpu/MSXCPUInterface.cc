@@ -9,6 +9,7 @@
 #include "EventDistributor.hh"
 #include "GlobalSettings.hh"
 #include "HardwareConfig.hh"
+#include "HostProfiler.hh"
 #include "Interpreter.hh"
 #include "MSXCPU.hh"
 #include "MSXCliComm.hh"
@@ -214,6 +215,20 @@ byte MSXCPUInterface::readMemSlow(word address, EmuTime::param time)
 	}
 }
 
+byte MSXCPUInterface::readIOProfiled(word port, EmuTime::param time)
+{
+	auto& device = *IO_In[port & 0xFF];
+	HostProfiler::Scope scope(HostProfiler::Category::IO_READ, device);
+	return device.readIO(port, time);
+}
+
+void MSXCPUInterface::writeIOProfiled(word port, byte value, EmuTime::param time)
+{
+	auto& device = *IO_Out[port & 0xFF];
+	HostProfiler::Scope scope(HostProfiler::Category::IO_WRITE, device);
+	device.writeIO(port, value, time);
+}
+
 void MSXCPUInterface::writeMemSlow(word address, byte value, EmuTime::param time)
 {
 	tick(CacheLineCounters::DisallowCacheWrite);
@@ -5,6 +5,7 @@
 #include "CacheLine.hh"
 #include "DebugCondition.hh"
 #include "WatchPoint.hh"
+#include "HostProfilerState.hh"
 
 #include "SimpleDebuggable.hh"
 #include "InfoTopic.hh"
@@ -153,6 +154,9 @@ public:
 	 * @see MSXDevice::readIO()
 	 */
 	byte readIO(word port, EmuTime::param time) {
+		if (HostProfilerState::isProfiling()) [[unlikely]] {
+			return readIOProfiled(port, time);
+		}
 		return IO_In[port & 0xFF]->readIO(port, time);
 	}
 
@@ -161,6 +165,10 @@ public:
 	 * @see MSXDevice::writeIO()
 	 */
 	void writeIO(word port, byte value, EmuTime::param time) {
+		if (HostProfilerState::isProfiling()) [[unlikely]] {
+			writeIOProfiled(port, value, time);
+			return;
+		}
 		IO_Out[port & 0xFF]->writeIO(port, value, time);
 	}
 
@@ -306,6 +314,8 @@ public:
 private:
 	byte readMemSlow(word address, EmuTime::param time);
 	void writeMemSlow(word address, byte value, EmuTime::param time);
+	byte readIOProfiled(word port, EmuTime::param time);
+	void writeIOProfiled(word port, byte value, EmuTime::param time);
 
 	MSXDevice*& getDevicePtr(byte port, bool isIn);
 
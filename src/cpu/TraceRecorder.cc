@@ -0,0 +1,107 @@
+#include "TraceRecorder.hh"
+
+#include "CommandException.hh"
+#include "FileContext.hh"
+#include "FileOperations.hh"
+#include "MSXCPU.hh"
+#include "MSXMotherBoard.hh"
+#include "TclObject.hh"
+
+#include "narrow.hh"
+#include "outer.hh"
+
+namespace openmsx {
+
+static constexpr size_t DEFAULT_NUM_RECORDS = size_t(1) << 22; // 64MB
+
+TraceRecorder::TraceRecorder(MSXMotherBoard& motherBoard, MSXCPU& cpu_)
+	: cpu(cpu_)
+	, cmd(motherBoard.getCommandController())
+{
+}
+
+void TraceRecorder::start(size_t numRecords)
+{
+	TraceRecorderCore::start(numRecords);
+	cpu.updateTracing();
+}
+
+void TraceRecorder::stop()
+{
+	TraceRecorderCore::stop();
+	cpu.updateTracing();
+}
+
+
+// class TraceRecorder::Cmd
+
+TraceRecorder::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "trace_recorder")
+{
+}
+
+void TraceRecorder::Cmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{2}, "subcommand ?arg ...?");
+	auto& recorder = OUTER(TraceRecorder, cmd);
+	executeSubCommand(tokens[1].getString(),
+		"start", [&]{
+			checkNumArgs(tokens, Between{2, 3}, "?num-records?");
+			auto num = DEFAULT_NUM_RECORDS;
+			if (tokens.size() == 3) {
+				auto n = tokens[2].getInt(getInterpreter());
+				if (n <= 0) throw CommandException("Number of records must be positive");
+				num = size_t(n);
+			}
+			recorder.start(num);
+		},
+		"stop", [&]{
+			checkNumArgs(tokens, 2, "");
+			recorder.stop();
+		},
+		"status", [&]{
+			checkNumArgs(tokens, 2, "");
+			result.addListElement(recorder.isRecording() ? "recording" : "stopped",
+			                      narrow<int>(recorder.size()));
+		},
+		"dump", [&]{
+			checkNumArgs(tokens, 3, "filename");
+			recorder.save(FileOperations::expandTilde(std::string(tokens[2].getString())));
+		},
+		"decode", [&]{
+			checkNumArgs(tokens, 4, "tracefile textfile");
+			decode(FileOperations::expandTilde(std::string(tokens[2].getString())),
+			       FileOperations::expandTilde(std::string(tokens[3].getString())));
+		});
+}
+
+std::string TraceRecorder::Cmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Record the executed CPU instructions in a memory buffer.\n"
+	       "trace_recorder start [<num-records>]       start a new recording, only the last\n"
+	       "                                           <num-records> instructions (default 4M,\n"
+	       "                                           16 bytes each) are kept\n"
+	       "trace_recorder stop                        stop recording\n"
+	       "trace_recorder status                      returns 'recording' or 'stopped' and the\n"
+	       "                                           number of recorded instructions\n"
+	       "trace_recorder dump <filename>             save the recorded instructions to a file\n"
+	       "trace_recorder decode <tracefile> <txt>    convert a saved file to text (disassembly)\n"
+	       "Each recorded instruction contains the time, the slot selection, the address,\n"
+	       "the opcode and the first memory write or IO access done by that instruction.\n"
+	       "While recording, emulation is slower (similar to having breakpoints set).\n";
+}
+
+void TraceRecorder::Cmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	if (tokens.size() == 2) {
+		static constexpr std::array cmds = {
+			"start"sv, "stop"sv, "status"sv, "dump"sv, "decode"sv,
+		};
+		completeString(tokens, cmds);
+	} else if ((tokens[1] == "dump") || (tokens[1] == "decode")) {
+		completeFileName(tokens, userFileContext());
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,50 @@
+#ifndef TRACERECORDER_HH
+#define TRACERECORDER_HH
+
+#include "TraceRecorderCore.hh"
+#include "Command.hh"
+#include "EmuTime.hh"
+
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXCPU;
+class MSXMotherBoard;
+
+/** Records executed CPU instructions as compact fixed-size records in a ring
+  * buffer. Unlike the 'cputrace' setting (which prints each instruction as
+  * text), recording only costs a few memory stores per instruction, so it
+  * can run for a long time. The recording can then be saved to a file and
+  * converted to text later (offline), see the 'trace_recorder' command.
+  * The buffer and the file format are implemented in TraceRecorderCore.
+  */
+class TraceRecorder final : public TraceRecorderCore
+{
+public:
+	TraceRecorder(MSXMotherBoard& motherBoard, MSXCPU& cpu);
+
+	/** Called by the CPU at the end of each instruction (only while
+	  * recording). */
+	void endInstruction(EmuTime::param time) {
+		TraceRecorderCore::endInstruction((time - EmuTime::zero()).length());
+	}
+
+	void start(size_t numRecords);
+	void stop();
+
+private:
+	MSXCPU& cpu;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} cmd;
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,161 @@
+#include "TraceRecorderCore.hh"
+
+#include "Dasm.hh"
+#include "File.hh"
+#include "MSXException.hh"
+
+#include "strCat.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <vector>
+
+namespace openmsx {
+
+void TraceRecorderCore::endInstruction(uint64_t now)
+{
+	if (total == 0) {
+		firstTime = now;
+		lastTime = now;
+	} else if (total > mask) {
+		// Overwriting the oldest record, the next one becomes the oldest.
+		firstTime += buffer[(total + 1) & mask].timeDelta;
+	}
+	auto delta = (now > lastTime) ? (now - lastTime) : 0;
+	lastTime = now;
+
+	current.timeDelta = uint32_t(std::min<uint64_t>(delta, std::numeric_limits<uint32_t>::max()));
+	buffer[total & mask] = current;
+	++total;
+}
+
+void TraceRecorderCore::start(size_t numRecords)
+{
+	auto n = std::bit_ceil(std::clamp(numRecords, MIN_NUM_RECORDS, MAX_NUM_RECORDS));
+	if (n != mask + 1) {
+		buffer.resize(n);
+		mask = n - 1;
+	}
+	total = 0;
+	current = {};
+	recording = true;
+}
+
+size_t TraceRecorderCore::size() const
+{
+	return size_t(std::min<uint64_t>(total, buffer.empty() ? 0 : mask + 1));
+}
+
+void TraceRecorderCore::save(const std::string& filename) const
+{
+	auto num = size();
+	std::array<uint8_t, HEADER_SIZE> header = {};
+	std::ranges::copy(MAGIC, header.begin());
+	Endian::write_UA_L32(&header[16], FILE_VERSION);
+	Endian::write_UA_L32(&header[20], uint32_t(sizeof(Record)));
+	Endian::write_UA_L64(&header[24], num);
+	Endian::write_UA_L64(&header[32], firstTime);
+
+	File file(filename, File::OpenMode::TRUNCATE);
+	file.write(header);
+	auto all = std::span{buffer.data(), buffer.empty() ? 0 : mask + 1};
+	auto first = (total - num) & mask;
+	auto part1 = std::min(num, all.size() - first);
+	file.write(all.subspan(first, part1));
+	file.write(all.subspan(0, num - part1));
+}
+
+static std::string formatTime(uint64_t ticks)
+{
+	auto seconds = ticks / MAIN_FREQ;
+	auto nanoSeconds = (ticks % MAIN_FREQ) * 1'000'000'000 / MAIN_FREQ;
+	auto fraction = strCat(1'000'000'000 + nanoSeconds); // zero-padded
+	return strCat(seconds, '.', std::string_view(fraction).substr(1));
+}
+
+static void formatRecord(std::string& out, uint64_t time, const TraceRecorderCore::Record& r)
+{
+	strAppend(out, formatTime(time), ' ');
+	for (auto page : xrange(4)) {
+		auto s = (r.slots >> (4 * page)) & 15;
+		strAppend(out, s / 4, '-', s & 3, ' ');
+	}
+
+	std::string mnemonic;
+	auto len = dasm(r.opcode, r.pc, mnemonic);
+	strAppend(out, hex_string<4>(uint16_t(r.pc)), " : ");
+	for (auto i : xrange(4u)) {
+		if (i < len) {
+			strAppend(out, hex_string<2>(r.opcode[i]), ' ');
+		} else {
+			out += "   ";
+		}
+	}
+	mnemonic.resize(19, ' ');
+	out += mnemonic;
+
+	switch (r.access & ~TraceRecorderCore::ACCESS_WORD) {
+	case TraceRecorderCore::ACCESS_MEM_WRITE:
+		strAppend(out, " (#", hex_string<4>(uint16_t(r.address)), ") <- #",
+		          hex_string<2>(r.value),
+		          ((r.access & TraceRecorderCore::ACCESS_WORD) ? " (word, low byte)" : ""));
+		break;
+	case TraceRecorderCore::ACCESS_IO_READ:
+		strAppend(out, " in (#", hex_string<2>(r.address & 0xff), ") -> #",
+		          hex_string<2>(r.value));
+		break;
+	case TraceRecorderCore::ACCESS_IO_WRITE:
+		strAppend(out, " out (#", hex_string<2>(r.address & 0xff), ") <- #",
+		          hex_string<2>(r.value));
+		break;
+	default:
+		break;
+	}
+	out += '\n';
+}
+
+void TraceRecorderCore::decode(const std::string& traceFilename, const std::string& textFilename)
+{
+	File in(traceFilename);
+	std::array<uint8_t, HEADER_SIZE> header;
+	if (in.getSize() < HEADER_SIZE) {
+		throw MSXException("Not an openMSX trace file: ", traceFilename);
+	}
+	in.read(header);
+	if (!std::ranges::equal(MAGIC, std::span{header}.first<16>(),
+	                        [](char c, uint8_t b) { return uint8_t(c) == b; })) {
+		throw MSXException("Not an openMSX trace file: ", traceFilename);
+	}
+	if (auto version = Endian::read_UA_L32(&header[16]); version != FILE_VERSION) {
+		throw MSXException("Unsupported trace file version: ", version);
+	}
+	if (Endian::read_UA_L32(&header[20]) != sizeof(Record)) {
+		throw MSXException("Unsupported trace record size");
+	}
+	auto num = Endian::read_UA_L64(&header[24]);
+	auto time = Endian::read_UA_L64(&header[32]);
+	if (num > (in.getSize() - HEADER_SIZE) / sizeof(Record)) {
+		throw MSXException("Trace file is truncated: ", traceFilename);
+	}
+
+	File out(textFilename, File::OpenMode::TRUNCATE);
+	std::vector<Record> records(4096);
+	std::string text;
+	bool first = true; // time of the first record is stored in the header
+	while (num) {
+		auto chunk = std::span{records}.first(size_t(std::min<uint64_t>(num, records.size())));
+		in.read(chunk);
+		text.clear();
+		for (const auto& r : chunk) {
+			if (!first) time += r.timeDelta;
+			first = false;
+			formatRecord(text, time, r);
+		}
+		out.write(std::span{text});
+		num -= chunk.size();
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,110 @@
+#ifndef TRACERECORDERCORE_HH
+#define TRACERECORDERCORE_HH
+
+#include "MemBuffer.hh"
+#include "endian.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace openmsx {
+
+/** The ring buffer and the trace file format of TraceRecorder, independent
+  * of the MSX machine (and of the Tcl command), so that it can be
+  * unit-tested.
+  *
+  * Trace file layout (all integers are little endian):
+  *    header (40 bytes)
+  *       0: "openMSX-trace\0\0\0"
+  *      16: uint32 file format version (currently 1)
+  *      20: uint32 size of a record (currently 16)
+  *      24: uint64 number of records
+  *      32: uint64 EmuTime (in EmuTime ticks, see MAIN_FREQ) of the first record
+  *    records, oldest first, see 'Record' below
+  */
+class TraceRecorderCore
+{
+public:
+	enum AccessType : uint8_t {
+		ACCESS_NONE = 0,
+		ACCESS_MEM_WRITE = 1,
+		ACCESS_IO_READ = 2,
+		ACCESS_IO_WRITE = 3,
+		ACCESS_WORD = 0x80, // flag, combined with ACCESS_MEM_WRITE
+	};
+
+	/** One executed instruction. */
+	struct Record {
+		Endian::L32 timeDelta; // EmuTime ticks since previous record (saturated)
+		Endian::L16 pc;
+		Endian::L16 slots; // per page (4 bits): 4 * primary + secondary slot
+		std::array<uint8_t, 4> opcode; // not all bytes are used by every instruction
+		Endian::L16 address; // address or port of the data access (if any)
+		uint8_t access; // AccessType of the (first) data access
+		uint8_t value; // (low byte of the) value that was read or written
+	};
+	static_assert(sizeof(Record) == 16);
+
+	static constexpr std::string_view MAGIC = {"openMSX-trace\0\0\0", 16};
+	static constexpr uint32_t FILE_VERSION = 1;
+	static constexpr size_t HEADER_SIZE = 40;
+
+	static constexpr size_t MIN_NUM_RECORDS = size_t(1) << 10;
+	static constexpr size_t MAX_NUM_RECORDS = size_t(1) << 28; // 4GB
+
+public:
+	[[nodiscard]] bool isRecording() const { return recording; }
+
+	/** Called at the start of each instruction (only while recording). */
+	void beginInstruction(uint16_t pc, uint16_t slots, std::span<const uint8_t, 4> opcode) {
+		current.pc = pc;
+		current.slots = slots;
+		std::ranges::copy(opcode, current.opcode.begin());
+		current.access = ACCESS_NONE;
+	}
+
+	/** Called for each data access (only while tracing). Only the first
+	  * access of an instruction is recorded. */
+	void noteAccess(uint8_t type, unsigned address, unsigned value) {
+		if (current.access != ACCESS_NONE) return;
+		current.access = type;
+		current.address = uint16_t(address);
+		current.value = uint8_t(value);
+	}
+
+	/** Called at the end of each instruction (only while recording).
+	  * @param ticks Absolute time, in EmuTime ticks. */
+	void endInstruction(uint64_t ticks);
+
+	/** Start a new recording. The buffer size is rounded up to a power
+	  * of 2 and clamped to [MIN_NUM_RECORDS, MAX_NUM_RECORDS]. */
+	void start(size_t numRecords);
+	void stop() { recording = false; }
+	/** Number of records currently in the buffer. */
+	[[nodiscard]] size_t size() const;
+
+	/** Write the recorded instructions to a trace file. */
+	void save(const std::string& filename) const;
+
+	/** Convert a trace file to text, using the disassembler. Does not
+	  * depend on the state of the emulated machine. */
+	static void decode(const std::string& traceFilename, const std::string& textFilename);
+
+private:
+	MemBuffer<Record> buffer;
+	size_t mask = 0; // buffer size (a power of 2) minus one
+	uint64_t total = 0; // total number of records since start()
+	uint64_t firstTime = 0; // absolute time of the oldest record in the buffer
+	uint64_t lastTime = 0; // absolute time of the newest record
+	bool recording = false;
+
+	Record current = {}; // the instruction that is being executed
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,344 @@
+#include "AccessStats.hh"
+
+#include "CommandException.hh"
+#include "FileContext.hh"
+#include "FileOperations.hh"
+#include "MSXCPU.hh"
+#include "MSXMotherBoard.hh"
+#include "PNG.hh"
+#include "TclArgParser.hh"
+#include "TclObject.hh"
+
+#include "narrow.hh"
+#include "one_of.hh"
+#include "outer.hh"
+#include "ranges.hh"
+#include "stl.hh"
+#include "view.hh"
+#include "unreachable.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <optional>
+
+namespace openmsx {
+
+[[nodiscard]] static std::optional<AccessStats::Type> parseType(std::string_view str)
+{
+	using enum AccessStats::Type;
+	if (str == "read")    return READ;
+	if (str == "write")   return WRITE;
+	if (str == "execute") return EXECUTE;
+	return {};
+}
+
+static constexpr std::array allTypes = {
+	AccessStats::Type::READ, AccessStats::Type::WRITE, AccessStats::Type::EXECUTE
+};
+
+
+// class AccessStats::Region
+
+AccessStats::Region::Region(AccessStats& stats_, std::string name_, size_t size_, unsigned types_)
+	: stats(stats_), name(std::move(name_)), size(size_), types(types_)
+{
+	stats.registerRegion(*this);
+}
+
+AccessStats::Region::~Region()
+{
+	stats.unregisterRegion(*this);
+}
+
+void AccessStats::Region::setEnabled(bool enabled_)
+{
+	if (enabled_) {
+		for (auto type : allTypes) {
+			auto& c = counters[size_t(type)];
+			if (hasType(type) && c.empty()) c.assign(size, 0);
+		}
+	}
+	enabled = enabled_;
+}
+
+void AccessStats::Region::clear()
+{
+	for (auto& c : counters) {
+		std::ranges::fill(c, 0);
+	}
+}
+
+
+// class AccessStats
+
+AccessStats::AccessStats(MSXMotherBoard& motherBoard_)
+	: motherBoard(motherBoard_)
+	, cpuRegion(*this, "memory", 0x10000, typeBit(Type::EXECUTE))
+	, cmd(motherBoard.getCommandController())
+{
+}
+
+std::string_view AccessStats::getTypeName(Type type)
+{
+	switch (type) {
+		using enum Type;
+		case READ:    return "read";
+		case WRITE:   return "write";
+		case EXECUTE: return "execute";
+		default: UNREACHABLE;
+	}
+}
+
+void AccessStats::registerRegion(Region& region)
+{
+	regions.push_back(&region);
+	// e.g. RAM in a cartridge that's inserted while counting
+	if (running) region.setEnabled(true);
+}
+
+void AccessStats::unregisterRegion(Region& region)
+{
+	move_pop_back(regions, rfind_unguarded(regions, &region));
+}
+
+AccessStats::Region* AccessStats::findRegion(std::string_view name) const
+{
+	auto it = std::ranges::find(regions, name, &Region::getName);
+	return (it != regions.end()) ? *it : nullptr;
+}
+
+AccessStats::Region& AccessStats::getRegion(std::string_view name) const
+{
+	auto* region = findRegion(name);
+	if (!region) throw CommandException("No such region: ", name);
+	return *region;
+}
+
+void AccessStats::invalidateCPU()
+{
+	if (!motherBoard.getMachineConfig()) return;
+	// CheckedRam only hands out cache lines when not counting
+	auto& cpu = motherBoard.getCPU();
+	cpu.invalidateAllSlotsRWCache(0, 0x10000);
+	cpu.updateTracing();
+}
+
+void AccessStats::start()
+{
+	if (running) return;
+	running = true;
+	for (auto* region : regions) region->setEnabled(true);
+	invalidateCPU();
+}
+
+void AccessStats::stop()
+{
+	if (!running) return;
+	running = false;
+	for (auto* region : regions) region->setEnabled(false);
+	invalidateCPU();
+}
+
+void AccessStats::clear()
+{
+	for (auto* region : regions) region->clear();
+}
+
+// Logarithmic scale with 8 steps per power of 2, only 0 maps to 0.
+[[nodiscard]] static unsigned logLevel(uint32_t count)
+{
+	if (count == 0) return 0;
+	auto bits = std::bit_width(count);
+	auto frac = ((count << (32 - bits)) >> 28) & 7;
+	return 8 * bits + frac;
+}
+
+void AccessStats::renderImage(const Region& region, unsigned types, unsigned width,
+                              std::span<uint32_t> pixels)
+{
+	assert(width != 0);
+	auto size = region.getSize();
+	assert(pixels.size() >= size_t(width) * getImageHeight(region, width));
+	std::ranges::fill(pixels, 0xff000000); // opaque black
+
+	// READ in green, WRITE in red, EXECUTE in blue
+	static constexpr std::array<unsigned, NUM_TYPES> shift = {8, 0, 16};
+	for (auto type : allTypes) {
+		if (!(types & typeBit(type))) continue;
+		auto counters = region.getCounters(type);
+		if (counters.empty()) continue;
+		auto maxLevel = logLevel(std::ranges::max(counters));
+		if (maxLevel == 0) continue;
+		auto s = shift[size_t(type)];
+		for (auto i : xrange(size)) {
+			if (auto level = logLevel(counters[i])) {
+				// any access at all is clearly visible
+				pixels[i] |= (64 + 191 * level / maxLevel) << s;
+			}
+		}
+	}
+}
+
+
+// class AccessStats::Cmd
+
+AccessStats::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "access_stats")
+{
+}
+
+void AccessStats::Cmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{2}, "subcommand ?arg ...?");
+	auto& stats = OUTER(AccessStats, cmd);
+	auto getType = [&](const TclObject& obj) {
+		auto str = obj.getString();
+		if (auto type = parseType(str)) return *type;
+		throw CommandException("Unknown access type: ", str);
+	};
+	executeSubCommand(tokens[1].getString(),
+		"start", [&]{
+			checkNumArgs(tokens, 2, "");
+			stats.start();
+		},
+		"stop", [&]{
+			checkNumArgs(tokens, 2, "");
+			stats.stop();
+		},
+		"clear", [&]{
+			checkNumArgs(tokens, 2, "");
+			stats.clear();
+		},
+		"status", [&]{
+			checkNumArgs(tokens, 2, "");
+			result = stats.isRunning() ? "running" : "stopped";
+		},
+		"regions", [&]{
+			checkNumArgs(tokens, 2, "");
+			for (const auto* region : stats.regions) {
+				TclObject types;
+				for (auto type : allTypes) {
+					if (region->hasType(type)) types.addListElement(getTypeName(type));
+				}
+				result.addListElement(makeTclDict(
+					"name", region->getName(),
+					"size", narrow<int>(region->getSize()),
+					"types", types));
+			}
+		},
+		"get", [&]{
+			checkNumArgs(tokens, 4, "region address");
+			const auto& region = stats.getRegion(tokens[2].getString());
+			auto addr = tokens[3].getInt(getInterpreter());
+			if ((addr < 0) || (size_t(addr) >= region.getSize())) {
+				throw CommandException("Address out of range");
+			}
+			for (auto type : allTypes) {
+				auto counters = region.getCounters(type);
+				if (counters.empty()) continue;
+				result.addDictKeyValue(getTypeName(type), narrow_cast<int>(counters[addr]));
+			}
+		},
+		"top", [&]{
+			checkNumArgs(tokens, AtLeast{4}, "region type ?-count <n>?");
+			const auto& region = stats.getRegion(tokens[2].getString());
+			auto counters = region.getCounters(getType(tokens[3]));
+			std::optional<int> count;
+			std::array info = {valueArg("-count", count)};
+			auto args = parseTclArgs(getInterpreter(), tokens.subspan(4), info);
+			if (!args.empty()) throw SyntaxError();
+
+			std::vector<unsigned> addresses;
+			for (auto i : xrange(counters.size())) {
+				if (counters[i]) addresses.push_back(narrow<unsigned>(i));
+			}
+			auto n = std::min(addresses.size(), size_t(std::max(0, count.value_or(20))));
+			auto cmp = [&](unsigned a, unsigned b) { return counters[a] > counters[b]; };
+			std::ranges::partial_sort(addresses, addresses.begin() + n, cmp);
+			for (auto addr : std::span{addresses}.first(n)) {
+				result.addListElement(makeTclList(addr, narrow_cast<int>(counters[addr])));
+			}
+		},
+		"image", [&]{
+			checkNumArgs(tokens, AtLeast{4}, "region filename ?-width <n>? ?-types <list>?");
+			const auto& region = stats.getRegion(tokens[2].getString());
+			std::optional<int> width;
+			std::optional<TclObject> typeList;
+			std::array info = {valueArg("-width", width), valueArg("-types", typeList)};
+			auto args = parseTclArgs(getInterpreter(), tokens.subspan(4), info);
+			if (!args.empty()) throw SyntaxError();
+			if (width && ((*width < 1) || (*width > 16384))) {
+				throw CommandException("Invalid width");
+			}
+			unsigned types = ALL_TYPES;
+			if (typeList) {
+				types = 0;
+				for (auto i : xrange(typeList->getListLength(getInterpreter()))) {
+					types |= typeBit(getType(typeList->getListIndex(getInterpreter(), i)));
+				}
+			}
+
+			auto w = unsigned(width.value_or(256));
+			auto h = getImageHeight(region, w);
+			std::vector<uint32_t> pixels(size_t(w) * h);
+			renderImage(region, types, w, pixels);
+			auto rows = to_vector(view::transform(xrange(h),
+				[&](unsigned y) -> const uint32_t* { return &pixels[size_t(y) * w]; }));
+			PNG::saveRGBA(w, rows, FileOperations::expandTilde(std::string(tokens[3].getString())));
+		});
+}
+
+std::string AccessStats::Cmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Per-address memory access statistics (for RAM, memory mappers and VRAM).\n"
+	       "access_stats start                  start (or continue) counting accesses\n"
+	       "access_stats stop                   stop counting, the counters are kept\n"
+	       "access_stats clear                  reset all counters to zero\n"
+	       "access_stats status                 returns 'running' or 'stopped'\n"
+	       "access_stats regions                returns for each region its name, size and\n"
+	       "                                    the counted access types\n"
+	       "access_stats get <region> <address> returns the counters of an address\n"
+	       "access_stats top <region> <type> [-count <n>]\n"
+	       "                                    returns the <n> (default 20) most accessed\n"
+	       "                                    addresses, each as {address count}\n"
+	       "access_stats image <region> <filename> [-width <n>] [-types <list>]\n"
+	       "                                    save a heatmap as PNG image, one pixel per\n"
+	       "                                    address, <n> (default 256) pixels per row,\n"
+	       "                                    write=red, read=green, execute=blue\n"
+	       "<type> is one of: read, write, execute. Reads and writes are counted per\n"
+	       "offset in the RAM or VRAM, executes per address in the CPU address space\n"
+	       "(region 'memory'). Only accesses by the CPU are counted.\n";
+}
+
+void AccessStats::Cmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	const auto& stats = OUTER(AccessStats, cmd);
+	if (tokens.size() == 2) {
+		static constexpr std::array cmds = {
+			"start"sv, "stop"sv, "clear"sv, "status"sv,
+			"regions"sv, "get"sv, "top"sv, "image"sv,
+		};
+		completeString(tokens, cmds);
+	} else if (tokens.size() == 3) {
+		if (tokens[1] == one_of("get"sv, "top"sv, "image"sv)) {
+			completeString(tokens, view::transform(stats.regions,
+				[](const Region* r) -> std::string_view { return r->getName(); }));
+		}
+	} else if ((tokens.size() == 4) && (tokens[1] == "top")) {
+		static constexpr std::array types = {"read"sv, "write"sv, "execute"sv};
+		completeString(tokens, types);
+	} else if ((tokens.size() == 4) && (tokens[1] == "image")) {
+		completeFileName(tokens, userFileContext());
+	} else if (tokens[1] == "image") {
+		static constexpr std::array options = {"-width"sv, "-types"sv};
+		completeString(tokens, options);
+	} else if (tokens[1] == "top") {
+		static constexpr std::array options = {"-count"sv};
+		completeString(tokens, options);
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,132 @@
+#ifndef ACCESSSTATS_HH
+#define ACCESSSTATS_HH
+
+#include "Command.hh"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+
+/** Optional per-address access statistics (a memory access 'heatmap').
+  *
+  * Memory devices own one or more 'Region's (e.g. CheckedRam for RAM and
+  * memory mappers, VDPVRAM for VRAM) and report their accesses to it. While
+  * the statistics are not running these hooks only cost a (well predicted)
+  * test of a boolean. When started, CheckedRam stops handing out cache
+  * lines to the CPU, so that all accesses go via the (counting) slow path.
+  * Executed instructions are counted per CPU address via the CPU trace hook.
+  *
+  * Counters are only allocated while the statistics are (or were) running.
+  * A counter that is non-zero also tells whether an address was ever read,
+  * written or executed.
+  */
+class AccessStats
+{
+public:
+	enum class Type : uint8_t { READ, WRITE, EXECUTE, NUM };
+	static constexpr auto NUM_TYPES = size_t(Type::NUM);
+	[[nodiscard]] static constexpr unsigned typeBit(Type type) { return 1 << unsigned(type); }
+	static constexpr unsigned ALL_TYPES = (1 << NUM_TYPES) - 1;
+	[[nodiscard]] static std::string_view getTypeName(Type type);
+
+	class Region
+	{
+	public:
+		/** 'types' is a bitmask (see typeBit()) of the counted access types. */
+		Region(AccessStats& stats, std::string name, size_t size, unsigned types);
+		~Region();
+		Region(const Region&) = delete;
+		Region(Region&&) = delete;
+		Region& operator=(const Region&) = delete;
+		Region& operator=(Region&&) = delete;
+
+		void count(Type type, size_t addr) {
+			if (enabled) [[unlikely]] {
+				if (auto& c = counters[size_t(type)][addr];
+				    c != std::numeric_limits<uint32_t>::max()) {
+					++c;
+				}
+			}
+		}
+
+		[[nodiscard]] bool isEnabled() const { return enabled; }
+		[[nodiscard]] const std::string& getName() const { return name; }
+		[[nodiscard]] size_t getSize() const { return size; }
+		[[nodiscard]] bool hasType(Type type) const { return types & typeBit(type); }
+		/** Empty if this type is not counted or if counting never started. */
+		[[nodiscard]] std::span<const uint32_t> getCounters(Type type) const {
+			return counters[size_t(type)];
+		}
+
+	private:
+		friend class AccessStats;
+		void setEnabled(bool enabled);
+		void clear();
+
+	private:
+		AccessStats& stats;
+		std::string name;
+		size_t size;
+		std::array<std::vector<uint32_t>, NUM_TYPES> counters;
+		unsigned types;
+		bool enabled = false;
+	};
+
+	explicit AccessStats(MSXMotherBoard& motherBoard);
+
+	void start();
+	void stop();
+	void clear();
+	[[nodiscard]] bool isRunning() const { return running; }
+
+	[[nodiscard]] const std::vector<Region*>& getRegions() const { return regions; }
+	[[nodiscard]] Region* findRegion(std::string_view name) const;
+
+	/** The CPU address space, only counts executed instructions. */
+	[[nodiscard]] Region& getCPURegion() { return cpuRegion; }
+
+	[[nodiscard]] static unsigned getImageHeight(const Region& region, unsigned width) {
+		return unsigned((region.getSize() + width - 1) / width);
+	}
+	/** Render the counters of 'region' as an image with one pixel per
+	  * address, 'width' pixels per row. Writes are shown in red, reads in
+	  * green and executes in blue, on a logarithmic scale. Only the types
+	  * in the 'types' bitmask are shown. The pixel format is the same as
+	  * for IM_COL32 (red in the lowest byte), 'pixels' must have room for
+	  * 'width * getImageHeight(region, width)' pixels.
+	  */
+	static void renderImage(const Region& region, unsigned types, unsigned width,
+	                        std::span<uint32_t> pixels);
+
+private:
+	friend class Region;
+	void registerRegion(Region& region);
+	void unregisterRegion(Region& region);
+	[[nodiscard]] Region& getRegion(std::string_view name) const;
+	void invalidateCPU();
+
+private:
+	MSXMotherBoard& motherBoard;
+	std::vector<Region*> regions;
+	bool running = false;
+	Region cpuRegion; // must come after 'regions' and 'running'
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} cmd;
+};
+
+} // namespace openmsx
+
+#endif
@@ -2,6 +2,7 @@
 #define DEBUGGABLE_HH
 
 #include "openmsx.hh"
+#include <span>
 #include <string_view>
 
 namespace openmsx {
@@ -19,6 +20,28 @@ public:
 	[[nodiscard]] virtual byte read(unsigned address) = 0;
 	virtual void write(unsigned address, byte value) = 0;
 
+	/** Read/write a range of consecutive addresses. The caller must ensure
+	  * the complete range lies within [0, getSize()).
+	  * The default implementation simply calls read()/write() for each
+	  * byte. Debuggables that are backed by a plain memory block should
+	  * override these to avoid one (virtual) call per byte. */
+	virtual void readBlock(unsigned start, std::span<byte> output) {
+		for (auto& b : output) b = read(start++);
+	}
+	virtual void writeBlock(unsigned start, std::span<const byte> input) {
+		for (auto b : input) write(start++, b);
+	}
+
+	/** Like readBlock(), but guaranteed without side effects on the
+	  * emulation (e.g. no syncing of the VDP command engine), so that
+	  * passive observers (like SharedMemoryExporter) don't influence
+	  * timing or replays. The result may lag slightly behind what
+	  * readBlock() would return. The default implementation calls
+	  * readBlock(), override it when that has side effects. */
+	virtual void peekBlock(unsigned start, std::span<byte> output) {
+		readBlock(start, output);
+	}
+
 protected:
 	Debuggable() = default;
 	~Debuggable() = default;
@@ -23,7 +23,6 @@
 #include "stl.hh"
 #include "unreachable.hh"
 #include "view.hh"
-#include "xrange.hh"
 
 #include <array>
 #include <cassert>
@@ -302,10 +301,9 @@ void Debugger::Cmd::readBlock(std::span<const TclObject> tokens, TclObject& resu
 	}
 
 	MemBuffer<byte> buf(num);
-	for (auto i : xrange(num)) {
-		buf[i] = device.read(addr + i);
-	}
-	result = std::span<byte>{buf.data(), num};
+	std::span<byte> block{buf.data(), num};
+	device.readBlock(addr, block);
+	result = block;
 }
 
 void Debugger::Cmd::write(std::span<const TclObject> tokens, TclObject& /*result*/)
@@ -339,9 +337,7 @@ void Debugger::Cmd::writeBlock(std::span<const TclObject> tokens, TclObject& /*r
 		throw CommandException("Invalid size");
 	}
 
-	for (auto i : xrange(buf.size())) {
-		device.write(unsigned(addr + i), buf[i]);
-	}
+	device.writeBlock(addr, buf);
 }
 
 void Debugger::Cmd::setBreakPoint(std::span<const TclObject> tokens, TclObject& result)
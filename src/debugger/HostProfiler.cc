@@ -0,0 +1,316 @@
+#include "HostProfiler.hh"
+
+#include "CommandException.hh"
+#include "Reactor.hh"
+#include "TclArgParser.hh"
+#include "TclObject.hh"
+#include "Thread.hh"
+
+#include "outer.hh"
+#include "ranges.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <optional>
+#include <thread>
+
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+namespace openmsx {
+
+// Time spent in nested scopes of the current scope, per thread.
+static thread_local uint64_t childNanos = 0;
+
+[[nodiscard]] static uint64_t now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+[[nodiscard]] static std::string className(const std::type_info& type)
+{
+	std::string result;
+#ifdef __GNUC__
+	int status = 0;
+	if (char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status)) {
+		result = demangled;
+		std::free(demangled);
+	}
+#endif
+	if (result.empty()) result = type.name();
+	// e.g. MSVC: "class openmsx::VDP"
+	for (std::string_view prefix : {"class ", "struct "}) {
+		if (result.starts_with(prefix)) result.erase(0, prefix.size());
+	}
+	static constexpr std::string_view ns = "openmsx::";
+	for (auto pos = result.find(ns); pos != std::string::npos; pos = result.find(ns, pos)) {
+		result.erase(pos, ns.size());
+	}
+	return result;
+}
+
+std::string_view HostProfiler::getCategoryName(Category category)
+{
+	switch (category) {
+		case Category::SCHEDULABLE: return "schedulable";
+		case Category::SOUND:       return "sound";
+		case Category::RENDER:      return "render";
+		case Category::IO_READ:     return "io_read";
+		case Category::IO_WRITE:    return "io_write";
+		default:                    return "";
+	}
+}
+
+void HostProfiler::Scope::begin(Category category_, const std::type_info& type_)
+{
+	HostProfiler* p = nullptr;
+	if (Thread::isMainThread()) {
+		// only the main thread starts or stops the profiler
+		p = HostProfilerState::active.load(std::memory_order_relaxed);
+		assert(p); // checked in the constructor
+	} else {
+		// Announce this scope before reading 'active'. Together with the
+		// order in stop() this ensures that either we don't see the
+		// profiler at all, or stop() waits for end().
+		++workerScopes;
+		p = HostProfilerState::active.load();
+		if (!p) {
+			--workerScopes;
+			return;
+		}
+		worker = true;
+	}
+	profiler = p;
+	type = &type_;
+	category = category_;
+	savedChildNanos = childNanos;
+	childNanos = 0;
+	start = now();
+}
+
+void HostProfiler::Scope::end()
+{
+	auto total = now() - start;
+	auto self = total - std::min(total, childNanos);
+	childNanos = savedChildNanos + total;
+	if (!worker) {
+		profiler->add(category, type, self);
+	} else {
+		{
+			std::scoped_lock lock(profiler->pendingMutex);
+			profiler->pending.push_back({type, self, category});
+		}
+		--workerScopes; // afterwards 'profiler' may no longer be accessed
+	}
+}
+
+void HostProfiler::add(Category category, const std::type_info* type, uint64_t nanos)
+{
+	// Don't keep a reference to 'Stat' across a scope, the nested code
+	// could have cleared the statistics.
+	auto& stat = stats[size_t(category)][type];
+	++stat.calls;
+	stat.nanos += nanos;
+	frameNanos[size_t(category)] += nanos;
+}
+
+void HostProfiler::mergePending()
+{
+	std::scoped_lock lock(pendingMutex);
+	for (const auto& p : pending) add(p.category, p.type, p.nanos);
+	pending.clear();
+}
+
+HostProfiler::HostProfiler(Reactor& reactor)
+	: cmd(reactor.getCommandController())
+{
+}
+
+HostProfiler::~HostProfiler()
+{
+	stop();
+}
+
+void HostProfiler::start()
+{
+	if (isRunning()) return;
+	startTime = now();
+	frameStart = 0;
+	HostProfilerState::active = this;
+}
+
+void HostProfiler::stop()
+{
+	if (!isRunning()) return;
+	elapsedNanos += now() - startTime;
+	HostProfilerState::active = nullptr;
+	// Scopes on other threads (e.g. sound generation) may still be running.
+	while (workerScopes != 0) {
+		std::this_thread::yield();
+	}
+}
+
+void HostProfiler::clear()
+{
+	for (auto& s : stats) s.clear();
+	{
+		std::scoped_lock lock(pendingMutex);
+		pending.clear();
+	}
+	childNanos = 0;
+	elapsedNanos = 0;
+	if (isRunning()) startTime = now();
+	frameNanos = {};
+	frameStart = 0;
+	numFrames = 0;
+	history = {};
+}
+
+double HostProfiler::getElapsed() const
+{
+	auto nanos = elapsedNanos + (isRunning() ? (now() - startTime) : 0);
+	return double(nanos) * 1e-9;
+}
+
+std::vector<HostProfiler::Entry> HostProfiler::getReport()
+{
+	mergePending();
+	std::vector<Entry> result;
+	for (auto c : xrange(NUM_CATEGORIES)) {
+		for (const auto& [type, stat] : stats[c]) {
+			result.push_back(Entry{Category(c), className(*type), stat});
+		}
+	}
+	ranges::sort(result, [](const Entry& x, const Entry& y) {
+		return x.stat.nanos > y.stat.nanos;
+	});
+	return result;
+}
+
+void HostProfiler::nextFrame()
+{
+	mergePending();
+	auto t = now();
+	if (frameStart != 0) {
+		auto& h = history;
+		h.total[h.pos] = float(double(t - frameStart) * 1e-6);
+		for (auto c : xrange(NUM_CATEGORIES)) {
+			h.category[c][h.pos] = float(double(frameNanos[c]) * 1e-6);
+		}
+		h.pos = (h.pos + 1) % HISTORY_SIZE;
+		++numFrames;
+	}
+	frameNanos = {};
+	frameStart = t;
+}
+
+
+// class HostProfiler::Cmd
+
+HostProfiler::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "profile")
+{
+}
+
+void HostProfiler::Cmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{2}, "subcommand ?arg ...?");
+	auto& profiler = OUTER(HostProfiler, cmd);
+	executeSubCommand(tokens[1].getString(),
+		"start", [&]{
+			checkNumArgs(tokens, 2, "");
+			profiler.start();
+		},
+		"stop", [&]{
+			checkNumArgs(tokens, 2, "");
+			profiler.stop();
+		},
+		"clear", [&]{
+			checkNumArgs(tokens, 2, "");
+			profiler.clear();
+		},
+		"status", [&]{
+			checkNumArgs(tokens, 2, "");
+			result.addListElement(profiler.isRunning() ? "running" : "stopped",
+			                      profiler.getElapsed());
+		},
+		"report", [&]{
+			std::optional<int> count;
+			std::string_view category;
+			std::array info = {valueArg("-count", count), valueArg("-category", category)};
+			auto args = parseTclArgs(getInterpreter(), tokens.subspan(2), info);
+			if (!args.empty()) throw SyntaxError();
+			auto entries = profiler.getReport();
+			if (!category.empty()) {
+				std::optional<Category> filter;
+				for (auto c : xrange(NUM_CATEGORIES)) {
+					if (getCategoryName(Category(c)) == category) filter = Category(c);
+				}
+				if (!filter) throw CommandException("Unknown category: ", category);
+				std::erase_if(entries, [&](const Entry& e) { return e.category != *filter; });
+			}
+			auto elapsed = profiler.getElapsed();
+			auto n = std::min(entries.size(), size_t(std::max(0, count.value_or(20))));
+			for (const auto& e : std::span{entries}.first(n)) {
+				auto seconds = double(e.stat.nanos) * 1e-9;
+				result.addListElement(makeTclDict(
+					"category", getCategoryName(e.category),
+					"name", e.name,
+					"calls", double(e.stat.calls),
+					"time", seconds,
+					"percent", (elapsed > 0.0) ? (100.0 * seconds / elapsed) : 0.0));
+			}
+		},
+		"frames", [&]{
+			checkNumArgs(tokens, 2, "");
+			const auto& h = profiler.getFrameHistory();
+			auto n = std::min<uint64_t>(profiler.getNumFrames(), HISTORY_SIZE);
+			// the most recent 'n' frames, oldest first
+			for (auto i : xrange(n)) {
+				result.addListElement(h.total[(h.pos + HISTORY_SIZE - n + i) % HISTORY_SIZE]);
+			}
+		});
+}
+
+std::string HostProfiler::Cmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Measure how much host time is spent in the emulation of each device.\n"
+	       "profile start                 start (or continue) measuring\n"
+	       "profile stop                  stop measuring\n"
+	       "profile clear                 discard all measurements\n"
+	       "profile status                returns 'running' or 'stopped' and the measured\n"
+	       "                              time (in seconds)\n"
+	       "profile report [-category <category>] [-count <n>]\n"
+	       "                              returns the <n> (default 20) most expensive\n"
+	       "                              entries, each a dict with category, name (C++\n"
+	       "                              class), calls, time (in s) and percent (of the\n"
+	       "                              measured time)\n"
+	       "profile frames                returns the host time (in ms) of the last 256\n"
+	       "                              emulated frames\n"
+	       "Categories are: schedulable, sound, render, io_read and io_write.\n"
+	       "Times are exclusive: time spent in a nested category is not included.\n";
+}
+
+void HostProfiler::Cmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	if (tokens.size() == 2) {
+		static constexpr std::array cmds = {
+			"start"sv, "stop"sv, "clear"sv, "status"sv, "report"sv, "frames"sv,
+		};
+		completeString(tokens, cmds);
+	} else if (tokens[1] == "report") {
+		static constexpr std::array options = {
+			"-category"sv, "-count"sv,
+			"schedulable"sv, "sound"sv, "render"sv, "io_read"sv, "io_write"sv,
+		};
+		completeString(tokens, options);
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,165 @@
+#ifndef HOSTPROFILER_HH
+#define HOSTPROFILER_HH
+
+#include "Command.hh"
+#include "HostProfilerState.hh"
+
+#include "hash_map.hh"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+
+namespace openmsx {
+
+class Reactor;
+
+/** Measures how much host (wall-clock) time is spent in the different parts
+  * of the emulation: per Schedulable (executeUntil), per SoundDevice
+  * (generateChannels), per Rasterizer (draw) and per I/O device (readIO and
+  * writeIO). Results are grouped per C++ class. In addition the host time
+  * per emulated frame is recorded. This helps to find out which device is
+  * responsible when a machine runs slower than real time.
+  *
+  * The measured times are 'exclusive': when e.g. a Schedulable triggers
+  * sound generation, that time is only counted for the SoundDevice.
+  *
+  * When the profiler is not running, the overhead is a single (well
+  * predicted) test per instrumented call.
+  *
+  * Scopes may also run on other threads (e.g. sound generation on the
+  * ThreadPool). The nesting administration is kept per thread, results
+  * from other threads are queued and merged on the main thread. stop()
+  * waits until all scopes on other threads have ended, so afterwards those
+  * threads no longer access the profiler.
+  */
+class HostProfiler
+{
+public:
+	enum class Category : uint8_t { SCHEDULABLE, SOUND, RENDER, IO_READ, IO_WRITE, NUM };
+	static constexpr auto NUM_CATEGORIES = size_t(Category::NUM);
+	[[nodiscard]] static std::string_view getCategoryName(Category category);
+
+	struct Stat {
+		uint64_t calls = 0;
+		uint64_t nanos = 0;
+	};
+	struct Entry {
+		Category category;
+		std::string name; // name of the C++ class
+		Stat stat;
+	};
+
+	/** Number of frames for which the per-frame statistics are kept. */
+	static constexpr size_t HISTORY_SIZE = 256;
+	struct FrameHistory {
+		// Host time (in ms) spent on each emulated frame, and per category.
+		// Circular buffers, 'pos' is the position of the oldest frame.
+		std::array<float, HISTORY_SIZE> total = {};
+		std::array<std::array<float, HISTORY_SIZE>, NUM_CATEGORIES> category = {};
+		size_t pos = 0;
+	};
+
+	/** Measures the time between construction and destruction (only when
+	  * the profiler is running). */
+	class Scope {
+	public:
+		template<typename T>
+		Scope(Category category_, const T& object) {
+			if (HostProfilerState::isProfiling()) [[unlikely]] {
+				begin(category_, typeid(object));
+			}
+		}
+		~Scope() {
+			if (profiler) [[unlikely]] end();
+		}
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		Scope& operator=(Scope&&) = delete;
+
+	private:
+		void begin(Category category, const std::type_info& type);
+		void end();
+
+	private:
+		HostProfiler* profiler = nullptr;
+		const std::type_info* type = nullptr;
+		uint64_t start = 0;
+		uint64_t savedChildNanos = 0;
+		Category category = Category::NUM;
+		bool worker = false; // not on the main thread
+	};
+
+	/** Should be called at the end of each emulated frame. */
+	static void frameEnd() {
+		if (auto* p = HostProfilerState::active.load(std::memory_order_relaxed)) [[unlikely]] p->nextFrame();
+	}
+
+public:
+	explicit HostProfiler(Reactor& reactor);
+	HostProfiler(const HostProfiler&) = delete;
+	HostProfiler(HostProfiler&&) = delete;
+	HostProfiler& operator=(const HostProfiler&) = delete;
+	HostProfiler& operator=(HostProfiler&&) = delete;
+	~HostProfiler();
+
+	void start();
+	void stop();
+	void clear();
+	[[nodiscard]] bool isRunning() const { return HostProfilerState::active.load(std::memory_order_relaxed) == this; }
+
+	/** Host time (in seconds) during which the profiler was running. */
+	[[nodiscard]] double getElapsed() const;
+	[[nodiscard]] uint64_t getNumFrames() const { return numFrames; }
+	[[nodiscard]] const FrameHistory& getFrameHistory() const { return history; }
+
+	/** All measurements, sorted from most to least time. */
+	[[nodiscard]] std::vector<Entry> getReport();
+
+private:
+	void add(Category category, const std::type_info* type, uint64_t nanos);
+	void mergePending();
+	void nextFrame();
+
+private:
+	// Number of scopes in progress on other threads. Static, so that it can
+	// be incremented before the profiler itself is accessed.
+	static inline std::atomic<unsigned> workerScopes = 0;
+
+	// only accessed from the main thread
+	std::array<hash_map<const std::type_info*, Stat>, NUM_CATEGORIES> stats;
+
+	// measurements from other threads, not yet merged in 'stats'
+	struct Pending {
+		const std::type_info* type;
+		uint64_t nanos;
+		Category category;
+	};
+	std::mutex pendingMutex;
+	std::vector<Pending> pending;
+
+	uint64_t startTime = 0; // only valid while running
+	uint64_t elapsedNanos = 0; // of the previous start/stop periods
+
+	std::array<uint64_t, NUM_CATEGORIES> frameNanos = {}; // in the current frame
+	uint64_t frameStart = 0; // 0 when no frame has started yet
+	uint64_t numFrames = 0;
+	FrameHistory history;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} cmd;
+};
+
+} // namespace openmsx
+
+#endif
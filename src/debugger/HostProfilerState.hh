@@ -0,0 +1,27 @@
+#ifndef HOSTPROFILERSTATE_HH
+#define HOSTPROFILERSTATE_HH
+
+#include <atomic>
+
+namespace openmsx {
+
+class HostProfiler;
+
+/** The currently running HostProfiler (if any). Kept separate from
+  * HostProfiler.hh, so that hot inline code (e.g. MSXCPUInterface::readIO())
+  * can test it without pulling in the whole profiler.
+  */
+struct HostProfilerState
+{
+	// Written on the main thread, read (also) on other threads.
+	static inline std::atomic<HostProfiler*> active = nullptr;
+
+	/** Is any profiler running? Allows to skip the Scope on hot paths. */
+	[[nodiscard]] static bool isProfiling() {
+		return active.load(std::memory_order_relaxed) != nullptr;
+	}
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,177 @@
+#include "MemorySearch.hh"
+
+#include "CommandException.hh"
+#include "Debuggable.hh"
+#include "Debugger.hh"
+#include "MSXMotherBoard.hh"
+#include "TclArgParser.hh"
+#include "TclObject.hh"
+
+#include "narrow.hh"
+#include "outer.hh"
+#include "view.hh"
+
+#include <algorithm>
+
+namespace openmsx {
+
+MemorySearch::MemorySearch(MSXMotherBoard& motherBoard_)
+	: motherBoard(motherBoard_)
+	, cmd(motherBoard.getCommandController())
+{
+}
+
+Debuggable& MemorySearch::getDebuggable() const
+{
+	auto* debuggable = motherBoard.getDebugger().findDebuggable(debuggableName);
+	if (!debuggable) {
+		throw CommandException("No such debuggable: ", debuggableName);
+	}
+	return *debuggable;
+}
+
+void MemorySearch::start(std::string_view name, bool word_, bool isSigned_)
+{
+	auto* debuggable = motherBoard.getDebugger().findDebuggable(name);
+	if (!debuggable) throw CommandException("No such debuggable: ", name);
+
+	debuggableName = name;
+	core.start(*debuggable, word_, isSigned_);
+}
+
+void MemorySearch::search(Compare compare, std::optional<int> value)
+{
+	if (!isStarted()) throw CommandException("No search started");
+	auto& debuggable = getDebuggable();
+	if (debuggable.getSize() != core.getSize()) {
+		throw CommandException("The size of debuggable '", debuggableName,
+		                       "' has changed, please start a new search");
+	}
+	core.search(debuggable, compare, value);
+}
+
+
+// class MemorySearch::Cmd
+
+MemorySearch::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "memory_search")
+{
+}
+
+[[nodiscard]] static std::optional<MemorySearch::Compare> parseCompare(std::string_view str)
+{
+	using enum MemorySearch::Compare;
+	if (str == "equal")         return EQUAL;
+	if (str == "not_equal")     return NOT_EQUAL;
+	if (str == "less")          return LESS;
+	if (str == "less_equal")    return LESS_EQUAL;
+	if (str == "greater")       return GREATER;
+	if (str == "greater_equal") return GREATER_EQUAL;
+	return {};
+}
+
+void MemorySearch::Cmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{2}, "subcommand ?arg ...?");
+	auto& memorySearch = OUTER(MemorySearch, cmd);
+	executeSubCommand(tokens[1].getString(),
+		"start", [&]{
+			std::string_view debuggable = "memory";
+			std::optional<int> width;
+			bool isSigned = false;
+			std::array info = {
+				valueArg("-debuggable", debuggable),
+				valueArg("-width", width),
+				flagArg("-signed", isSigned),
+			};
+			auto args = parseTclArgs(getInterpreter(), tokens.subspan(2), info);
+			if (!args.empty()) throw SyntaxError();
+			if (width && (*width != 8) && (*width != 16)) {
+				throw CommandException("Invalid width, must be 8 or 16");
+			}
+			memorySearch.start(debuggable, width.value_or(8) == 16, isSigned);
+			result = narrow<int>(memorySearch.getNumCandidates());
+		},
+		"search", [&]{
+			checkNumArgs(tokens, Between{3, 4}, "compare ?value?");
+			auto str = tokens[2].getString();
+			std::optional<int> value;
+			if (tokens.size() == 4) value = tokens[3].getInt(getInterpreter());
+			auto compare = [&] {
+				if (str == "changed" || str == "unchanged") {
+					if (value) throw SyntaxError();
+					return (str == "changed") ? Compare::NOT_EQUAL : Compare::EQUAL;
+				}
+				if (auto c = parseCompare(str)) return *c;
+				throw CommandException("Unknown comparison: ", str);
+			}();
+			memorySearch.search(compare, value);
+			result = narrow<int>(memorySearch.getNumCandidates());
+		},
+		"count", [&]{
+			checkNumArgs(tokens, 2, "");
+			result = narrow<int>(memorySearch.getNumCandidates());
+		},
+		"results", [&]{
+			std::optional<int> count;
+			std::array info = {valueArg("-count", count)};
+			auto args = parseTclArgs(getInterpreter(), tokens.subspan(2), info);
+			if (!args.empty()) throw SyntaxError();
+			auto max = size_t(std::max(0, count.value_or(100)));
+			for (const auto& r : memorySearch.getResults(max)) {
+				result.addListElement(makeTclList(r.address, r.oldValue, r.newValue));
+			}
+		});
+}
+
+std::string MemorySearch::Cmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Fast search for memory locations, e.g. to find cheats.\n"
+	       "memory_search start [-debuggable <name>] [-width 8|16] [-signed]\n"
+	       "                                    start a new search in the given debuggable\n"
+	       "                                    (default 'memory'), all addresses are\n"
+	       "                                    candidates, returns the number of candidates\n"
+	       "memory_search search <compare> [<value>]\n"
+	       "                                    only keep the candidates for which the\n"
+	       "                                    current value compares to <value>, or to the\n"
+	       "                                    value at the previous search, returns the\n"
+	       "                                    number of remaining candidates\n"
+	       "memory_search count                 returns the number of candidates\n"
+	       "memory_search results [-count <n>]  returns the first <n> (default 100)\n"
+	       "                                    candidates, each as {address old new}\n"
+	       "<compare> is one of: equal, not_equal, less, less_equal, greater, greater_equal,\n"
+	       "changed or unchanged (the latter two don't take a value).\n"
+	       "16-bit values are little endian.\n";
+}
+
+void MemorySearch::Cmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	if (tokens.size() == 2) {
+		static constexpr std::array cmds = {
+			"start"sv, "search"sv, "count"sv, "results"sv,
+		};
+		completeString(tokens, cmds);
+	} else if (tokens[1] == "start") {
+		if (tokens[tokens.size() - 2] == "-debuggable") {
+			const auto& memorySearch = OUTER(MemorySearch, cmd);
+			completeString(tokens, view::keys(memorySearch.motherBoard.getDebugger().getDebuggables()));
+		} else {
+			static constexpr std::array options = {
+				"-debuggable"sv, "-width"sv, "-signed"sv,
+			};
+			completeString(tokens, options);
+		}
+	} else if ((tokens[1] == "search") && (tokens.size() == 3)) {
+		static constexpr std::array compares = {
+			"equal"sv, "not_equal"sv, "less"sv, "less_equal"sv,
+			"greater"sv, "greater_equal"sv, "changed"sv, "unchanged"sv,
+		};
+		completeString(tokens, compares);
+	} else if (tokens[1] == "results") {
+		static constexpr std::array options = {"-count"sv};
+		completeString(tokens, options);
+	}
+}
+
+} // namespace openmsx
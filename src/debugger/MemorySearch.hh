@@ -0,0 +1,69 @@
+#ifndef MEMORYSEARCH_HH
+#define MEMORYSEARCH_HH
+
+#include "Command.hh"
+#include "MemorySearchCore.hh"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openmsx {
+
+class Debuggable;
+class MSXMotherBoard;
+
+/** Native implementation of the search in a 'cheat finder': take a snapshot
+  * of a debuggable (e.g. 'memory' or the full memory mapper), and then
+  * repeatedly narrow down the set of candidate addresses by comparing the
+  * current content with the previous snapshot or with a given value.
+  *
+  * This class looks up the debuggable (by name) and provides the
+  * 'memory_search' command, the search itself is done by MemorySearchCore.
+  */
+class MemorySearch
+{
+public:
+	using Compare = MemorySearchCore::Compare;
+	using Result = MemorySearchCore::Result;
+
+	explicit MemorySearch(MSXMotherBoard& motherBoard);
+
+	/** Start a new search, all addresses in the debuggable are candidates. */
+	void start(std::string_view debuggable, bool word, bool isSigned);
+
+	/** Only keep the candidates for which the current value compares
+	  * (according to 'compare') to 'value', or to the value at the previous
+	  * search if no value is given. */
+	void search(Compare compare, std::optional<int> value);
+
+	[[nodiscard]] bool isStarted() const { return core.isStarted(); }
+	[[nodiscard]] const std::string& getDebuggableName() const { return debuggableName; }
+	[[nodiscard]] bool isWord() const { return core.isWord(); }
+	[[nodiscard]] bool isSigned() const { return core.isSigned(); }
+	[[nodiscard]] size_t getNumCandidates() const { return core.getNumCandidates(); }
+
+	/** The first (lowest address) 'max' candidates. */
+	[[nodiscard]] std::vector<Result> getResults(size_t max) const { return core.getResults(max); }
+
+private:
+	[[nodiscard]] Debuggable& getDebuggable() const;
+
+private:
+	MSXMotherBoard& motherBoard;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} cmd;
+
+	std::string debuggableName;
+	MemorySearchCore core;
+};
+
+} // namespace openmsx
+
+#endif
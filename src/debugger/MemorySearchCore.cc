@@ -0,0 +1,169 @@
+#include "MemorySearchCore.hh"
+
+#include "Debuggable.hh"
+
+#include "narrow.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <functional>
+#include <span>
+
+namespace openmsx {
+
+static constexpr unsigned CHUNK_SIZE = MemorySearchCore::CHUNK_SIZE;
+static constexpr unsigned WORDS_PER_CHUNK = CHUNK_SIZE / 64;
+
+template<typename T>
+[[nodiscard]] static T loadValue(const uint8_t* p)
+{
+	if constexpr (sizeof(T) == 1) {
+		return T(p[0]);
+	} else {
+		return T(uint16_t(p[0] | (p[1] << 8))); // little endian
+	}
+}
+
+void MemorySearchCore::start(Debuggable& debuggable, bool word_, bool isSigned_)
+{
+	word = word_;
+	signedValues = isSigned_;
+
+	auto size = debuggable.getSize();
+	current.resize(size);
+	debuggable.peekBlock(0, current);
+	previous = current;
+	next.resize(size);
+
+	// a 16-bit value at the last address would extend past the end
+	auto num = (word && size) ? size - 1 : size;
+	candidates.assign((size + 63) / 64, 0);
+	for (auto i : xrange(num / 64)) candidates[i] = ~uint64_t(0);
+	if (auto rest = num % 64) candidates[num / 64] = (uint64_t(1) << rest) - 1;
+
+	auto numChunks = (num + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunks.assign((numChunks + 63) / 64, 0);
+	for (auto c : xrange(numChunks)) chunks[c / 64] |= uint64_t(1) << (c % 64);
+
+	numCandidates = num;
+}
+
+template<typename T, bool WITH_VALUE, typename Cmp>
+void MemorySearchCore::filter(Debuggable& debuggable, Cmp cmp, int value)
+{
+	auto size = narrow<unsigned>(current.size());
+	static constexpr unsigned extra = sizeof(T) - 1; // 16-bit values also use the next byte
+	auto num = size - extra;
+
+	std::vector<unsigned> visited;
+	numCandidates = 0;
+	for (auto cw : xrange(chunks.size())) {
+		for (auto bits = chunks[cw]; bits; bits &= bits - 1) {
+			auto c = narrow<unsigned>(64 * cw + std::countr_zero(bits));
+			auto start = c * CHUNK_SIZE;
+			auto len = std::min(CHUNK_SIZE + extra, size - start);
+			debuggable.peekBlock(start, std::span{next}.subspan(start, len));
+			visited.push_back(c);
+
+			uint64_t any = 0;
+			auto endWord = std::min<size_t>(start / 64 + WORDS_PER_CHUNK, candidates.size());
+			for (auto w : xrange<size_t>(start / 64, endWord)) {
+				auto mask = candidates[w];
+				if (!mask) continue;
+				auto base = narrow<unsigned>(64 * w);
+				auto n = std::min(64u, num - base);
+				const auto* pNew = &next[base];
+				const auto* pOld = &current[base];
+				// branch-free, so that the compiler can vectorize this loop
+				uint64_t keep = 0;
+				for (auto i : xrange(n)) {
+					auto newValue = loadValue<T>(pNew + i);
+					bool match = [&] {
+						if constexpr (WITH_VALUE) {
+							return cmp(int(newValue), value);
+						} else {
+							return cmp(newValue, loadValue<T>(pOld + i));
+						}
+					}();
+					keep |= uint64_t(match) << i;
+				}
+				keep &= mask;
+				candidates[w] = keep;
+				numCandidates += std::popcount(keep);
+				any |= keep;
+			}
+			if (!any) chunks[cw] &= ~(uint64_t(1) << (c % 64));
+		}
+	}
+
+	// Only now update the snapshots: a 16-bit value at the end of a chunk
+	// needs the old value of the first byte of the next chunk.
+	for (auto c : visited) {
+		auto start = c * CHUNK_SIZE;
+		auto len = std::min(CHUNK_SIZE + extra, size - start);
+		std::copy_n(&current[start], len, &previous[start]);
+	}
+	for (auto c : visited) {
+		auto start = c * CHUNK_SIZE;
+		auto len = std::min(CHUNK_SIZE + extra, size - start);
+		std::copy_n(&next[start], len, &current[start]);
+	}
+}
+
+void MemorySearchCore::search(Debuggable& debuggable, Compare compare, std::optional<int> value)
+{
+	assert(isStarted());
+	assert(debuggable.getSize() == current.size());
+
+	auto withCompare = [&](auto cmp) {
+		auto withType = [&](auto tag) {
+			using T = decltype(tag);
+			if (value) {
+				filter<T, true>(debuggable, cmp, *value);
+			} else {
+				filter<T, false>(debuggable, cmp, 0);
+			}
+		};
+		if (word) {
+			if (signedValues) withType(int16_t{}); else withType(uint16_t{});
+		} else {
+			if (signedValues) withType(int8_t{}); else withType(uint8_t{});
+		}
+	};
+	switch (compare) {
+		case Compare::EQUAL:         withCompare(std::equal_to<>{});      break;
+		case Compare::NOT_EQUAL:     withCompare(std::not_equal_to<>{});  break;
+		case Compare::LESS:          withCompare(std::less<>{});          break;
+		case Compare::LESS_EQUAL:    withCompare(std::less_equal<>{});    break;
+		case Compare::GREATER:       withCompare(std::greater<>{});       break;
+		case Compare::GREATER_EQUAL: withCompare(std::greater_equal<>{}); break;
+	}
+}
+
+int MemorySearchCore::load(const std::vector<uint8_t>& data, unsigned address) const
+{
+	const auto* p = &data[address];
+	if (word) {
+		return signedValues ? int(loadValue<int16_t>(p)) : int(loadValue<uint16_t>(p));
+	} else {
+		return signedValues ? int(loadValue<int8_t>(p)) : int(loadValue<uint8_t>(p));
+	}
+}
+
+std::vector<MemorySearchCore::Result> MemorySearchCore::getResults(size_t max) const
+{
+	std::vector<Result> result;
+	result.reserve(std::min(max, numCandidates));
+	for (auto w : xrange(candidates.size())) {
+		for (auto bits = candidates[w]; bits; bits &= bits - 1) {
+			if (result.size() == max) return result;
+			auto address = narrow<unsigned>(64 * w + std::countr_zero(bits));
+			result.push_back({address, load(previous, address), load(current, address)});
+		}
+	}
+	return result;
+}
+
+} // namespace openmsx
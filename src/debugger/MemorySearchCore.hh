@@ -0,0 +1,72 @@
+#ifndef MEMORYSEARCHCORE_HH
+#define MEMORYSEARCHCORE_HH
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace openmsx {
+
+class Debuggable;
+
+/** The actual search algorithm of MemorySearch, independent of the MSX
+  * machine (and of the Tcl command), so that it can be unit-tested.
+  *
+  * Values are 8 or 16 bit (little endian), signed or unsigned. The candidates
+  * are stored in a two-level bitmap: one bit per address plus one bit per
+  * chunk of addresses that still contains candidates. Chunks without
+  * candidates are skipped entirely (they're not even read anymore), so
+  * after the first few searches only a tiny part of memory is examined.
+  */
+class MemorySearchCore
+{
+public:
+	enum class Compare : uint8_t {
+		EQUAL, NOT_EQUAL, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL
+	};
+
+	struct Result {
+		unsigned address;
+		int oldValue; // at the previous search
+		int newValue; // at the last search
+	};
+
+	static constexpr unsigned CHUNK_SIZE = 512; // addresses per chunk
+
+	/** Start a new search, all addresses in the debuggable are candidates. */
+	void start(Debuggable& debuggable, bool word, bool isSigned);
+
+	/** Only keep the candidates for which the current value compares
+	  * (according to 'compare') to 'value', or to the value at the previous
+	  * search if no value is given.
+	  * Requires that a search was started on a debuggable of the same size. */
+	void search(Debuggable& debuggable, Compare compare, std::optional<int> value);
+
+	[[nodiscard]] bool isStarted() const { return !current.empty(); }
+	[[nodiscard]] size_t getSize() const { return current.size(); }
+	[[nodiscard]] bool isWord() const { return word; }
+	[[nodiscard]] bool isSigned() const { return signedValues; }
+	[[nodiscard]] size_t getNumCandidates() const { return numCandidates; }
+
+	/** The first (lowest address) 'max' candidates. */
+	[[nodiscard]] std::vector<Result> getResults(size_t max) const;
+
+private:
+	[[nodiscard]] int load(const std::vector<uint8_t>& data, unsigned address) const;
+	template<typename T, bool WITH_VALUE, typename Cmp>
+	void filter(Debuggable& debuggable, Cmp cmp, int value);
+
+private:
+	std::vector<uint8_t> previous; // content at the previous search
+	std::vector<uint8_t> current;  // content at the last search
+	std::vector<uint8_t> next;     // scratch buffer, to read the new content
+	std::vector<uint64_t> candidates; // one bit per address
+	std::vector<uint64_t> chunks; // one bit per chunk (of CHUNK_SIZE addresses)
+	size_t numCandidates = 0;
+	bool word = false;
+	bool signedValues = false;
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,267 @@
+#include "SamplingProfiler.hh"
+
+#include "CommandException.hh"
+#include "Debuggable.hh"
+#include "Debugger.hh"
+#include "File.hh"
+#include "FileContext.hh"
+#include "FileOperations.hh"
+#include "CPURegs.hh"
+#include "MSXCPU.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXMemoryMapperBase.hh"
+#include "MSXMotherBoard.hh"
+#include "MSXRom.hh"
+#include "Reactor.hh"
+#include "RomPlain.hh"
+#include "SymbolManager.hh"
+#include "TclArgParser.hh"
+#include "TclObject.hh"
+
+#include "narrow.hh"
+#include "outer.hh"
+#include "ranges.hh"
+#include "stl.hh"
+#include "strCat.hh"
+#include "view.hh"
+
+#include <optional>
+#include <tuple>
+
+namespace openmsx {
+
+static constexpr double DEFAULT_INTERVAL = 0.0001; // 10kHz
+
+[[nodiscard]] static uint64_t pack(const SamplingProfiler::Location& loc)
+{
+	return uint64_t(loc.pc)
+	     | (uint64_t(loc.ps) << 16)
+	     | (uint64_t(loc.ss + 1) << 18)
+	     | (uint64_t(loc.segment + 1) << 21);
+}
+
+[[nodiscard]] static SamplingProfiler::Location unpack(uint64_t key)
+{
+	return {.pc = uint16_t(key & 0xffff),
+	        .ps = uint8_t((key >> 16) & 3),
+	        .ss = int8_t(int((key >> 18) & 7) - 1),
+	        .segment = int((key >> 21) & 0xffffff) - 1};
+}
+
+std::string SamplingProfiler::Location::slotString() const
+{
+	std::string result = strCat(ps);
+	if (ss >= 0) strAppend(result, '-', ss);
+	if (segment >= 0) strAppend(result, ':', segment);
+	return result;
+}
+
+SamplingProfiler::SamplingProfiler(MSXMotherBoard& motherBoard_)
+	: Schedulable(motherBoard_.getScheduler())
+	, motherBoard(motherBoard_)
+	, cmd(motherBoard.getCommandController())
+	, interval(DEFAULT_INTERVAL)
+{
+}
+
+SamplingProfiler::~SamplingProfiler() = default;
+
+void SamplingProfiler::start(EmuDuration interval_)
+{
+	interval = interval_;
+	if (!running) {
+		running = true;
+		setSyncPoint(getCurrentTime() + interval);
+	}
+}
+
+void SamplingProfiler::stop()
+{
+	removeSyncPoints();
+	running = false;
+}
+
+void SamplingProfiler::clear()
+{
+	samples.clear();
+	totalSamples = 0;
+}
+
+void SamplingProfiler::executeUntil(EmuTime::param time)
+{
+	sample();
+	setSyncPoint(time + interval);
+}
+
+void SamplingProfiler::sample()
+{
+	auto& cpuInterface = motherBoard.getCPUInterface();
+	Location loc;
+	loc.pc = motherBoard.getCPU().getRegisters().getPC();
+	int page = loc.pc / 0x4000;
+	loc.ps = narrow<uint8_t>(cpuInterface.getPrimarySlot(page));
+	loc.ss = cpuInterface.isExpanded(loc.ps) ? narrow<int8_t>(cpuInterface.getSecondarySlot(page)) : -1;
+	loc.segment = -1;
+	const auto* device = cpuInterface.getVisibleMSXDevice(page);
+	if (const auto* mapper = dynamic_cast<const MSXMemoryMapperBase*>(device)) {
+		loc.segment = mapper->getSelectedSegment(narrow<uint8_t>(page));
+	} else if (const auto* rom = dynamic_cast<const MSXRom*>(device);
+	           rom && !dynamic_cast<const RomPlain*>(rom)) {
+		if (auto* romBlocks = motherBoard.getDebugger().findDebuggable(rom->getName() + " romblocks")) {
+			loc.segment = romBlocks->read(loc.pc);
+		}
+	}
+	++samples[pack(loc)];
+	++totalSamples;
+}
+
+std::vector<SamplingProfiler::Entry> SamplingProfiler::getReport(GroupBy groupBy)
+{
+	// Find the function containing an address.
+	auto& symbolManager = motherBoard.getReactor().getSymbolManager();
+	auto findSymbol = [&](uint16_t addr) -> std::pair<std::string, uint16_t> {
+		auto syms = symbolManager.lookupNearest(addr);
+		if (syms.empty()) return {};
+		// use the same name as e.g. the disassembly view
+		const auto& sym = *syms.front();
+		return {sym.name, narrow_cast<uint16_t>(addr - sym.value)};
+	};
+
+	hash_map<uint64_t, Entry> entries;
+	for (const auto& [key, count] : samples) {
+		auto loc = unpack(key);
+		auto [symbol, offset] = findSymbol(loc.pc);
+		auto groupKey = key;
+		if (groupBy == GroupBy::FUNCTION && !symbol.empty()) {
+			loc.pc = narrow_cast<uint16_t>(loc.pc - offset);
+			offset = 0;
+			groupKey = pack(loc) | (uint64_t(1) << 63);
+		}
+		auto [it, inserted] = entries.try_emplace(groupKey, Entry{loc, 0, std::move(symbol), offset});
+		it->second.samples += count;
+	}
+
+	auto result = to_vector<Entry>(view::values(entries));
+	ranges::sort(result, [](const Entry& x, const Entry& y) {
+		return std::tuple(y.samples, x.location.pc) < std::tuple(x.samples, y.location.pc);
+	});
+	return result;
+}
+
+void SamplingProfiler::saveFolded(const std::string& filename)
+{
+	std::string text;
+	for (const auto& e : getReport(GroupBy::FUNCTION)) {
+		strAppend(text, "slot_", e.location.slotString(), ';');
+		if (e.symbol.empty()) {
+			strAppend(text, '#', hex_string<4>(e.location.pc));
+		} else {
+			text += e.symbol;
+		}
+		strAppend(text, ' ', e.samples, '\n');
+	}
+	File file(filename, File::OpenMode::TRUNCATE);
+	file.write(std::span{text});
+}
+
+
+// class SamplingProfiler::Cmd
+
+SamplingProfiler::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "cpu_profiler")
+{
+}
+
+void SamplingProfiler::Cmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{2}, "subcommand ?arg ...?");
+	auto& profiler = OUTER(SamplingProfiler, cmd);
+	executeSubCommand(tokens[1].getString(),
+		"start", [&]{
+			checkNumArgs(tokens, Between{2, 3}, "?interval?");
+			auto interval = DEFAULT_INTERVAL;
+			if (tokens.size() == 3) {
+				interval = tokens[2].getDouble(getInterpreter());
+				if (interval < 1e-6 || interval > 1.0) {
+					throw CommandException("Interval must be between 1us and 1s");
+				}
+			}
+			profiler.start(EmuDuration(interval));
+		},
+		"stop", [&]{
+			checkNumArgs(tokens, 2, "");
+			profiler.stop();
+		},
+		"clear", [&]{
+			checkNumArgs(tokens, 2, "");
+			profiler.clear();
+		},
+		"status", [&]{
+			checkNumArgs(tokens, 2, "");
+			result.addListElement(profiler.isRunning() ? "running" : "stopped",
+			                      narrow_cast<unsigned>(profiler.getTotalSamples()));
+		},
+		"report", [&]{
+			std::string_view by = "function";
+			std::optional<int> count;
+			std::array info = {valueArg("-by", by), valueArg("-count", count)};
+			auto args = parseTclArgs(getInterpreter(), tokens.subspan(2), info);
+			if (!args.empty()) throw SyntaxError();
+			auto groupBy = [&] {
+				if (by == "function") return GroupBy::FUNCTION;
+				if (by == "address") return GroupBy::ADDRESS;
+				throw CommandException("Invalid value for -by, must be 'function' or 'address'");
+			}();
+			auto entries = profiler.getReport(groupBy);
+			auto n = std::min(entries.size(), size_t(std::max(0, count.value_or(20))));
+			for (const auto& e : std::span{entries}.first(n)) {
+				result.addListElement(makeTclDict(
+					"samples", narrow_cast<unsigned>(e.samples),
+					"slot", e.location.slotString(),
+					"address", e.location.pc,
+					"symbol", e.symbol,
+					"offset", e.offset));
+			}
+		},
+		"folded", [&]{
+			checkNumArgs(tokens, 3, "filename");
+			profiler.saveFolded(FileOperations::expandTilde(std::string(tokens[2].getString())));
+		});
+}
+
+std::string SamplingProfiler::Cmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Statistical profiler: periodically samples where the CPU is executing.\n"
+	       "cpu_profiler start [<interval>]   start (or continue) sampling, default interval\n"
+	       "                                  is 0.0001s (in emulated time)\n"
+	       "cpu_profiler stop                 stop sampling\n"
+	       "cpu_profiler clear                discard all samples\n"
+	       "cpu_profiler status               returns 'running' or 'stopped' and the number\n"
+	       "                                  of samples\n"
+	       "cpu_profiler report [-by function|address] [-count <n>]\n"
+	       "                                  returns the <n> (default 20) locations with\n"
+	       "                                  the most samples, grouped per function (the\n"
+	       "                                  nearest preceding symbol) or per address\n"
+	       "cpu_profiler folded <filename>    save the samples in 'folded stacks' format\n"
+	       "                                  (e.g. for flamegraph.pl)\n";
+}
+
+void SamplingProfiler::Cmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	if (tokens.size() == 2) {
+		static constexpr std::array cmds = {
+			"start"sv, "stop"sv, "clear"sv, "status"sv, "report"sv, "folded"sv,
+		};
+		completeString(tokens, cmds);
+	} else if (tokens[1] == "report") {
+		static constexpr std::array options = {
+			"-by"sv, "-count"sv, "function"sv, "address"sv,
+		};
+		completeString(tokens, options);
+	} else if (tokens[1] == "folded") {
+		completeFileName(tokens, userFileContext());
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,90 @@
+#ifndef SAMPLINGPROFILER_HH
+#define SAMPLINGPROFILER_HH
+
+#include "Command.hh"
+#include "EmuDuration.hh"
+#include "Schedulable.hh"
+
+#include "hash_map.hh"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class MSXMotherBoard;
+
+/** Statistical profiler for the emulated CPU: at a fixed (emulated) time
+  * interval it records where the CPU is executing (PC plus the slot and
+  * segment that are visible at that address). The samples can afterwards be
+  * aggregated per address or per function (= nearest preceding symbol, see
+  * SymbolManager).
+  *
+  * When not running, it has no overhead at all: it only uses the regular
+  * scheduler (no per-instruction hooks).
+  */
+class SamplingProfiler final : private Schedulable
+{
+public:
+	/** Where the CPU was executing. */
+	struct Location {
+		uint16_t pc;
+		uint8_t ps;
+		int8_t ss; // -1 when the primary slot is not expanded
+		int segment; // -1 when unknown (no mapper or megarom)
+
+		[[nodiscard]] std::string slotString() const;
+	};
+
+	enum class GroupBy { ADDRESS, FUNCTION };
+
+	struct Entry {
+		Location location; // for GroupBy::FUNCTION: address of the symbol
+		uint64_t samples;
+		std::string symbol; // empty when no symbol (at or before 'pc') is known
+		uint16_t offset; // distance between 'pc' and 'symbol'
+	};
+
+	explicit SamplingProfiler(MSXMotherBoard& motherBoard);
+	~SamplingProfiler();
+
+	void start(EmuDuration interval);
+	void stop();
+	void clear();
+	[[nodiscard]] bool isRunning() const { return running; }
+	[[nodiscard]] uint64_t getTotalSamples() const { return totalSamples; }
+
+	/** Aggregated samples, sorted from most to least samples. */
+	[[nodiscard]] std::vector<Entry> getReport(GroupBy groupBy);
+
+	/** Write the samples in the 'folded stacks' format (as used by e.g.
+	  * flamegraph.pl). There are no real call stacks, each line has the
+	  * form 'slot;function count'. */
+	void saveFolded(const std::string& filename);
+
+private:
+	// Schedulable
+	void executeUntil(EmuTime::param time) override;
+
+	void sample();
+
+private:
+	MSXMotherBoard& motherBoard;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} cmd;
+
+	hash_map<uint64_t, uint64_t> samples; // packed Location -> count
+	uint64_t totalSamples = 0;
+	EmuDuration interval;
+	bool running = false;
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,306 @@
+#include "SharedMemoryExporter.hh"
+
+#include "CommandException.hh"
+#include "Debuggable.hh"
+#include "Debugger.hh"
+#include "Event.hh"
+#include "EventDistributor.hh"
+#include "MSXMotherBoard.hh"
+#include "Reactor.hh"
+#include "TclObject.hh"
+
+#include "endian.hh"
+#include "outer.hh"
+#include "ranges.hh"
+#include "stl.hh"
+#include "systemfuncs.hh"
+#include "view.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#if HAVE_SHM_OPEN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace openmsx {
+
+static constexpr size_t HEADER_SIZE = 64;
+static constexpr size_t DIR_ENTRY_SIZE = 64;
+static constexpr size_t NAME_SIZE = 56;
+static constexpr size_t ALIGNMENT = 64;
+static constexpr uint32_t LAYOUT_VERSION = 1;
+static constexpr size_t SEQUENCE_OFFSET = 16;
+static constexpr size_t CLOSED_OFFSET = 24;
+
+[[nodiscard]] static constexpr size_t alignUp(size_t size)
+{
+	return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+SharedMemoryExporter::SharedMemoryExporter(Reactor& reactor_)
+	: reactor(reactor_)
+	, cmd(reactor.getCommandController())
+{
+	reactor.getEventDistributor().registerEventListener(EventType::FINISH_FRAME, *this);
+}
+
+SharedMemoryExporter::~SharedMemoryExporter()
+{
+	reactor.getEventDistributor().unregisterEventListener(EventType::FINISH_FRAME, *this);
+	closeSegment();
+}
+
+void SharedMemoryExporter::refresh()
+{
+	if (segment.empty()) return;
+
+	std::atomic_ref<uint64_t> sequence(*std::bit_cast<uint64_t*>(&segment[SEQUENCE_OFFSET]));
+	auto seq = sequence.load(std::memory_order_relaxed);
+	sequence.store(seq + 1, std::memory_order_relaxed); // odd: update in progress
+	std::atomic_thread_fence(std::memory_order_release);
+
+	auto* motherBoard = reactor.getMotherBoard();
+	for (const auto& entry : entries) {
+		auto data = segment.subspan(entry.offset, entry.size);
+		auto* debuggable = motherBoard ? motherBoard->getDebugger().findDebuggable(entry.name)
+		                               : nullptr;
+		if (debuggable && (debuggable->getSize() >= entry.size)) {
+			// don't influence the emulation (timing, replays)
+			debuggable->peekBlock(0, data);
+		} else {
+			// e.g. machine got replaced by one without this debuggable
+			ranges::fill(data, 0);
+		}
+	}
+
+	sequence.store(seq + 2, std::memory_order_release);
+}
+
+void SharedMemoryExporter::add(std::span<const TclObject> tokens)
+{
+	auto* motherBoard = reactor.getMotherBoard();
+	if (!motherBoard) throw CommandException("No machine");
+	auto& debugger = motherBoard->getDebugger();
+
+	auto newEntries = entries;
+	for (const auto& token : tokens) {
+		auto name = token.getString();
+		auto* debuggable = debugger.findDebuggable(name);
+		if (!debuggable) {
+			throw CommandException("No such debuggable: ", name);
+		}
+		if (contains(newEntries, name, &Entry::name)) continue;
+		newEntries.push_back(Entry{std::string(name), 0, debuggable->getSize()});
+	}
+	std::swap(entries, newEntries);
+	try {
+		createSegment();
+	} catch (MSXException&) {
+		std::swap(entries, newEntries);
+		throw;
+	}
+}
+
+void SharedMemoryExporter::remove(std::span<const TclObject> tokens)
+{
+	for (const auto& token : tokens) {
+		if (!contains(entries, token.getString(), &Entry::name)) {
+			throw CommandException("Not exported: ", token.getString());
+		}
+	}
+	for (const auto& token : tokens) {
+		std::erase_if(entries, [&](const Entry& e) { return e.name == token.getString(); });
+	}
+	createSegment();
+}
+
+void SharedMemoryExporter::list(TclObject& result) const
+{
+	result.addListElements(view::transform(entries, &Entry::name));
+}
+
+void SharedMemoryExporter::autoRefresh(std::span<const TclObject> tokens, TclObject& result)
+{
+	if (tokens.size() == 3) {
+		autoRefreshEnabled = tokens[2].getBoolean(cmd.getInterpreter());
+	}
+	result = autoRefreshEnabled;
+}
+
+#if HAVE_SHM_OPEN
+
+void SharedMemoryExporter::createSegment()
+{
+	closeSegment();
+	if (entries.empty()) return;
+
+	// Calculate the layout.
+	size_t size = alignUp(HEADER_SIZE + entries.size() * DIR_ENTRY_SIZE);
+	for (auto& entry : entries) {
+		entry.offset = unsigned(size);
+		size = alignUp(size + entry.size);
+	}
+
+	auto name = strCat("/openmsx-", getpid());
+	shm_unlink(name.c_str()); // e.g. left behind by a crashed process
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0) {
+		throw CommandException("Couldn't create shared memory segment: ",
+		                       strerror(errno));
+	}
+	if (ftruncate(fd, off_t(size)) != 0) {
+		auto error = errno;
+		close(fd);
+		shm_unlink(name.c_str());
+		throw CommandException("Couldn't resize shared memory segment: ",
+		                       strerror(error));
+	}
+	void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		auto error = errno;
+		shm_unlink(name.c_str());
+		throw CommandException("Couldn't map shared memory segment: ",
+		                       strerror(error));
+	}
+	segment = std::span{static_cast<uint8_t*>(mem), size};
+	segmentName = std::move(name);
+
+	// Fill in the header and the directory, ftruncate() already zeroed
+	// everything else.
+	ranges::copy(std::string_view("openMSX"), &segment[0]);
+	Endian::write_UA_L32(&segment[8], LAYOUT_VERSION);
+	Endian::write_UA_L32(&segment[12], uint32_t(entries.size()));
+	for (auto i : xrange(entries.size())) {
+		const auto& entry = entries[i];
+		auto* dir = &segment[HEADER_SIZE + i * DIR_ENTRY_SIZE];
+		auto n = std::min(entry.name.size(), NAME_SIZE - 1);
+		ranges::copy(std::string_view(entry.name).substr(0, n), dir);
+		Endian::write_UA_L32(dir + NAME_SIZE + 0, entry.offset);
+		Endian::write_UA_L32(dir + NAME_SIZE + 4, entry.size);
+	}
+
+	refresh();
+}
+
+void SharedMemoryExporter::closeSegment()
+{
+	if (segment.empty()) return;
+	std::atomic_ref<uint32_t> closed(*std::bit_cast<uint32_t*>(&segment[CLOSED_OFFSET]));
+	closed.store(1, std::memory_order_release);
+	munmap(segment.data(), segment.size());
+	shm_unlink(segmentName.c_str());
+	segment = {};
+	segmentName.clear();
+}
+
+#else // HAVE_SHM_OPEN
+
+void SharedMemoryExporter::createSegment()
+{
+	if (entries.empty()) return;
+	throw CommandException("Shared memory is not supported on this platform");
+}
+
+void SharedMemoryExporter::closeSegment()
+{
+}
+
+#endif // HAVE_SHM_OPEN
+
+int SharedMemoryExporter::signalEvent(const Event& event)
+{
+	(void)event; // avoid warning for non-assert compiles
+	assert(getType(event) == EventType::FINISH_FRAME);
+	if (autoRefreshEnabled) refresh();
+	return 0;
+}
+
+
+// class SharedMemoryExporter::Cmd
+
+SharedMemoryExporter::Cmd::Cmd(CommandController& commandController_)
+	: Command(commandController_, "shared_memory")
+{
+}
+
+void SharedMemoryExporter::Cmd::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, AtLeast{2}, "subcommand ?arg ...?");
+	auto& exporter = OUTER(SharedMemoryExporter, cmd);
+	executeSubCommand(tokens[1].getString(),
+		"add", [&]{
+			checkNumArgs(tokens, AtLeast{3}, "debuggable ?debuggable ...?");
+			exporter.add(tokens.subspan(2));
+		},
+		"remove", [&]{
+			checkNumArgs(tokens, AtLeast{3}, "debuggable ?debuggable ...?");
+			exporter.remove(tokens.subspan(2));
+		},
+		"clear", [&]{
+			checkNumArgs(tokens, 2, "");
+			exporter.entries.clear();
+			exporter.closeSegment();
+		},
+		"list", [&]{
+			checkNumArgs(tokens, 2, "");
+			exporter.list(result);
+		},
+		"name", [&]{
+			checkNumArgs(tokens, 2, "");
+			result = exporter.segmentName;
+		},
+		"refresh", [&]{
+			checkNumArgs(tokens, 2, "");
+			exporter.refresh();
+		},
+		"auto_refresh", [&]{
+			checkNumArgs(tokens, Between{2, 3}, "?value?");
+			exporter.autoRefresh(tokens, result);
+		});
+}
+
+std::string SharedMemoryExporter::Cmd::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Make the content of debuggables available to external programs via shared memory.\n"
+	       "shared_memory add <debuggable> ...    start exporting the given debuggables\n"
+	       "shared_memory remove <debuggable> ... stop exporting the given debuggables\n"
+	       "shared_memory clear                   stop exporting all debuggables\n"
+	       "shared_memory list                    list the exported debuggables\n"
+	       "shared_memory name                    name of the shared memory segment\n"
+	       "shared_memory refresh                 update the content now\n"
+	       "shared_memory auto_refresh [<bool>]   query or set whether the content is\n"
+	       "                                      updated at the end of each frame (default on)\n"
+	       "Changing the list of debuggables creates a new segment (with the same name).\n"
+	       "See the source code (SharedMemoryExporter.hh) for the layout of the segment.\n";
+}
+
+void SharedMemoryExporter::Cmd::tabCompletion(std::vector<std::string>& tokens) const
+{
+	using namespace std::literals;
+	const auto& exporter = OUTER(SharedMemoryExporter, cmd);
+	if (tokens.size() == 2) {
+		static constexpr std::array cmds = {
+			"add"sv, "remove"sv, "clear"sv, "list"sv, "name"sv,
+			"refresh"sv, "auto_refresh"sv,
+		};
+		completeString(tokens, cmds);
+	} else if (tokens[1] == "add") {
+		if (auto* motherBoard = exporter.reactor.getMotherBoard()) {
+			completeString(tokens, view::keys(motherBoard->getDebugger().getDebuggables()));
+		}
+	} else if (tokens[1] == "remove") {
+		completeString(tokens, view::transform(exporter.entries, &Entry::name));
+	}
+}
+
+} // namespace openmsx
@@ -0,0 +1,89 @@
+#ifndef SHAREDMEMORYEXPORTER_HH
+#define SHAREDMEMORYEXPORTER_HH
+
+#include "Command.hh"
+#include "EventListener.hh"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+class Reactor;
+
+/** Makes the content of selected debuggables of the active machine (e.g.
+  * RAM, VRAM, palette, CPU registers) available to external programs via a
+  * (POSIX) shared memory segment. By default the content is refreshed at
+  * the end of each emulated frame.
+  *
+  * Layout of the segment (all integers are little endian):
+  *    header (64 bytes)
+  *       0: "openMSX\0"
+  *       8: uint32 layout version (currently 1)
+  *      12: uint32 number of debuggables
+  *      16: uint64 sequence number, odd while an update is in progress
+  *      24: uint32 closed, becomes 1 when openMSX stops using this
+  *          segment (e.g. because the list of debuggables changed),
+  *          the reader should then open the segment again
+  *    directory, one 64-byte entry per debuggable
+  *       0: name (zero terminated, possibly truncated)
+  *      56: uint32 offset of the data from the start of the segment
+  *      60: uint32 size of the data
+  *    data
+  *
+  * For a consistent read, a reader should read the sequence number, copy
+  * the data and then read the sequence number again. If both are equal
+  * and even, the data is consistent, otherwise it should retry.
+  */
+class SharedMemoryExporter final : private EventListener
+{
+public:
+	explicit SharedMemoryExporter(Reactor& reactor);
+	SharedMemoryExporter(const SharedMemoryExporter&) = delete;
+	SharedMemoryExporter(SharedMemoryExporter&&) = delete;
+	SharedMemoryExporter& operator=(const SharedMemoryExporter&) = delete;
+	SharedMemoryExporter& operator=(SharedMemoryExporter&&) = delete;
+	~SharedMemoryExporter();
+
+	/** Copy the current content of all exported debuggables. */
+	void refresh();
+
+private:
+	void add(std::span<const TclObject> tokens);
+	void remove(std::span<const TclObject> tokens);
+	void list(TclObject& result) const;
+	void autoRefresh(std::span<const TclObject> tokens, TclObject& result);
+
+	/** (Re)create the segment for the current list of debuggables. */
+	void createSegment();
+	void closeSegment();
+
+	// EventListener
+	int signalEvent(const Event& event) override;
+
+private:
+	Reactor& reactor;
+
+	struct Cmd final : Command {
+		explicit Cmd(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+		void tabCompletion(std::vector<std::string>& tokens) const override;
+	} cmd;
+
+	struct Entry {
+		std::string name;
+		unsigned offset;
+		unsigned size;
+	};
+	std::vector<Entry> entries;
+	std::string segmentName; // empty when there's no segment
+	std::span<uint8_t> segment;
+	bool autoRefreshEnabled = true;
+};
+
+} // namespace openmsx
+
+#endif
@@ -5,17 +5,25 @@
 #include "Interpreter.hh"
 #include "TclObject.hh"
 
+#include "enumerate.hh"
 #include "narrow.hh"
 #include "ranges.hh"
 #include "static_vector.hh"
 #include "stl.hh"
+#include "strCat.hh"
 #include "StringOp.hh"
 #include "unreachable.hh"
 #include "view.hh"
+#include "xrange.hh"
 
 #include <bit>
 #include <cassert>
+#include <cctype>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <utility>
 
 namespace openmsx {
 
@@ -368,34 +376,98 @@ SymbolManager::SymbolManager(CommandController& commandController_)
 	}
 }
 
+template<typename F>
+static void forEachTrigram(std::string_view str, F f)
+{
+	if (str.size() < 3) return;
+	auto lower = [](char c) { return uint32_t(std::tolower(uint8_t(c))); };
+	for (auto i : xrange(str.size() - 2)) {
+		f((lower(str[i + 0]) << 16) | (lower(str[i + 1]) << 8) | lower(str[i + 2]));
+	}
+}
+
+void SymbolManager::buildIndex(SymbolFile& file)
+{
+	auto n = narrow<unsigned>(file.symbols.size());
+	file.byValue = to_vector(xrange(n));
+	ranges::stable_sort(file.byValue, std::less<>{},
+	                    [&](unsigned i) { return file.symbols[i].value; });
+	file.byName = to_vector(xrange(n));
+	ranges::stable_sort(file.byName, StringOp::caseless{},
+	                    [&](unsigned i) { return std::string_view(file.symbols[i].name); });
+	file.trigrams.clear();
+	for (auto i : xrange(n)) {
+		forEachTrigram(file.symbols[i].name, [&](uint32_t trigram) {
+			auto& indices = file.trigrams[trigram];
+			// a name can contain the same trigram more than once
+			if (indices.empty() || indices.back() != i) indices.push_back(i);
+		});
+	}
+}
+
+const Symbol* SymbolManager::findSymbol(const SymbolFile& file, std::string_view name,
+                                        bool caseSensitive, bool last)
+{
+	// 'byName' is sorted with a stable sort, so equal names are in file order
+	auto [b, e] = ranges::equal_range(file.byName, name, StringOp::caseless{},
+		[&](unsigned i) { return std::string_view(file.symbols[i].name); });
+	auto matches = [&](unsigned i) {
+		return !caseSensitive || (file.symbols[i].name == name);
+	};
+	auto range = std::span(b, e);
+	if (last) {
+		for (auto i : view::reverse(range)) {
+			if (matches(i)) return &file.symbols[i];
+		}
+	} else {
+		for (auto i : range) {
+			if (matches(i)) return &file.symbols[i];
+		}
+	}
+	return nullptr;
+}
+
 void SymbolManager::refresh()
 {
 	// Drop caches
 	lookupValueCache.clear();
 
+	if (observer) observer->notifySymbolsChanged();
+}
+
+void SymbolManager::updateTclSymbols(std::span<const Symbol> oldSymbols, std::span<const Symbol> newSymbols)
+{
 	// Allow to access symbol-values in Tcl expression with syntax: $sym(JIFFY)
+	// Only the entries of the changed file need to be updated. When a name
+	// occurs more than once, the last one (in the last file) wins.
 	auto& interp = commandController.getInterpreter();
 	TclObject arrayName("sym");
-	interp.unsetVariable(arrayName.getString().c_str());
-	for (const auto& file : files) {
-		for (const auto& sym : file.symbols) {
-			interp.setVariable(arrayName, TclObject(sym.name), TclObject(sym.value));
+	auto update = [&](const std::string& name) {
+		for (const auto& file : view::reverse(files)) {
+			if (const auto* sym = findSymbol(file, name, true, true)) {
+				interp.setVariable(arrayName, TclObject(name), TclObject(sym->value));
+				return;
+			}
 		}
-	}
-
-	if (observer) observer->notifySymbolsChanged();
+		interp.unsetVariable(strCat("sym(", name, ')').c_str());
+	};
+	for (const auto& sym : oldSymbols) update(sym.name);
+	for (const auto& sym : newSymbols) update(sym.name);
 }
 
 bool SymbolManager::reloadFile(const std::string& filename, LoadEmpty loadEmpty, SymbolFile::Type type)
 {
 	auto file = loadSymbolFile(filename, type); // might throw
 	if (file.symbols.empty() && loadEmpty == LoadEmpty::NOT_ALLOWED) return false;
+	buildIndex(file);
 
 	if (auto it = ranges::find(files, filename, &SymbolFile::filename);
 	    it == files.end()) {
 		files.push_back(std::move(file));
+		updateTclSymbols({}, files.back().symbols);
 	} else {
-		*it = std::move(file);
+		auto oldFile = std::exchange(*it, std::move(file));
+		updateTclSymbols(oldFile.symbols, it->symbols);
 	}
 	refresh();
 	return true;
@@ -405,32 +477,31 @@ void SymbolManager::removeFile(std::string_view filename)
 {
 	auto it = ranges::find(files, filename, &SymbolFile::filename);
 	if (it == files.end()) return; // not found
+	auto oldFile = std::move(*it);
 	files.erase(it);
+	updateTclSymbols(oldFile.symbols, {});
 	refresh();
 }
 
 void SymbolManager::removeAllFiles()
 {
 	files.clear();
+	commandController.getInterpreter().unsetVariable("sym");
 	refresh();
 }
 
 std::optional<uint16_t> SymbolManager::parseSymbolOrValue(std::string_view str) const
 {
-	// linear search is fine: only used interactively
 	// prefer an exact match
 	for (const auto& file : files) {
-		if (auto it = ranges::find(file.symbols, str, &Symbol::name);
-		    it != file.symbols.end()) {
-			return it->value;
+		if (const auto* sym = findSymbol(file, str, true)) {
+			return sym->value;
 		}
 	}
 	// but if not found, a case-insensitive match is fine as well
 	for (const auto& file : files) {
-		if (auto it = ranges::find_if(file.symbols, [&](const auto& sym) {
-			return StringOp::casecmp{}(str, sym.name); });
-		    it != file.symbols.end()) {
-			return it->value;
+		if (const auto* sym = findSymbol(file, str, false)) {
+			return sym->value;
 		}
 	}
 	// also not found, then try to parse as a numerical value
@@ -439,18 +510,96 @@ std::optional<uint16_t> SymbolManager::parseSymbolOrValue(std::string_view str)
 
 std::span<Symbol const * const> SymbolManager::lookupValue(uint16_t value)
 {
-	if (lookupValueCache.empty()) {
+	auto [it, inserted] = lookupValueCache.try_emplace(value, std::vector<const Symbol*>{});
+	if (inserted) {
 		for (const auto& file : files) {
-			for (const auto& sym : file.symbols) {
-				auto [it, inserted] = lookupValueCache.try_emplace(sym.value, std::vector<const Symbol*>{});
-				it->second.push_back(&sym);
+			auto [first, last] = ranges::equal_range(file.byValue, value, std::less<>{},
+				[&](unsigned i) { return file.symbols[i].value; });
+			for (auto i : std::span(first, last)) {
+				it->second.push_back(&file.symbols[i]);
 			}
 		}
 	}
-	if (auto* sym = lookup(lookupValueCache, value)) {
-		return *sym;
+	return it->second;
+}
+
+std::span<Symbol const * const> SymbolManager::lookupNearest(uint16_t address)
+{
+	std::optional<uint16_t> nearest;
+	for (const auto& file : files) {
+		auto it = ranges::upper_bound(file.byValue, address, std::less<>{},
+			[&](unsigned i) { return file.symbols[i].value; });
+		if (it == file.byValue.begin()) continue;
+		auto value = file.symbols[*std::prev(it)].value;
+		if (!nearest || (value > *nearest)) nearest = value;
 	}
-	return {};
+	if (!nearest) return {};
+	return lookupValue(*nearest);
+}
+
+std::vector<SymbolRef> SymbolManager::fuzzySearch(std::string_view pattern) const
+{
+	return fuzzySearch(files, pattern);
+}
+
+std::vector<SymbolRef> SymbolManager::fuzzySearch(std::span<const SymbolFile> files, std::string_view pattern)
+{
+	struct Match {
+		SymbolRef ref;
+		unsigned hits;
+		bool substring;
+		size_t size;
+	};
+	if (pattern.empty()) return {};
+
+	std::vector<Match> matches;
+	auto addMatch = [&](unsigned fileIdx, unsigned symbolIdx, unsigned hits) {
+		const auto& name = files[fileIdx].symbols[symbolIdx].name;
+		matches.push_back(Match{SymbolRef{fileIdx, symbolIdx}, hits,
+		                        StringOp::containsCaseInsensitive(name, pattern), name.size()});
+	};
+
+	if (pattern.size() < 3) {
+		// too short for the trigram index
+		for (auto [fileIdx, file] : enumerate(files)) {
+			for (auto [symbolIdx, sym] : enumerate(file.symbols)) {
+				if (StringOp::containsCaseInsensitive(sym.name, pattern)) {
+					addMatch(narrow<unsigned>(fileIdx), narrow<unsigned>(symbolIdx), 0);
+				}
+			}
+		}
+	} else {
+		std::vector<uint32_t> patternTrigrams;
+		forEachTrigram(pattern, [&](uint32_t trigram) { patternTrigrams.push_back(trigram); });
+		ranges::sort(patternTrigrams);
+		patternTrigrams.erase(ranges::unique(patternTrigrams), patternTrigrams.end());
+		// A single typo changes up to 3 trigrams, allow that many to be
+		// missing, but require at least half of them.
+		auto num = patternTrigrams.size();
+		auto minHits = narrow<unsigned>(std::max<size_t>(1, num - std::min<size_t>(num / 2, 3)));
+
+		hash_map<unsigned, unsigned> hits; // symbol index -> number of trigrams
+		for (auto [fileIdx, file] : enumerate(files)) {
+			hits.clear();
+			for (auto trigram : patternTrigrams) {
+				if (const auto* indices = lookup(file.trigrams, trigram)) {
+					for (auto i : *indices) ++hits[i];
+				}
+			}
+			for (auto [symbolIdx, count] : hits) {
+				if (count >= minHits) {
+					addMatch(narrow<unsigned>(fileIdx), symbolIdx, count);
+				}
+			}
+		}
+	}
+
+	ranges::sort(matches, [](const Match& x, const Match& y) {
+		// substring matches first, then most matching trigrams, then shortest
+		return std::tuple(!x.substring, y.hits, x.size, x.ref.fileIdx, x.ref.symbolIdx)
+		     < std::tuple(!y.substring, x.hits, y.size, y.ref.fileIdx, y.ref.symbolIdx);
+	});
+	return to_vector(view::transform(matches, &Match::ref));
 }
 
 std::string SymbolManager::getFileFilters()
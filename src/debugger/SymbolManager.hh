@@ -48,6 +48,21 @@ struct SymbolFile
 	std::string filename;
 	std::vector<Symbol> symbols;
 	Type type;
+
+	// Indices into 'symbols', see SymbolManager::buildIndex().
+	std::vector<unsigned> byValue; // sorted on value
+	std::vector<unsigned> byName; // sorted on name (case-insensitive)
+	hash_map<uint32_t, std::vector<unsigned>> trigrams; // lower-case trigram -> sorted indices
+};
+
+class SymbolManager;
+struct SymbolRef {
+	unsigned fileIdx;
+	unsigned symbolIdx;
+
+	[[nodiscard]] std::string_view file(const SymbolManager& m) const;
+	[[nodiscard]] std::string_view name(const SymbolManager& m) const;
+	[[nodiscard]] uint16_t        value(const SymbolManager& m) const;
 };
 
 struct SymbolObserver
@@ -79,7 +94,14 @@ public:
 
 	[[nodiscard]] const auto& getFiles() const { return files; }
 	[[nodiscard]] std::span<Symbol const * const> lookupValue(uint16_t value);
+	// The symbol(s) with the largest value that is smaller than or equal to
+	// the given address (e.g. the function that contains this address).
+	[[nodiscard]] std::span<Symbol const * const> lookupNearest(uint16_t address);
 	[[nodiscard]] std::optional<uint16_t> parseSymbolOrValue(std::string_view s) const;
+	// Symbols that approximately contain 'pattern' (case-insensitive), the
+	// best matches first. Tolerates a few typos for patterns of 3 or more
+	// characters (uses the trigram index).
+	[[nodiscard]] std::vector<SymbolRef> fuzzySearch(std::string_view pattern) const;
 
 	[[nodiscard]] static std::string getFileFilters();
 	[[nodiscard]] static SymbolFile::Type getTypeForFilter(std::string_view filter);
@@ -102,17 +124,28 @@ public:
 	[[nodiscard]] static SymbolFile loadASMSX(std::string_view filename, std::string_view buffer);
 	[[nodiscard]] static SymbolFile loadLinkMap(std::string_view filename, std::string_view buffer);
 	[[nodiscard]] static SymbolFile loadSymbolFile(const std::string& filename, SymbolFile::Type type);
+	static void buildIndex(SymbolFile& file);
+	/** When the name occurs more than once in the file, return the first
+	  * occurrence, or the last one when 'last' is set ($sym uses the last
+	  * one, as later symbols overwrite earlier ones there). */
+	[[nodiscard]] static const Symbol* findSymbol(const SymbolFile& file, std::string_view name,
+	                                              bool caseSensitive, bool last = false);
+	[[nodiscard]] static std::vector<SymbolRef> fuzzySearch(std::span<const SymbolFile> files, std::string_view pattern);
 
 private:
 	void refresh();
+	void updateTclSymbols(std::span<const Symbol> oldSymbols, std::span<const Symbol> newSymbols);
 
 private:
 	CommandController& commandController;
 	SymbolObserver* observer = nullptr; // only one for now, could become a vector later
 	std::vector<SymbolFile> files;
-	hash_map<uint16_t, std::vector<const Symbol*>> lookupValueCache; // calculated from 'files'
+	hash_map<uint16_t, std::vector<const Symbol*>> lookupValueCache; // calculated from 'files', filled on demand
 };
 
+inline std::string_view SymbolRef::file(const SymbolManager& m) const { return m.getFiles()[fileIdx].filename; }
+inline std::string_view SymbolRef::name(const SymbolManager& m) const { return m.getFiles()[fileIdx].symbols[symbolIdx].name; }
+inline uint16_t        SymbolRef::value(const SymbolManager& m) const { return m.getFiles()[fileIdx].symbols[symbolIdx].value; }
 
 } // namespace openmsx
 
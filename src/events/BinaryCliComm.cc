@@ -0,0 +1,130 @@
+#include "BinaryCliComm.hh"
+#include "MSXException.hh"
+
+#include "endian.hh"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace openmsx::BinaryCliComm {
+
+Parser::Parser(std::function<void(std::string)> callback_)
+	: callback(std::move(callback_))
+{
+}
+
+void Parser::parse(std::span<const char> buf)
+{
+	while (!buf.empty()) {
+		auto n = std::min(remaining, buf.size());
+		message.append(buf.data(), n);
+		buf = buf.subspan(n);
+		remaining -= n;
+		if (remaining != 0) break;
+
+		if (header) {
+			remaining = Endian::read_UA_L32(message.data());
+			message.clear();
+			if (remaining == 0) {
+				remaining = 4; // ignore empty messages
+			} else {
+				header = false;
+			}
+		} else {
+			callback(std::move(message));
+			message.clear();
+			remaining = 4;
+			header = true;
+		}
+	}
+}
+
+
+std::string_view Reader::take(size_t n)
+{
+	if (message.size() < n) {
+		throw MSXException("Message too short");
+	}
+	auto result = message.substr(0, n);
+	message.remove_prefix(n);
+	return result;
+}
+
+uint8_t Reader::u8()
+{
+	return uint8_t(take(1)[0]);
+}
+
+uint16_t Reader::u16()
+{
+	return Endian::read_UA_L16(take(2).data());
+}
+
+uint32_t Reader::u32()
+{
+	return Endian::read_UA_L32(take(4).data());
+}
+
+std::string_view Reader::str()
+{
+	auto size = u32();
+	return take(size);
+}
+
+std::span<const uint8_t> Reader::rest()
+{
+	auto r = take(message.size());
+	return {std::bit_cast<const uint8_t*>(r.data()), r.size()};
+}
+
+
+Writer::Writer(Type type, uint32_t tag)
+{
+	u32(0); // length, filled in by finish()
+	u8(uint8_t(type));
+	u32(tag);
+}
+
+Writer& Writer::u8(uint8_t value)
+{
+	message += char(value);
+	return *this;
+}
+
+Writer& Writer::u16(uint16_t value)
+{
+	std::array<char, 2> buf;
+	Endian::write_UA_L16(buf.data(), value);
+	message.append(buf.data(), buf.size());
+	return *this;
+}
+
+Writer& Writer::u32(uint32_t value)
+{
+	std::array<char, 4> buf;
+	Endian::write_UA_L32(buf.data(), value);
+	message.append(buf.data(), buf.size());
+	return *this;
+}
+
+Writer& Writer::str(std::string_view s)
+{
+	u32(uint32_t(s.size()));
+	message += s;
+	return *this;
+}
+
+Writer& Writer::bytes(std::span<const uint8_t> data)
+{
+	message.append(std::bit_cast<const char*>(data.data()), data.size());
+	return *this;
+}
+
+std::string Writer::finish()
+{
+	Endian::write_UA_L32(message.data(), uint32_t(message.size() - 4));
+	return std::move(message);
+}
+
+} // namespace openmsx::BinaryCliComm
@@ -0,0 +1,112 @@
+#ifndef BINARYCLICOMM_HH
+#define BINARYCLICOMM_HH
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+
+/** Binary alternative for the XML based CliComm protocol.
+  *
+  * A client selects this protocol by sending MAGIC as the very first bytes
+  * on the connection (a XML stream can never start with a zero byte). Note
+  * that the server may already have sent the "<openmsx-output>" opening
+  * tag before it sees this magic. The server confirms the switch with an
+  * OK message (tag 0) containing PROTOCOL_VERSION.
+  *
+  * After that, both directions only carry messages:
+  *    uint32   length of the rest of the message
+  *    uint8    type
+  *    uint32   tag, chosen by the client, copied in the reply
+  *    ...      payload, depends on the type
+  * All integers are little endian, strings are encoded as a uint32 length
+  * followed by the characters (no zero terminator).
+  *
+  * Each request gets exactly one OK or NOK reply (the latter contains the
+  * error message). LOG and UPDATE messages can be sent at any time, they
+  * have tag 0.
+  */
+namespace openmsx::BinaryCliComm {
+
+inline constexpr std::string_view MAGIC{"\0openMSX-binary\n", 16};
+inline constexpr uint32_t PROTOCOL_VERSION = 1;
+
+enum class Type : uint8_t {
+	// requests                payload                  reply payload
+	COMMAND           = 0x01, // str command            str result
+	READ_BLOCK        = 0x02, // str debuggable, u32 address, u32 size
+	                          //                        data
+	WRITE_BLOCK       = 0x03, // str debuggable, u32 address, data
+	READ_REGISTERS    = 0x04, // -                      28 bytes, layout of the 'CPU regs' debuggable
+	STEP              = 0x05, // -                      -
+	CONTINUE          = 0x06, // -                      -
+	SET_BREAKPOINT    = 0x07, // u16 address            u32 id
+	REMOVE_BREAKPOINT = 0x08, // u32 id                 -
+	SUBSCRIBE         = 0x09, // str update-type, u8 enable
+	                          //                        -
+
+	// replies and notifications
+	OK                = 0x80,
+	NOK               = 0x81, //                        str error message
+	LOG               = 0x82, // str level, str message
+	UPDATE            = 0x83, // str type, str machine, str name, str value
+};
+
+/** Split a byte stream into messages. The callback receives the message
+  * without the length prefix, so starting with the type byte. */
+class Parser
+{
+public:
+	explicit Parser(std::function<void(std::string)> callback);
+	void parse(std::span<const char> buf);
+
+private:
+	std::function<void(std::string)> callback;
+	std::string message; // the length prefix while 'header' is true
+	size_t remaining = 4;
+	bool header = true;
+};
+
+/** Decode the fields of a message.
+  * @throws MSXException when the message is too short. */
+class Reader
+{
+public:
+	explicit Reader(std::string_view message_) : message(message_) {}
+
+	[[nodiscard]] uint8_t u8();
+	[[nodiscard]] uint16_t u16();
+	[[nodiscard]] uint32_t u32();
+	[[nodiscard]] std::string_view str();
+	/** All remaining bytes. */
+	[[nodiscard]] std::span<const uint8_t> rest();
+
+private:
+	[[nodiscard]] std::string_view take(size_t n);
+
+private:
+	std::string_view message;
+};
+
+/** Build a message, including the length prefix. */
+class Writer
+{
+public:
+	Writer(Type type, uint32_t tag);
+
+	Writer& u8(uint8_t value);
+	Writer& u16(uint16_t value);
+	Writer& u32(uint32_t value);
+	Writer& str(std::string_view s);
+	Writer& bytes(std::span<const uint8_t> data);
+
+	[[nodiscard]] std::string finish();
+
+private:
+	std::string message;
+};
+
+} // namespace openmsx::BinaryCliComm
+
+#endif
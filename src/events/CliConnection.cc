@@ -8,8 +8,14 @@
 #include "CliConnection.hh"
 #include "EventDistributor.hh"
 #include "Event.hh"
-#include "CommandController.hh"
+#include "BreakPoint.hh"
 #include "CommandException.hh"
+#include "Debuggable.hh"
+#include "Debugger.hh"
+#include "GlobalCommandController.hh"
+#include "MSXCPUInterface.hh"
+#include "MSXMotherBoard.hh"
+#include "Reactor.hh"
 #include "TclObject.hh"
 #include "TemporaryString.hh"
 #include "XMLEscape.hh"
@@ -19,6 +25,7 @@
 #include <array>
 #include <cassert>
 #include <iostream>
+#include <utility>
 
 #ifdef _WIN32
 #include "SocketStreamWrapper.hh"
@@ -29,11 +36,12 @@ namespace openmsx {
 
 // class CliConnection
 
-CliConnection::CliConnection(CommandController& commandController_,
+CliConnection::CliConnection(GlobalCommandController& commandController_,
                              EventDistributor& eventDistributor_)
-	: parser([this](const std::string& cmd) { execute(cmd); })
-	, commandController(commandController_)
+	: commandController(commandController_)
 	, eventDistributor(eventDistributor_)
+	, parser([this](const std::string& cmd) { execute(cmd); })
+	, binaryParser([this](std::string message) { executeBinary(std::move(message)); })
 {
 	ranges::fill(updateEnabled, false);
 
@@ -52,6 +60,11 @@ void CliConnection::log(CliComm::LogLevel level, std::string_view message, float
 	if (level == CliComm::PROGRESS && fraction >= 0.0f) {
 		strAppend(fullMessage, "... ", int(100.0f * fraction), '%');
 	}
+	if (protocol == Protocol::BINARY) {
+		output(BinaryCliComm::Writer(BinaryCliComm::Type::LOG, 0)
+			.str(levelStr[level]).str(fullMessage).finish());
+		return;
+	}
 	output(tmpStrCat("<log level=\"", levelStr[level], "\">",
 	                 XMLEscape(fullMessage), "</log>\n"));
 }
@@ -62,6 +75,11 @@ void CliConnection::update(CliComm::UpdateType type, std::string_view machine,
 	if (!getUpdateEnable(type)) return;
 
 	auto updateStr = CliComm::getUpdateStrings();
+	if (protocol == Protocol::BINARY) {
+		output(BinaryCliComm::Writer(BinaryCliComm::Type::UPDATE, 0)
+			.str(updateStr[type]).str(machine).str(name).str(value).finish());
+		return;
+	}
 	auto tmp = strCat("<update type=\"", updateStr[type], '\"');
 	if (!machine.empty()) {
 		strAppend(tmp, " machine=\"", machine, '\"');
@@ -86,7 +104,9 @@ void CliConnection::start()
 
 void CliConnection::end()
 {
-	output("</openmsx-output>\n");
+	if (protocol != Protocol::BINARY) {
+		output("</openmsx-output>\n");
+	}
 	close();
 
 	poller.abort();
@@ -96,11 +116,45 @@ void CliConnection::end()
 	}
 }
 
+void CliConnection::received(std::span<const char> buf)
+{
+	// runs in helper thread
+	while (protocol == Protocol::UNKNOWN) {
+		if (buf.empty()) return;
+		magic += buf.front();
+		buf = buf.subspan(1);
+		if (!BinaryCliComm::MAGIC.starts_with(magic)) {
+			protocol = Protocol::XML;
+			parser.parse(magic);
+		} else if (magic.size() == BinaryCliComm::MAGIC.size()) {
+			protocol = Protocol::BINARY;
+			output(BinaryCliComm::Writer(BinaryCliComm::Type::OK, 0)
+				.u32(BinaryCliComm::PROTOCOL_VERSION).finish());
+		}
+	}
+	if (protocol == Protocol::XML) {
+		parser.parse(buf);
+	} else {
+		binaryParser.parse(buf);
+	}
+}
+
 void CliConnection::execute(const std::string& command)
 {
 	eventDistributor.distributeEvent(CliCommandEvent(command, this));
 }
 
+void CliConnection::executeBinary(std::string message)
+{
+	{
+		std::scoped_lock lock(binaryMutex);
+		binaryRequests.push_back(std::move(message));
+	}
+	// The command string is not used, the event only wakes up the main
+	// thread, which then handles all queued binary requests.
+	eventDistributor.distributeEvent(CliCommandEvent({}, this));
+}
+
 static TemporaryString reply(std::string_view message, bool status)
 {
 	return tmpStrCat("<reply result=\"", (status ? "ok" : "nok"), "\">",
@@ -111,7 +165,18 @@ int CliConnection::signalEvent(const Event& event)
 {
 	assert(getType(event) == EventType::CLICOMMAND);
 	if (const auto& commandEvent = get_event<CliCommandEvent>(event);
-	    commandEvent.getId() == this) {
+	    commandEvent.getId() != this) {
+		// not for us
+	} else if (protocol == Protocol::BINARY) {
+		std::vector<std::string> requests;
+		{
+			std::scoped_lock lock(binaryMutex);
+			std::swap(requests, binaryRequests);
+		}
+		for (const auto& request : requests) {
+			output(handleBinary(request));
+		}
+	} else {
 		try {
 			auto result = commandController.executeCommand(
 				commandEvent.getCommand(), this).getString();
@@ -124,11 +189,108 @@ int CliConnection::signalEvent(const Event& event)
 	return 0;
 }
 
+std::string CliConnection::handleBinary(std::string_view message)
+{
+	using namespace BinaryCliComm;
+	Reader reader(message);
+	uint32_t tag = 0;
+	try {
+		auto type = Type(reader.u8());
+		tag = reader.u32();
+
+		auto getMotherBoard = [&]() -> MSXMotherBoard& {
+			auto* motherBoard = commandController.getReactor().getMotherBoard();
+			if (!motherBoard) throw CommandException("No machine");
+			return *motherBoard;
+		};
+		auto getDebuggable = [&](std::string_view name) -> Debuggable& {
+			auto* debuggable = getMotherBoard().getDebugger().findDebuggable(name);
+			if (!debuggable) throw CommandException("No such debuggable: ", name);
+			return *debuggable;
+		};
+		auto checkRange = [](const Debuggable& debuggable, uint32_t address, size_t size) {
+			auto devSize = debuggable.getSize();
+			if ((address > devSize) || (size > (devSize - address))) {
+				throw CommandException("Invalid address or size");
+			}
+		};
+
+		Writer reply(Type::OK, tag);
+		switch (type) {
+		case Type::COMMAND: {
+			std::string command{reader.str()};
+			reply.str(commandController.executeCommand(command, this).getString());
+			break;
+		}
+		case Type::READ_BLOCK: {
+			auto& debuggable = getDebuggable(reader.str());
+			auto address = reader.u32();
+			auto size = reader.u32();
+			checkRange(debuggable, address, size);
+			std::vector<byte> buf(size);
+			debuggable.readBlock(address, buf);
+			reply.bytes(buf);
+			break;
+		}
+		case Type::WRITE_BLOCK: {
+			// Writes must be recorded for replay, so go via the
+			// 'debug write_block' command. The arguments are passed as
+			// Tcl objects, so without conversion to/from text.
+			auto name = reader.str();
+			auto address = reader.u32();
+			auto data = reader.rest();
+			makeTclList("debug", "write_block", name, address, data)
+				.executeCommand(commandController.getInterpreter());
+			break;
+		}
+		case Type::READ_REGISTERS: {
+			auto& debuggable = getDebuggable("CPU regs");
+			std::array<byte, 28> buf;
+			debuggable.readBlock(0, buf);
+			reply.bytes(buf);
+			break;
+		}
+		case Type::STEP:
+			getMotherBoard().getCPUInterface().doStep();
+			break;
+		case Type::CONTINUE:
+			getMotherBoard().getCPUInterface().doContinue();
+			break;
+		case Type::SET_BREAKPOINT: {
+			auto address = reader.u16();
+			BreakPoint bp(address, TclObject("debug break"), TclObject(), false);
+			reply.u32(bp.getId());
+			getMotherBoard().getCPUInterface().insertBreakPoint(std::move(bp));
+			break;
+		}
+		case Type::REMOVE_BREAKPOINT:
+			getMotherBoard().getCPUInterface().removeBreakPoint(reader.u32());
+			break;
+		case Type::SUBSCRIBE: {
+			auto name = reader.str();
+			bool enable = reader.u8() != 0;
+			auto updateStr = CliComm::getUpdateStrings();
+			auto it = ranges::find(updateStr, name);
+			if (it == updateStr.end()) {
+				throw CommandException("No such update type: ", name);
+			}
+			setUpdateEnable(CliComm::UpdateType(it - updateStr.begin()), enable);
+			break;
+		}
+		default:
+			throw CommandException("Unknown request type: ", int(type));
+		}
+		return reply.finish();
+	} catch (MSXException& e) {
+		return Writer(Type::NOK, tag).str(e.getMessage()).finish();
+	}
+}
+
 
 // class StdioConnection
 
 static constexpr int BUF_SIZE = 4096;
-StdioConnection::StdioConnection(CommandController& commandController_,
+StdioConnection::StdioConnection(GlobalCommandController& commandController_,
                                  EventDistributor& eventDistributor_)
 	: CliConnection(commandController_, eventDistributor_)
 {
@@ -152,7 +314,7 @@ void StdioConnection::run()
 		std::array<char, BUF_SIZE> buf;
 		auto n = read(STDIN_FILENO, buf.data(), sizeof(buf));
 		if (n > 0) {
-			parser.parse(subspan(buf, 0, n));
+			received(subspan(buf, 0, n));
 		} else if (n < 0) {
 			break;
 		}
@@ -177,7 +339,7 @@ void StdioConnection::close()
 // but that gives a old-style-cast warning
 static const HANDLE OPENMSX_INVALID_HANDLE_VALUE = reinterpret_cast<HANDLE>(-1);
 
-PipeConnection::PipeConnection(CommandController& commandController_,
+PipeConnection::PipeConnection(GlobalCommandController& commandController_,
                                EventDistributor& eventDistributor_,
                                std::string_view name)
 	: CliConnection(commandController_, eventDistributor_)
@@ -242,7 +404,7 @@ void PipeConnection::run()
 			if (!GetOverlappedResult(pipeHandle, &overlapped, &bytesRead, TRUE)) {
 				break; // Pipe broke
 			}
-			parser.parse(std::span{buf, bytesRead});
+			received(std::span{buf, bytesRead});
 		} else if (wait == WAIT_OBJECT_0) {
 			break; // Shutdown
 		} else {
@@ -274,7 +436,7 @@ void PipeConnection::close()
 
 // class SocketConnection
 
-SocketConnection::SocketConnection(CommandController& commandController_,
+SocketConnection::SocketConnection(GlobalCommandController& commandController_,
                                    EventDistributor& eventDistributor_,
                                    SOCKET sd_)
 	: CliConnection(commandController_, eventDistributor_)
@@ -321,7 +483,7 @@ void SocketConnection::run()
 		std::array<char, BUF_SIZE> buf;
 		auto n = sock_recv(sd, buf.data(), sizeof(buf));
 		if (n > 0) {
-			parser.parse(subspan(buf, 0, n));
+			received(subspan(buf, 0, n));
 		} else if (n < 0) {
 			break;
 		}
@@ -6,16 +6,21 @@
 #include "Socket.hh"
 #include "CliComm.hh"
 #include "AdhocCliCommParser.hh"
+#include "BinaryCliComm.hh"
 #include "Poller.hh"
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include <mutex>
+#include <span>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace openmsx {
 
-class CommandController;
 class EventDistributor;
+class GlobalCommandController;
 
 class CliConnection : public CliListener, private EventListener
 {
@@ -35,7 +40,7 @@ public:
 	void start();
 
 protected:
-	CliConnection(CommandController& commandController,
+	CliConnection(GlobalCommandController& commandController,
 	              EventDistributor& eventDistributor);
 	~CliConnection() override;
 
@@ -59,13 +64,21 @@ protected:
 	  */
 	void startOutput();
 
-	AdhocCliCommParser parser;
+	/** Handle data received from the client. Depending on the first
+	  * bytes, this is either parsed as XML or as binary messages (see
+	  * BinaryCliComm.hh).
+	  * Called from the helper thread.
+	  */
+	void received(std::span<const char> buf);
+
 	Poller poller;
 
 private:
 	virtual void run() = 0;
 
 	void execute(const std::string& command);
+	void executeBinary(std::string message);
+	[[nodiscard]] std::string handleBinary(std::string_view message);
 
 	// CliListener
 	void log(CliComm::LogLevel level, std::string_view message, float fraction) noexcept override;
@@ -75,9 +88,19 @@ private:
 	// EventListener
 	int signalEvent(const Event& event) override;
 
-	CommandController& commandController;
+	GlobalCommandController& commandController;
 	EventDistributor& eventDistributor;
 
+	AdhocCliCommParser parser;
+	BinaryCliComm::Parser binaryParser;
+
+	enum class Protocol : uint8_t { UNKNOWN, XML, BINARY };
+	std::atomic<Protocol> protocol = Protocol::UNKNOWN;
+	std::string magic; // received bytes while the protocol is still unknown
+
+	std::mutex binaryMutex;
+	std::vector<std::string> binaryRequests; // protected by binaryMutex
+
 	std::thread thread;
 
 	std::array<bool, CliComm::NUM_UPDATES> updateEnabled;
@@ -86,7 +109,7 @@ private:
 class StdioConnection final : public CliConnection
 {
 public:
-	StdioConnection(CommandController& commandController,
+	StdioConnection(GlobalCommandController& commandController,
 	                EventDistributor& eventDistributor);
 	~StdioConnection() override;
 
@@ -101,7 +124,7 @@ private:
 class PipeConnection final : public CliConnection
 {
 public:
-	PipeConnection(CommandController& commandController,
+	PipeConnection(GlobalCommandController& commandController,
 	               EventDistributor& eventDistributor,
 	               std::string_view name);
 	~PipeConnection() override;
@@ -120,7 +143,7 @@ private:
 class SocketConnection final : public CliConnection
 {
 public:
-	SocketConnection(CommandController& commandController,
+	SocketConnection(GlobalCommandController& commandController,
 	                 EventDistributor& eventDistributor,
 	                 SOCKET sd);
 	~SocketConnection() override;
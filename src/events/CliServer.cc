@@ -196,7 +196,7 @@ static void deleteSocket(const std::string& socket)
 }
 
 
-CliServer::CliServer(CommandController& commandController_,
+CliServer::CliServer(GlobalCommandController& commandController_,
                      EventDistributor& eventDistributor_,
                      GlobalCliComm& cliComm_)
 	: commandController(commandController_)
@@ -8,14 +8,14 @@
 
 namespace openmsx {
 
-class CommandController;
+class GlobalCommandController;
 class EventDistributor;
 class GlobalCliComm;
 
 class CliServer final
 {
 public:
-	CliServer(CommandController& commandController,
+	CliServer(GlobalCommandController& commandController,
 	          EventDistributor& eventDistributor,
 	          GlobalCliComm& cliComm);
 	~CliServer();
@@ -26,7 +26,7 @@ private:
 	void exitAcceptLoop();
 
 private:
-	CommandController& commandController;
+	GlobalCommandController& commandController;
 	EventDistributor& eventDistributor;
 	GlobalCliComm& cliComm;
 
@@ -72,6 +72,8 @@ void DMKDiskImage::seekTrack(uint8_t track, uint8_t side)
 void DMKDiskImage::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 {
 	assert(side < 2);
+	if (trackCache.get(track, side, output)) return;
+
 	output.clear(dmkTrackLen);
 	if ((singleSided && side) || (track >= numTracks)) {
 		// no such side/track, only clear output
@@ -118,6 +120,7 @@ void DMKDiskImage::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 		output.addIdam(idx);
 		lastIdam = narrow<int>(idx);
 	}
+	trackCache.put(track, side, output);
 }
 
 void DMKDiskImage::writeTrackImpl(uint8_t track, uint8_t side, const RawTrack& input)
@@ -219,6 +222,12 @@ Sha1Sum DMKDiskImage::getSha1SumImpl(FilePool& filePool)
 	return filePool.getSha1Sum(*file);
 }
 
+void DMKDiskImage::flushCaches()
+{
+	Disk::flushCaches();
+	trackCache.clear();
+}
+
 void DMKDiskImage::detectGeometryFallback()
 {
 	// The implementation in Disk::detectGeometryFallback() uses
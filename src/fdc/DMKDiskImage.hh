@@ -2,6 +2,7 @@
 #define DMKDISKIMAGE_HH
 
 #include "Disk.hh"
+#include "TrackCache.hh"
 #include <memory>
 
 namespace openmsx {
@@ -30,6 +31,7 @@ public:
 
 private:
 	void detectGeometryFallback() override;
+	void flushCaches() override;
 
 	void seekTrack(uint8_t track, uint8_t side);
 	void doWriteTrack(uint8_t track, uint8_t side, const RawTrack& input);
@@ -37,6 +39,7 @@ private:
 
 private:
 	std::shared_ptr<File> file;
+	TrackCache trackCache;
 	unsigned dmkTrackLen;
 	uint8_t numTracks;
 	bool singleSided;
@@ -19,27 +19,38 @@ DSKDiskImage::DSKDiskImage(const Filename& fileName,
 	setNbSectors(file->getSize() / sizeof(SectorBuffer));
 }
 
+void DSKDiskImage::setOverlay(SectorOverlay newOverlay)
+{
+	overlay = std::move(newOverlay);
+	flushCaches();
+}
+
 void DSKDiskImage::readSectorsImpl(
 	std::span<SectorBuffer> buffers, size_t startSector)
 {
 	file->seek(startSector * sizeof(SectorBuffer));
 	file->read(buffers);
+	if (overlay) overlay->read(buffers, startSector);
 }
 
 void DSKDiskImage::writeSectorImpl(size_t sector, const SectorBuffer& buf)
 {
+	if (overlay) {
+		overlay->write(sector, buf);
+		return;
+	}
 	file->seek(sector * sizeof(buf));
 	file->write(buf.raw);
 }
 
 bool DSKDiskImage::isWriteProtectedImpl() const
 {
-	return file->isReadOnly();
+	return !overlay && file->isReadOnly();
 }
 
 Sha1Sum DSKDiskImage::getSha1SumImpl(FilePool& filePool)
 {
-	if (hasPatches()) {
+	if (hasPatches() || (overlay && !overlay->empty())) {
 		return SectorAccessibleDisk::getSha1SumImpl(filePool);
 	}
 	return filePool.getSha1Sum(*file);
@@ -2,7 +2,9 @@
 #define DSKDISKIMAGE_HH
 
 #include "SectorBasedDisk.hh"
+#include "SectorOverlay.hh"
 #include <memory>
+#include <optional>
 
 namespace openmsx {
 
@@ -14,6 +16,11 @@ public:
 	explicit DSKDiskImage(const Filename& filename);
 	DSKDiskImage(const Filename& filename, std::shared_ptr<File> file);
 
+	/** From now on, don't write to the image file anymore, but to the
+	  * given overlay. */
+	void setOverlay(SectorOverlay newOverlay);
+	[[nodiscard]] SectorOverlay* getOverlay() { return overlay ? &*overlay : nullptr; }
+
 private:
 	void readSectorsImpl(
 		std::span<SectorBuffer> buffers, size_t startSector) override;
@@ -23,6 +30,7 @@ private:
 
 private:
 	const std::shared_ptr<File> file;
+	std::optional<SectorOverlay> overlay;
 };
 
 } // namespace openmsx
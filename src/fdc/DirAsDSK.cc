@@ -328,6 +328,13 @@ DirAsDSK::DirAsDSK(DiskChanger& diskChanger_, CliComm& cliComm_,
 	// No host files are mapped to this disk yet.
 	assert(mapDirs.empty());
 
+	// Start watching before the initial import, so that no changes get
+	// lost.
+	watcher = std::make_unique<DirectoryWatcher>();
+	if (!watcher->isSupported() || !watcher->add(hostDir, true)) {
+		watcher.reset();
+	}
+
 	// Import the host filesystem.
 	syncWithHost();
 }
@@ -361,7 +368,7 @@ void DirAsDSK::checkCaches()
 			return true;
 		}
 	}();
-	if (needSync) {
+	if (needSync && hostMayHaveChanged()) {
 		flushCaches();
 	}
 }
@@ -386,8 +393,10 @@ void DirAsDSK::readSectorImpl(size_t sector, SectorBuffer& buf)
 				return true;
 			}
 		}();
-		if (needSync) {
-			syncWithHost();
+		if (needSync && hostMayHaveChanged()) {
+			if (!syncHostChanges()) {
+				syncWithHost();
+			}
 			flushCaches(); // e.g. sha1sum
 			// Let the disk drive report the disk has been ejected.
 			// E.g. a turbor machine uses this to flush its
@@ -417,6 +426,55 @@ void DirAsDSK::syncWithHost()
 	addNewHostFiles({}, firstDirSector);
 }
 
+bool DirAsDSK::hostMayHaveChanged()
+{
+	if (!watcher) return true;
+	append(hostChanges, watcher->poll());
+	return !hostChanges.empty();
+}
+
+// Handle the changes reported by the DirectoryWatcher. Only modifications of
+// already mapped files (the typical case while editing files on the host) are
+// handled here, this only needs to stat() those files. Anything else (new or
+// removed files, lost events, ...) returns false, and then a full sync is
+// needed.
+bool DirAsDSK::syncHostChanges()
+{
+	if (!watcher) return false;
+	auto changes = std::exchange(hostChanges, {});
+
+	std::vector<DirIndex> modified;
+	for (const auto& change : changes) {
+		if ((change.type == DirectoryWatcher::Event::Type::LOST_EVENTS) ||
+		    !change.path.starts_with(hostDir)) {
+			return false;
+		}
+		auto dirIndex = findHostFileInDSK(std::string_view(change.path).substr(hostDir.size()));
+		if (dirIndex.sector == unsigned(-1)) {
+			if (change.type == DirectoryWatcher::Event::Type::REMOVED) {
+				continue; // never was on the virtual disk
+			}
+			return false; // new host file
+		}
+		if ((change.type == DirectoryWatcher::Event::Type::REMOVED) ||
+		    (msxDir(dirIndex).attrib & MSXDirEntry::Attrib::DIRECTORY)) {
+			return false;
+		}
+		if (!contains(modified, dirIndex)) modified.push_back(dirIndex);
+	}
+
+	for (auto dirIndex : modified) {
+		const auto& mapDir = mapDirs[dirIndex];
+		auto fst = FileOperations::getStat(tmpStrCat(hostDir, mapDir.hostName));
+		if (!fst || FileOperations::isDirectory(*fst)) return false;
+		if ((mapDir.mtime    != fst->st_mtime) ||
+		    (mapDir.filesize != size_t(fst->st_size))) {
+			importHostFile(dirIndex, *fst);
+		}
+	}
+	return true;
+}
+
 void DirAsDSK::checkDeletedHostFiles()
 {
 	// This handles both host files and directories.
@@ -1,6 +1,7 @@
 #ifndef DIRASDSK_HH
 #define DIRASDSK_HH
 
+#include "DirectoryWatcher.hh"
 #include "DiskImageUtils.hh"
 #include "EmuTime.hh"
 #include "FileOperations.hh"
@@ -8,7 +9,9 @@
 
 #include "hash_map.hh"
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 namespace openmsx {
 
@@ -71,6 +74,8 @@ private:
 	void writeDIREntry(DirIndex dirIndex, DirIndex dirDirIndex,
 	                   const MSXDirEntry& newEntry);
 	void syncWithHost();
+	[[nodiscard]] bool hostMayHaveChanged();
+	[[nodiscard]] bool syncHostChanges();
 	void checkDeletedHostFiles();
 	void deleteMSXFile(DirIndex dirIndex);
 	void deleteMSXFilesInDir(unsigned msxDirSector);
@@ -130,6 +135,10 @@ private:
 
 	EmuTime lastAccess; // last time there was a sector read/write
 
+	// When available, only sync with the host when it reported changes.
+	std::unique_ptr<DirectoryWatcher> watcher; // nullptr if not supported
+	std::vector<DirectoryWatcher::Event> hostChanges; // not yet handled
+
 	// For each directory entry that has a mapped host file/directory we
 	// store the name, last modification time and size of the corresponding
 	// host file/dir.
@@ -3,8 +3,10 @@
 #include "DirAsDSK.hh"
 #include "DiskFactory.hh"
 #include "DiskManipulator.hh"
+#include "DSKDiskImage.hh"
 #include "DummyDisk.hh"
 #include "RamDSKDiskImage.hh"
+#include "SectorOverlay.hh"
 
 #include "CliComm.hh"
 #include "CommandController.hh"
@@ -30,6 +32,7 @@
 #include <array>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <utility>
 
 namespace openmsx {
@@ -158,15 +161,32 @@ int DiskChanger::insertDisk(const std::string& filename)
 	}
 }
 
+static void setOverlay(Disk& disk, SectorOverlay overlay)
+{
+	auto* dsk = dynamic_cast<DSKDiskImage*>(&disk);
+	if (!dsk) {
+		throw MSXException("An overlay is only supported for DSK disk images");
+	}
+	dsk->setOverlay(std::move(overlay));
+}
+
 void DiskChanger::insertDisk(std::span<const TclObject> args)
 {
 	std::string diskImage = FileOperations::getConventionalPath(std::string(args[1].getString()));
 	auto& diskFactory = reactor.getDiskFactory();
 	std::unique_ptr<Disk> newDisk(diskFactory.createDisk(diskImage, *this));
-	for (const auto& arg : view::drop(args, 2)) {
-		newDisk->applyPatch(Filename(
-			arg.getString(), userFileContext()));
+	std::optional<SectorOverlay> overlay;
+	for (size_t i = 2; i < args.size(); ++i) { // 'i' changes in loop
+		std::string_view arg = args[i].getString();
+		if (arg == "-overlay") {
+			overlay.emplace();
+		} else if ((arg == "-delta") && (++i < args.size())) {
+			overlay.emplace(FileOperations::expandTilde(std::string(args[i].getString())));
+		} else {
+			newDisk->applyPatch(Filename(arg, userFileContext()));
+		}
 	}
+	if (overlay) setOverlay(*newDisk, std::move(*overlay));
 
 	// no errors, only now replace original disk
 	changeDisk(std::move(newDisk));
@@ -213,6 +233,10 @@ void DiskCommand::execute(std::span<const TclObject> tokens, TclObject& result)
 		if (diskChanger.disk->isWriteProtected()) {
 			options.addListElement("readonly");
 		}
+		if (auto* dsk = dynamic_cast<DSKDiskImage*>(diskChanger.disk.get());
+		    dsk && dsk->getOverlay()) {
+			options.addListElement("overlay");
+		}
 		if (options.getListLength(getInterpreter()) != 0) {
 			result.addListElement(options);
 		}
@@ -250,6 +274,13 @@ void DiskCommand::execute(std::span<const TclObject> tokens, TclObject& result)
 							"Missing argument for option \"", option, '\"');
 					}
 					args.emplace_back(tokens[i]);
+				} else if (option == "-delta") {
+					if (++i == tokens.size()) {
+						throw MSXException(
+							"Missing argument for option \"", option, '\"');
+					}
+					args.emplace_back(option);
+					args.emplace_back(tokens[i]);
 				} else {
 					// backwards compatibility
 					args.emplace_back(option);
@@ -272,7 +303,9 @@ std::string DiskCommand::help(std::span<const TclObject> /*tokens*/) const
 		driveName, " <filename>        : change the disk file\n",
 		driveName, "                   : show which disk image is in drive\n"
 		"The following options are supported when inserting a disk image:\n"
-		"-ips <filename> : apply the given IPS patch to the disk image");
+		"-ips <filename>   : apply the given IPS patch to the disk image\n"
+		"-overlay          : don't modify the image, keep the changes in memory\n"
+		"-delta <filename> : don't modify the image, keep the changes in the given file");
 }
 
 void DiskCommand::tabCompletion(std::vector<std::string>& tokens) const
@@ -298,6 +331,7 @@ static std::string calcSha1(SectorAccessibleDisk* disk, FilePool& filePool)
 
 // version 1:  initial version
 // version 2:  replaced Filename with DiskName
+// version 3:  added copy-on-write overlay
 template<typename Archive>
 void DiskChanger::serialize(Archive& ar, unsigned version)
 {
@@ -321,6 +355,22 @@ void DiskChanger::serialize(Archive& ar, unsigned version)
 	}
 	ar.serialize("patches", patches);
 
+	// Restored only after the disk is reinserted (below).
+	std::optional<SectorOverlay> overlay;
+	if (ar.versionAtLeast(version, 3)) {
+		auto* dsk = dynamic_cast<DSKDiskImage*>(disk.get());
+		bool withOverlay = dsk && dsk->getOverlay();
+		ar.serialize("overlay", withOverlay);
+		if (withOverlay) {
+			if constexpr (Archive::IS_LOADER) {
+				overlay.emplace();
+				ar.serialize("overlayData", *overlay);
+			} else {
+				ar.serialize("overlayData", *dsk->getOverlay());
+			}
+		}
+	}
+
 	auto& filePool = reactor.getFilePool();
 	std::string oldChecksum;
 	if constexpr (!Archive::IS_LOADER) {
@@ -355,6 +405,7 @@ void DiskChanger::serialize(Archive& ar, unsigned version)
 
 			try {
 				insertDisk(args);
+				if (overlay) setOverlay(*disk, std::move(*overlay));
 			} catch (MSXException& e) {
 				throw MSXException(
 					"Couldn't reinsert disk in drive ",
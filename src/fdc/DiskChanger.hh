@@ -101,7 +101,7 @@ private:
 
 	bool diskChangedFlag;
 };
-SERIALIZE_CLASS_VERSION(DiskChanger, 2);
+SERIALIZE_CLASS_VERSION(DiskChanger, 3);
 
 } // namespace openmsx
 
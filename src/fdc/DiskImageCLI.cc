@@ -57,9 +57,20 @@ void DiskImageCLI::parse(zstring_view drive, std::string_view image,
 		throw MSXException("No disk drive ", char(::toupper(drive.back())), " present to put image '", image, "' in.");
 	}
 	TclObject command = makeTclList(drive, image);
-	while (peekArgument(cmdLine) == "-ips") {
-		cmdLine = cmdLine.subspan(1);
-		command.addListElement(getArgument("-ips", cmdLine));
+	while (true) {
+		auto option = peekArgument(cmdLine);
+		if (option == "-ips") {
+			cmdLine = cmdLine.subspan(1);
+			command.addListElement(getArgument(option, cmdLine));
+		} else if (option == "-overlay") {
+			cmdLine = cmdLine.subspan(1);
+			command.addListElement(option);
+		} else if (option == "-delta") {
+			cmdLine = cmdLine.subspan(1);
+			command.addListElement(option, getArgument(option, cmdLine));
+		} else {
+			break;
+		}
 	}
 	command.executeCommand(parser.getInterpreter());
 }
@@ -31,21 +31,15 @@ void SectorBasedDisk::writeTrackImpl(uint8_t track, uint8_t side, const RawTrack
 
 void SectorBasedDisk::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 {
-	// Try to cache the last result of this method (the cache will be
-	// flushed on any write to the disk). This very simple cache mechanism
-	// will typically already have a very high hit-rate. For example during
-	// emulation of a WD2793 read sector, we also emulate the search for
-	// the correct sector. So the disk rotates from sector to sector, and
-	// each time we re-read the track data (because EmuTime has passed).
-	// Typically the software will also read several sectors from the same
-	// track before moving to the next.
+	// Cache the result of this method (the cache will be flushed on any
+	// write to the disk). During emulation of a WD2793 read sector, we
+	// also emulate the search for the correct sector. So the disk rotates
+	// from sector to sector, and each time we re-read the track data
+	// (because EmuTime has passed). Typically the software will also read
+	// several sectors from the same track before moving to the next, and
+	// often it alternates between both sides or a few nearby tracks.
 	checkCaches();
-	int num = track | (side << 8);
-	if (num == cachedTrackNum) {
-		output = cachedTrackData;
-		return;
-	}
-	cachedTrackNum = num;
+	if (trackCache.get(track, side, output)) return;
 
 	// This disk image only stores the actual sector data, not all the
 	// extra gap, sync and header information that is in reality stored
@@ -132,15 +126,15 @@ void SectorBasedDisk::readTrack(uint8_t track, uint8_t side, RawTrack& output)
 		// real disk, you simply read an 'empty' track. So we do the
 		// same here.
 		output.clear(RawTrack::STANDARD_SIZE);
-		cachedTrackNum = -1; // needed?
+		return; // don't cache
 	}
-	cachedTrackData = output;
+	trackCache.put(track, side, output);
 }
 
 void SectorBasedDisk::flushCaches()
 {
 	Disk::flushCaches();
-	cachedTrackNum = -1;
+	trackCache.clear();
 }
 
 size_t SectorBasedDisk::getNbSectorsImpl() const
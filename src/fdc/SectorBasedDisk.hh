@@ -3,6 +3,7 @@
 
 #include "Disk.hh"
 #include "RawTrack.hh"
+#include "TrackCache.hh"
 
 namespace openmsx {
 
@@ -30,8 +31,7 @@ private:
 
 private:
 	size_t nbSectors = size_t(-1); // to detect misuse
-	RawTrack cachedTrackData;
-	int cachedTrackNum = -1;
+	TrackCache trackCache;
 };
 
 } // namespace openmsx
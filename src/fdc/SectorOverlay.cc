@@ -0,0 +1,133 @@
+#include "SectorOverlay.hh"
+#include "FileException.hh"
+#include "serialize.hh"
+#include "serialize_stl.hh"
+
+#include "endian.hh"
+#include "enumerate.hh"
+#include "ranges.hh"
+#include "xrange.hh"
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <utility>
+
+namespace openmsx {
+
+static constexpr std::string_view DELTA_HEADER = "openMSX overlay\n";
+static constexpr size_t HEADER_SIZE = 16;
+static constexpr size_t RECORD_SIZE = 8 + sizeof(SectorBuffer);
+static_assert(DELTA_HEADER.size() == HEADER_SIZE);
+
+SectorOverlay::SectorOverlay(std::string deltaFile_)
+	: deltaFileName(std::move(deltaFile_))
+{
+	openDeltaFile(false);
+}
+
+void SectorOverlay::openDeltaFile(bool truncate)
+{
+	deltaFile = File(deltaFileName, truncate ? File::TRUNCATE : File::CREATE);
+	auto size = deltaFile.getSize();
+	if (size == 0) {
+		deltaFile.write(std::span{DELTA_HEADER});
+		return;
+	}
+
+	std::array<uint8_t, HEADER_SIZE> header;
+	if (size >= HEADER_SIZE) deltaFile.read(header);
+	if ((size < HEADER_SIZE) || !ranges::equal(header, DELTA_HEADER)) {
+		throw FileException("Not a delta file: ", deltaFileName);
+	}
+
+	// Only read the sector numbers (a possibly incomplete last record is
+	// ignored, it will get overwritten).
+	auto numSlots = (size - HEADER_SIZE) / RECORD_SIZE;
+	std::array<uint8_t, 8> sector;
+	for (auto slot : xrange(numSlots)) {
+		deltaFile.seek(HEADER_SIZE + slot * RECORD_SIZE);
+		deltaFile.read(sector);
+		index[Endian::read_UA_L64(sector.data())] = slot;
+	}
+}
+
+void SectorOverlay::readSlot(size_t slot, SectorBuffer& buf)
+{
+	if (deltaFileName.empty()) {
+		buf = memory[slot];
+	} else {
+		deltaFile.seek(HEADER_SIZE + slot * RECORD_SIZE + 8);
+		deltaFile.read(buf.raw);
+	}
+}
+
+void SectorOverlay::read(std::span<SectorBuffer> buffers, size_t startSector)
+{
+	auto end = startSector + buffers.size();
+	for (auto it = index.lower_bound(startSector);
+	     (it != index.end()) && (it->first < end); ++it) {
+		readSlot(it->second, buffers[it->first - startSector]);
+	}
+}
+
+void SectorOverlay::write(size_t sector, const SectorBuffer& buf)
+{
+	auto [it, inserted] = index.try_emplace(sector, index.size());
+	auto slot = it->second;
+	if (deltaFileName.empty()) {
+		if (inserted) {
+			memory.push_back(buf);
+		} else {
+			memory[slot] = buf;
+		}
+	} else {
+		std::array<uint8_t, 8> num;
+		Endian::write_UA_L64(num.data(), sector);
+		deltaFile.seek(HEADER_SIZE + slot * RECORD_SIZE);
+		deltaFile.write(num);
+		deltaFile.write(buf.raw);
+	}
+}
+
+template<typename Archive>
+void SectorOverlay::serialize(Archive& ar, unsigned /*version*/)
+{
+	ar.serialize("deltaFile", deltaFileName);
+
+	std::vector<size_t> sectors;
+	std::vector<uint8_t> data;
+	if constexpr (!Archive::IS_LOADER) {
+		sectors.reserve(index.size());
+		data.resize(index.size() * sizeof(SectorBuffer));
+		SectorBuffer buf;
+		for (const auto& [sector, slot] : index) {
+			readSlot(slot, buf);
+			ranges::copy(buf.raw, subspan(data, sectors.size() * sizeof(buf)));
+			sectors.push_back(sector);
+		}
+	}
+	ar.serialize("sectors", sectors);
+	if constexpr (Archive::IS_LOADER) {
+		data.resize(sectors.size() * sizeof(SectorBuffer));
+	}
+	ar.serialize_blob("data", std::span{data});
+
+	if constexpr (Archive::IS_LOADER) {
+		index.clear();
+		memory.clear();
+		if (deltaFileName.empty()) {
+			deltaFile.close();
+		} else {
+			openDeltaFile(true);
+		}
+		SectorBuffer buf;
+		for (auto [i, sector] : enumerate(sectors)) {
+			ranges::copy(subspan(data, i * sizeof(buf), sizeof(buf)), buf.raw);
+			write(sector, buf);
+		}
+	}
+}
+INSTANTIATE_SERIALIZE_METHODS(SectorOverlay);
+
+} // namespace openmsx
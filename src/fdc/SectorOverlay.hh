@@ -0,0 +1,70 @@
+#ifndef SECTOROVERLAY_HH
+#define SECTOROVERLAY_HH
+
+#include "DiskImageUtils.hh"
+#include "File.hh"
+
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace openmsx {
+
+/** Copy-on-write layer on top of a disk image.
+  *
+  * Written sectors don't go to the image itself, instead they're stored in
+  * memory or in a separate (sparse) delta file. When reading, these sectors
+  * take precedence over the content of the image. This allows to use one
+  * (possibly huge and/or read-only) image from many emulator instances at
+  * the same time, without first making a copy.
+  *
+  * The delta file starts with a 16-byte header, followed by records of a
+  * 64-bit little endian sector number and the 512 bytes of sector data.
+  * Rewriting a sector updates its record in-place. An existing delta file
+  * is reused (so the changes persist across sessions), but it's not checked
+  * whether it was created for the same image.
+  */
+class SectorOverlay
+{
+public:
+	/** Keep the written sectors only in memory. */
+	SectorOverlay() = default;
+
+	/** Keep the written sectors in the given file. The file is created
+	  * if it doesn't exist yet.
+	  * @throws FileException
+	  */
+	explicit SectorOverlay(std::string deltaFile);
+
+	/** Replace those sectors in 'buffers' (which start at sector
+	  * 'startSector') that were written before.
+	  * @throws FileException */
+	void read(std::span<SectorBuffer> buffers, size_t startSector);
+
+	/** @throws FileException */
+	void write(size_t sector, const SectorBuffer& buf);
+
+	[[nodiscard]] bool empty() const { return index.empty(); }
+	[[nodiscard]] const std::string& getDeltaFile() const { return deltaFileName; }
+
+	/** The complete content (including the name of the delta file, if
+	  * any) is stored, so that it can be restored independent of the
+	  * current content of the delta file. */
+	template<typename Archive>
+	void serialize(Archive& ar, unsigned version);
+
+private:
+	void openDeltaFile(bool truncate);
+	void readSlot(size_t slot, SectorBuffer& buf);
+
+private:
+	std::map<size_t, size_t> index; // sector number -> slot
+	std::vector<SectorBuffer> memory; // slots, when there's no delta file
+	std::string deltaFileName;
+	File deltaFile;
+};
+
+} // namespace openmsx
+
+#endif
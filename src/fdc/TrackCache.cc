@@ -0,0 +1,43 @@
+#include "TrackCache.hh"
+
+#include "ranges.hh"
+
+#include <algorithm>
+
+namespace openmsx {
+
+[[nodiscard]] static constexpr unsigned trackNum(uint8_t track, uint8_t side)
+{
+	return track | (side << 8);
+}
+
+bool TrackCache::get(uint8_t track, uint8_t side, RawTrack& output)
+{
+	auto it = ranges::find(entries, trackNum(track, side), &Entry::num);
+	if (it == entries.end()) return false;
+	it->lastUse = ++useCounter;
+	output = it->data;
+	return true;
+}
+
+void TrackCache::put(uint8_t track, uint8_t side, const RawTrack& input)
+{
+	auto num = trackNum(track, side);
+	if (auto it = ranges::find(entries, num, &Entry::num); it != entries.end()) {
+		it->data = input;
+		it->lastUse = ++useCounter;
+	} else if (entries.size() < NUM_ENTRIES) {
+		entries.push_back({input, num, ++useCounter});
+	} else {
+		auto& lru = *std::min_element(entries.begin(), entries.end(),
+			[](const Entry& x, const Entry& y) { return x.lastUse < y.lastUse; });
+		lru = Entry{input, num, ++useCounter};
+	}
+}
+
+void TrackCache::clear()
+{
+	entries.clear();
+}
+
+} // namespace openmsx
@@ -0,0 +1,45 @@
+#ifndef TRACKCACHE_HH
+#define TRACKCACHE_HH
+
+#include "RawTrack.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace openmsx {
+
+/** Cache of the most recently used (raw) tracks of a disk image.
+  *
+  * Constructing a raw track (reading it from a DMK image, or encoding the
+  * sectors, gaps and CRCs for a sector based image) is relatively expensive,
+  * while the FDC typically reads the same few tracks over and over (each
+  * time the disk rotates to the next sector, and when software alternates
+  * between both sides or a few nearby tracks). The owner must clear() the
+  * cache when the disk content changes.
+  */
+class TrackCache
+{
+public:
+	static constexpr size_t NUM_ENTRIES = 16;
+
+	/** Copy the track to 'output', or return false if it's not cached. */
+	[[nodiscard]] bool get(uint8_t track, uint8_t side, RawTrack& output);
+
+	/** Store a track, replacing the least recently used entry if needed. */
+	void put(uint8_t track, uint8_t side, const RawTrack& input);
+
+	void clear();
+
+private:
+	struct Entry {
+		RawTrack data;
+		unsigned num;
+		uint64_t lastUse;
+	};
+	std::vector<Entry> entries;
+	uint64_t useCounter = 0;
+};
+
+} // namespace openmsx
+
+#endif
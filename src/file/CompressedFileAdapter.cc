@@ -1,9 +1,19 @@
 #include "CompressedFileAdapter.hh"
 #include "FileException.hh"
+#include "FileOperations.hh"
+#include "LocalFile.hh"
+#include "endian.hh"
 #include "hash_set.hh"
 #include "ranges.hh"
+#include "sha1.hh"
+#include "strCat.hh"
 #include "xxhash.hh"
+#include <bit>
 #include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace openmsx {
 
@@ -14,55 +24,198 @@ struct GetURLFromDecompressed {
 };
 static hash_set<std::unique_ptr<CompressedFileAdapter::Decompressed>,
                 GetURLFromDecompressed, XXHasher> decompressCache;
+// Compressed files can also be opened from the FilePool indexer threads.
+// This mutex also protects the variables below.
+static std::mutex decompressCacheMutex;
 
+// Entries that are no longer in use are only removed from the cache when the
+// total size exceeds this limit (least recently used first).
+static size_t maxCacheSize = 64 * 1024 * 1024;
+static size_t cacheSize = 0; // sum of the sizes of all entries in the cache
+static uint64_t useCounter = 0; // to determine the least recently used entry
+static std::string diskCacheDirectory; // empty if disabled
 
-CompressedFileAdapter::CompressedFileAdapter(std::unique_ptr<FileBase> file_)
+
+// Remove entries that are not in use (least recently used first) until the
+// cache fits in its budget again. Must be called with the mutex locked.
+static void evictUnused()
+{
+	while (cacheSize > maxCacheSize) {
+		auto victim = end(decompressCache);
+		for (auto it = begin(decompressCache); it != end(decompressCache); ++it) {
+			if (((*it)->useCount == 0) &&
+			    ((victim == end(decompressCache)) || ((*it)->lastUse < (*victim)->lastUse))) {
+				victim = it;
+			}
+		}
+		if (victim == end(decompressCache)) break; // all entries are in use
+		cacheSize -= (*victim)->data.size();
+		decompressCache.erase(victim);
+	}
+}
+
+// Decompressed files in the disk cache are named after the sha1sum of the
+// compressed file (+ the URL suffix, e.g. the zip member). The content is the
+// decompressed data, followed by the original name and (4 bytes) its length.
+static std::string getDiskCacheFilename(
+	const std::string& directory, FileBase& file, std::string_view urlSuffix)
+{
+	SHA1 sha1;
+	sha1.update(file.mmap());
+	sha1.update({std::bit_cast<const uint8_t*>(urlSuffix.data()), urlSuffix.size()});
+	return strCat(directory, '/', sha1.digest().toString());
+}
+
+static bool loadFromDiskCache(const std::string& filename, CompressedFileAdapter::Decompressed& d)
+{
+	if (!FileOperations::isRegularFile(filename)) return false;
+	try {
+		auto f = std::make_unique<LocalFile>(filename, File::NORMAL);
+		auto content = f->mmap();
+		if (content.size() < 4) return false;
+		size_t nameLen = Endian::read_UA_L32(&content[content.size() - 4]);
+		if (nameLen > (content.size() - 4)) return false;
+		size_t size = content.size() - 4 - nameLen;
+		d.originalName.assign(std::bit_cast<const char*>(&content[size]), nameLen);
+		d.data = content.first(size);
+		d.mappedFile = std::move(f);
+		return true;
+	} catch (MSXException&) {
+		return false;
+	}
+}
+
+static void storeInDiskCache(const std::string& filename, const CompressedFileAdapter::Decompressed& d)
+{
+	// Write to a temporary file first, so that other openMSX processes
+	// never see a partially written file.
+	auto tmpName = strCat(filename, ".tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+	try {
+		FileOperations::mkdirp(std::string(FileOperations::getDirName(filename)));
+		std::ofstream of;
+		FileOperations::openOfStream(of, tmpName, std::ios::binary);
+		Endian::L32 nameLen(uint32_t(d.originalName.size()));
+		of.write(std::bit_cast<const char*>(d.data.data()), std::streamsize(d.data.size()));
+		of.write(d.originalName.data(), std::streamsize(d.originalName.size()));
+		of.write(std::bit_cast<const char*>(&nameLen), sizeof(nameLen));
+		of.close();
+		if (of.good() && (FileOperations::rename(tmpName, filename) == 0)) {
+			return;
+		}
+	} catch (MSXException&) {
+		// ignore, the disk cache is only an optimization
+	}
+	FileOperations::unlink(tmpName);
+}
+
+
+CompressedFileAdapter::CompressedFileAdapter(std::unique_ptr<FileBase> file_, std::string_view urlSuffix)
 	: file(std::move(file_))
+	, url(strCat(file->getURL(), urlSuffix))
 {
 }
 
 CompressedFileAdapter::~CompressedFileAdapter()
 {
 	if (decompressed) {
+		std::scoped_lock lock(decompressCacheMutex);
 		auto it = decompressCache.find(getURL());
 		assert(it != end(decompressCache));
 		assert(it->get() == decompressed);
 		--(*it)->useCount;
 		if ((*it)->useCount == 0) {
-			// delete last user of Decompressed, remove from cache
-			decompressCache.erase(it);
+			// last user of Decompressed, keep it in the cache (if
+			// there's room) in case the same file gets opened again
+			(*it)->lastUse = ++useCounter;
+			evictUnused();
 		}
 	}
 }
 
+void CompressedFileAdapter::setCacheSize(size_t bytes)
+{
+	std::scoped_lock lock(decompressCacheMutex);
+	maxCacheSize = bytes;
+	evictUnused();
+}
+
+void CompressedFileAdapter::setDiskCacheDirectory(std::string directory)
+{
+	std::scoped_lock lock(decompressCacheMutex);
+	diskCacheDirectory = std::move(directory);
+}
+
 void CompressedFileAdapter::decompress()
 {
 	if (decompressed) return;
 
-	const std::string& url = getURL();
-	auto it = decompressCache.find(url);
-	if (it == end(decompressCache)) {
-		auto d = std::make_unique<Decompressed>();
+	auto use = [&](auto it) {
+		++(*it)->useCount;
+		decompressed = it->get();
+	};
+	auto modificationDate = file->getModificationDate();
+	std::string diskCacheDir;
+	{
+		std::scoped_lock lock(decompressCacheMutex);
+		if (auto it = decompressCache.find(url); it != end(decompressCache)) {
+			if (((*it)->useCount == 0) &&
+			    ((*it)->cachedModificationDate != modificationDate)) {
+				// file has changed since it was decompressed
+				cacheSize -= (*it)->data.size();
+				decompressCache.erase(it);
+			} else {
+				use(it);
+				file.reset();
+				return;
+			}
+		}
+		diskCacheDir = diskCacheDirectory;
+	}
+
+	// not yet in cache, decompress without holding the lock
+	auto d = std::make_unique<Decompressed>();
+	std::string diskCacheFilename;
+	if (!diskCacheDir.empty()) {
+		diskCacheFilename = getDiskCacheFilename(
+			diskCacheDir, *file, std::string_view(url).substr(file->getURL().size()));
+	}
+	if (diskCacheFilename.empty() || !loadFromDiskCache(diskCacheFilename, *d)) {
 		decompress(*file, *d);
-		d->cachedModificationDate = getModificationDate();
-		d->cachedURL = url;
-		it = decompressCache.insert_noDuplicateCheck(std::move(d));
+		if (d->keepFile) {
+			d->mappedFile = std::move(file);
+		} else if (!diskCacheFilename.empty()) {
+			storeInDiskCache(diskCacheFilename, *d);
+		}
+	}
+	d->cachedModificationDate = modificationDate;
+	d->cachedURL = url;
+	{
+		std::scoped_lock lock(decompressCacheMutex);
+		auto it = decompressCache.find(url);
+		if (it == end(decompressCache)) {
+			cacheSize += d->data.size();
+			it = decompressCache.insert_noDuplicateCheck(std::move(d));
+		} else {
+			// another thread decompressed the same file in the
+			// meantime, use that result (and drop ours)
+		}
+		use(it);
+		evictUnused();
 	}
-	++(*it)->useCount;
-	decompressed = it->get();
 
-	// close original file after successful decompress
+	// close original file after successful decompress (if not yet moved
+	// into 'mappedFile')
 	file.reset();
 }
 
 void CompressedFileAdapter::read(std::span<uint8_t> buffer)
 {
 	decompress();
-	if (decompressed->size < (pos + buffer.size())) {
+	const auto& data = decompressed->data;
+	if (data.size() < (pos + buffer.size())) {
 		throw FileException("Read beyond end of file");
 	}
-	const auto& buf = decompressed->buf;
-	ranges::copy(std::span{&buf[pos], buffer.size()}, buffer);
+	ranges::copy(data.subspan(pos, buffer.size()), buffer);
 	pos += buffer.size();
 }
 
@@ -74,7 +227,7 @@ void CompressedFileAdapter::write(std::span<const uint8_t> /*buffer*/)
 std::span<const uint8_t> CompressedFileAdapter::mmap()
 {
 	decompress();
-	return { decompressed->buf.data(), decompressed->size };
+	return decompressed->data;
 }
 
 void CompressedFileAdapter::munmap()
@@ -85,7 +238,7 @@ void CompressedFileAdapter::munmap()
 size_t CompressedFileAdapter::getSize()
 {
 	decompress();
-	return decompressed->size;
+	return decompressed->data.size();
 }
 
 void CompressedFileAdapter::seek(size_t newPos)
@@ -110,7 +263,7 @@ void CompressedFileAdapter::flush()
 
 const std::string& CompressedFileAdapter::getURL() const
 {
-	return file ? file->getURL() : decompressed->cachedURL;
+	return url;
 }
 
 std::string_view CompressedFileAdapter::getOriginalName()
@@ -3,7 +3,11 @@
 
 #include "FileBase.hh"
 #include "MemBuffer.hh"
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 
 namespace openmsx {
 
@@ -12,13 +16,32 @@ class CompressedFileAdapter : public FileBase
 public:
 	struct Decompressed {
 		MemBuffer<uint8_t> buf;
-		size_t size;
+		std::span<const uint8_t> data; // points into 'buf' or into 'mappedFile'
+		// Set by decompress() when 'data' points into the mmap()'ed
+		// original file (e.g. for uncompressed zip members). In that
+		// case the original file is kept open in 'mappedFile'.
+		bool keepFile = false;
+		std::unique_ptr<FileBase> mappedFile; // original file or file in the disk cache
 		std::string originalName;
 		std::string cachedURL;
 		time_t cachedModificationDate;
 		unsigned useCount = 0;
+		uint64_t lastUse = 0; // only meaningful when 'useCount == 0'
 	};
 
+	/** Decompressed files are shared by all users of the same file. When
+	  * a file is no longer in use, it's kept in the cache as long as the
+	  * total size of the cache stays below this limit (least recently used
+	  * files are removed first). So reopening (e.g. when switching
+	  * machines or loading a savestate) doesn't decompress it again.
+	  */
+	static void setCacheSize(size_t bytes);
+
+	/** Also store decompressed files in this directory, so that they can
+	  * be reused by later openMSX sessions. Empty string to disable.
+	  */
+	static void setDiskCacheDirectory(std::string directory);
+
 	void read(std::span<uint8_t> buffer) final;
 	void write(std::span<const uint8_t> buffer) final;
 	[[nodiscard]] std::span<const uint8_t> mmap() final;
@@ -34,7 +57,9 @@ public:
 	[[nodiscard]] time_t getModificationDate() final;
 
 protected:
-	explicit CompressedFileAdapter(std::unique_ptr<FileBase> file);
+	/** @param urlSuffix Appended to the URL of 'file' (e.g. to select a
+	  *        member of an archive). */
+	explicit CompressedFileAdapter(std::unique_ptr<FileBase> file, std::string_view urlSuffix = {});
 	~CompressedFileAdapter() override;
 	virtual void decompress(FileBase& file, Decompressed& decompressed) = 0;
 
@@ -45,6 +70,7 @@ private:
 	// invariant: exactly one of 'file' and 'decompressed' is '!= nullptr'
 	std::unique_ptr<FileBase> file;
 	const Decompressed* decompressed = nullptr;
+	std::string url;
 	size_t pos = 0;
 };
 
@@ -0,0 +1,160 @@
+#include "DirectoryWatcher.hh"
+
+#include "foreach_file.hh"
+#include "systemfuncs.hh"
+
+#include "strCat.hh"
+
+#if HAVE_INOTIFY_INIT1
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <array>
+#include <bit>
+#endif
+
+namespace openmsx {
+
+#if HAVE_INOTIFY_INIT1
+
+static constexpr uint32_t WATCH_MASK =
+	IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE |
+	IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+DirectoryWatcher::DirectoryWatcher()
+	: fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+	if (fd >= 0) close(fd);
+}
+
+bool DirectoryWatcher::isSupported() const
+{
+	return fd >= 0;
+}
+
+bool DirectoryWatcher::add(const std::string& directory, bool recursive)
+{
+	if (fd < 0) return false;
+	std::string dir = directory;
+	while ((dir.size() > 1) && (dir.back() == '/')) dir.pop_back();
+	return addWatch(dir, recursive);
+}
+
+bool DirectoryWatcher::addWatch(const std::string& directory, bool recursive)
+{
+	int wd = inotify_add_watch(fd, directory.c_str(), WATCH_MASK);
+	if (wd < 0) return false; // e.g. ENOSPC: reached max_user_watches
+	watches[wd] = Watch{directory, recursive};
+
+	bool ok = true;
+	if (recursive) {
+		foreach_file_and_directory(
+			directory,
+			[](const std::string& /*path*/) { /*nothing*/ },
+			[&](const std::string& path) { if (!addWatch(path, true)) ok = false; });
+	}
+	return ok;
+}
+
+void DirectoryWatcher::removeWatches(std::string_view directory)
+{
+	std::vector<int> toRemove;
+	for (const auto& [wd, watch] : watches) {
+		std::string_view p = watch.path;
+		if (p.starts_with(directory) &&
+		    ((p.size() == directory.size()) || (p[directory.size()] == '/'))) {
+			toRemove.push_back(wd);
+		}
+	}
+	for (int wd : toRemove) {
+		inotify_rm_watch(fd, wd); // will still generate an IN_IGNORED event
+		watches.erase(wd);
+	}
+}
+
+void DirectoryWatcher::clear()
+{
+	for (const auto& [wd, watch] : watches) {
+		inotify_rm_watch(fd, wd);
+	}
+	watches.clear();
+}
+
+// Files in a newly created (or moved) directory may already exist before we
+// could start watching that directory.
+void DirectoryWatcher::reportDirectory(const std::string& directory, std::vector<Event>& events)
+{
+	foreach_file_recursive(directory, [&](const std::string& path) {
+		events.push_back({Event::Type::CHANGED, false, path});
+	});
+}
+
+std::vector<DirectoryWatcher::Event> DirectoryWatcher::poll()
+{
+	std::vector<Event> events;
+	if (fd < 0) return events;
+
+	alignas(inotify_event) std::array<char, 4096> buf;
+	while (true) {
+		auto len = read(fd, buf.data(), buf.size());
+		if (len <= 0) break; // EAGAIN: no more pending events
+
+		for (ssize_t i = 0; i < len; /**/) {
+			const auto* ev = std::bit_cast<const inotify_event*>(&buf[i]);
+			i += ssize_t(sizeof(inotify_event) + ev->len);
+
+			if (ev->mask & IN_Q_OVERFLOW) {
+				events.push_back({Event::Type::LOST_EVENTS, false, {}});
+				continue;
+			}
+			auto* watch = lookup(watches, ev->wd);
+			if (!watch) continue; // already removed
+			if (ev->mask & IN_IGNORED) {
+				// directory was deleted (or unmounted)
+				watches.erase(ev->wd);
+				continue;
+			}
+			if (ev->len == 0) continue; // event for the directory itself
+
+			// (copy because addWatch() may invalidate 'watch')
+			bool recursive = watch->recursive;
+			auto path = strCat(watch->path, '/', ev->name);
+			bool isDir = ev->mask & IN_ISDIR;
+
+			if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+				if (isDir) removeWatches(path);
+				events.push_back({Event::Type::REMOVED, isDir, std::move(path)});
+			} else if (isDir) {
+				if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+					if (recursive) {
+						addWatch(path, true);
+						reportDirectory(path, events);
+					} else {
+						events.push_back({Event::Type::CHANGED, true, std::move(path)});
+					}
+				}
+			} else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB)) {
+				// Ignore IN_CREATE for files, the content is only
+				// complete on IN_CLOSE_WRITE.
+				events.push_back({Event::Type::CHANGED, false, std::move(path)});
+			}
+		}
+	}
+	return events;
+}
+
+#else // HAVE_INOTIFY_INIT1
+
+DirectoryWatcher::DirectoryWatcher() = default;
+DirectoryWatcher::~DirectoryWatcher() = default;
+bool DirectoryWatcher::isSupported() const { return false; }
+bool DirectoryWatcher::add(const std::string& /*directory*/, bool /*recursive*/) { return false; }
+void DirectoryWatcher::clear() {}
+std::vector<DirectoryWatcher::Event> DirectoryWatcher::poll() { return {}; }
+
+#endif // HAVE_INOTIFY_INIT1
+
+} // namespace openmsx
@@ -0,0 +1,76 @@
+#ifndef DIRECTORYWATCHER_HH
+#define DIRECTORYWATCHER_HH
+
+#include "hash_map.hh"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openmsx {
+
+/** Get notified about changes to the files in a set of directories.
+  *
+  * Currently only implemented for Linux (via inotify). On other platforms
+  * isSupported() returns false and poll() never reports any changes, so
+  * users must still be prepared to detect changes in some other way.
+  *
+  * This class does not create any threads, poll() must be called
+  * regularly (it never blocks).
+  */
+class DirectoryWatcher
+{
+public:
+	struct Event {
+		enum class Type : uint8_t {
+			CHANGED,  // file created, modified or moved into a directory
+			REMOVED,  // file or directory removed or moved away
+			LOST_EVENTS, // some events were lost, rescan all directories
+		};
+		Type type;
+		bool isDirectory = false;
+		std::string path; // empty for LOST_EVENTS
+	};
+
+	DirectoryWatcher();
+	~DirectoryWatcher();
+	DirectoryWatcher(const DirectoryWatcher&) = delete;
+	DirectoryWatcher(DirectoryWatcher&&) = delete;
+	DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+	DirectoryWatcher& operator=(DirectoryWatcher&&) = delete;
+
+	[[nodiscard]] bool isSupported() const;
+
+	/** Start watching the given directory.
+	  * @param recursive Also watch all (current and future) subdirectories.
+	  *        Files in subdirectories that are created later on are
+	  *        reported as CHANGED.
+	  * @return false if (some of) the directories couldn't be watched,
+	  *         for example because the system limit was reached.
+	  */
+	bool add(const std::string& directory, bool recursive);
+
+	/** Stop watching all directories. */
+	void clear();
+
+	/** Return all changes since the previous call. Does not block. */
+	[[nodiscard]] std::vector<Event> poll();
+
+private:
+	bool addWatch(const std::string& directory, bool recursive);
+	void removeWatches(std::string_view directory);
+	void reportDirectory(const std::string& directory, std::vector<Event>& events);
+
+private:
+	struct Watch {
+		std::string path;
+		bool recursive;
+	};
+	hash_map<int, Watch> watches; // indexed by inotify watch descriptor
+	int fd = -1;
+};
+
+} // namespace openmsx
+
+#endif
@@ -17,6 +17,16 @@ File::File() = default;
 	static constexpr std::array<uint8_t, 3> GZ_HEADER  = {0x1F, 0x8B, 0x08};
 	static constexpr std::array<uint8_t, 4> ZIP_HEADER = {0x50, 0x4B, 0x03, 0x04};
 
+	// Only when reading: never truncate or create the archive itself.
+	bool readOnly = (mode == File::NORMAL) || (mode == File::PRE_CACHE) ||
+	                (mode == File::LOAD_PERSISTENT);
+	if (auto split = readOnly ? ZipFileAdapter::splitMemberName(filename) : std::nullopt) {
+		// 'archive.zip#member'
+		auto& [archive, member] = *split;
+		return std::make_unique<ZipFileAdapter>(
+			std::make_unique<LocalFile>(std::move(archive), mode), std::move(member));
+	}
+
 	std::unique_ptr<FileBase> file = std::make_unique<LocalFile>(std::move(filename), mode);
 	if (file->getSize() >= 4) {
 		std::array<uint8_t, 4> buf;
@@ -1,6 +1,7 @@
 #include "FileContext.hh"
 #include "FileOperations.hh"
 #include "FileException.hh"
+#include "ZipFileAdapter.hh"
 #include "serialize.hh"
 #include "serialize_stl.hh"
 #include "stl.hh"
@@ -51,7 +52,7 @@ const string SYSTEM_DATA  = "{{SYSTEM_DATA}}";
 }
 
 [[nodiscard]] static string resolveHelper(std::span<const string> pathList,
-                            string_view filename)
+                            string_view filename, bool allowZipMember)
 {
 	if (string filepath = FileOperations::expandTilde(
 	                          FileOperations::expandCurrentDirFromDrive(string(filename)));
@@ -63,7 +64,9 @@ const string SYSTEM_DATA  = "{{SYSTEM_DATA}}";
 	for (const auto& p : pathList) {
 		string name = FileOperations::join(p, filename);
 		assert(!FileOperations::needsTildeExpansion(name));
-		if (FileOperations::exists(name)) {
+		if (FileOperations::exists(name) ||
+		    (allowZipMember && // 'archive.zip#member', only for reading
+		     ZipFileAdapter::splitMemberName(name))) {
 			return name;
 		}
 	}
@@ -78,7 +81,7 @@ FileContext::FileContext(vector<string>&& paths_, vector<string>&& savePaths_)
 
 string FileContext::resolve(string_view filename) const
 {
-	string result = resolveHelper(getPaths(), filename);
+	string result = resolveHelper(getPaths(), filename, true);
 	assert(!FileOperations::needsTildeExpansion(result));
 	return result;
 }
@@ -91,7 +94,7 @@ string FileContext::resolveCreate(string_view filename) const
 
 	string result;
 	try {
-		result = resolveHelper(savePaths2, filename);
+		result = resolveHelper(savePaths2, filename, false);
 	} catch (FileException&) {
 		const string& path = savePaths2.front();
 		try {
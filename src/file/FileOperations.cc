@@ -54,6 +54,7 @@
 #include <array>
 #include <sstream>
 #include <cerrno>
+#include <cstdio>
 #include <cstdlib>
 #include <stdexcept>
 #include <cassert>
@@ -184,6 +185,15 @@ int rmdir(zstring_view path)
 #endif
 }
 
+int rename(zstring_view oldPath, zstring_view newPath)
+{
+#ifdef _WIN32
+	return _wrename(utf8to16(oldPath).c_str(), utf8to16(newPath).c_str());
+#else
+	return ::rename(oldPath.c_str(), newPath.c_str());
+#endif
+}
+
 #ifdef _WIN32
 int deleteRecursive(zstring_view path)
 {
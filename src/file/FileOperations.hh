@@ -70,6 +70,11 @@ namespace openmsx::FileOperations {
 	 */
 	int rmdir(zstring_view path);
 
+	/**
+	 * Call rename() in a platform-independent manner
+	 */
+	int rename(zstring_view oldPath, zstring_view newPath);
+
 	/** Recursively delete a file or directory and (in case of a directory)
 	  * all its sub-components.
 	  */
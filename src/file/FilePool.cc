@@ -9,6 +9,7 @@
 #include "CliComm.hh"
 #include "Reactor.hh"
 #include "outer.hh"
+#include "strCat.hh"
 #include "xrange.hh"
 #include <memory>
 
@@ -29,7 +30,8 @@ namespace openmsx {
 }
 
 FilePool::FilePool(CommandController& controller, Reactor& reactor_)
-	: core(FileOperations::getUserDataDir() + "/.filecache",
+	: RTSchedulable(reactor_.getRTScheduler())
+	, core(FileOperations::getUserDataDir() + "/.filecache",
 	       [&] { return getDirectories(); },
 	       [&](std::string_view message, float fraction) { reportProgress(message, fraction); })
 	, filePoolSetting(
@@ -37,16 +39,26 @@ FilePool::FilePool(CommandController& controller, Reactor& reactor_)
 		"This is an internal setting. Don't change this directly, "
 		"instead use the 'filepool' command.",
 		initialFilePoolSettingValue().getString())
+	, watchSetting(
+		controller, "filepool_watch",
+		"Watch the filepool directories for changes and keep the "
+		"filepool database up-to-date in the background (only "
+		"supported on Linux)",
+		false)
 	, reactor(reactor_)
 	, sha1SumCommand(controller)
+	, reindexCommand(controller)
 {
 	filePoolSetting.attach(*this);
+	watchSetting.attach(*this);
 	reactor.getEventDistributor().registerEventListener(EventType::QUIT, *this);
+	updateWatching();
 }
 
 FilePool::~FilePool()
 {
 	reactor.getEventDistributor().unregisterEventListener(EventType::QUIT, *this);
+	watchSetting.detach(*this);
 	filePoolSetting.detach(*this);
 }
 
@@ -139,8 +151,25 @@ FilePoolCore::Directories FilePool::getDirectories() const
 
 void FilePool::update(const Setting& setting) noexcept
 {
-	assert(&setting == &filePoolSetting); (void)setting;
-	(void)getDirectories(); // check for syntax errors
+	if (&setting == &filePoolSetting) {
+		(void)getDirectories(); // check for syntax errors
+	} else {
+		assert(&setting == &watchSetting);
+	}
+	updateWatching(); // (re)start with the new set of directories
+}
+
+void FilePool::updateWatching()
+{
+	core.stopWatching();
+	if (!watchSetting.getBoolean()) return;
+
+	if (!core.startWatching()) {
+		reactor.getCliComm().printWarning(
+			"Could not watch (all) filepool directories for changes, "
+			"changes are only noticed when searching the filepool.");
+	}
+	scheduleRT(0);
 }
 
 void FilePool::reportProgress(std::string_view message, float fraction)
@@ -158,6 +187,36 @@ int FilePool::signalEvent(const Event& event)
 	return 0;
 }
 
+[[nodiscard]] static std::string indexProgressMessage(const FilePoolCore::IndexProgress& progress)
+{
+	return strCat("scanned ", progress.scanned, " files, calculated ",
+	              progress.hashed, " of ", progress.toHash, " sha1sums");
+}
+
+void FilePool::executeRT()
+{
+	core.processWatchEvents();
+	auto progress = core.processIndexResults();
+	if (reindexing) {
+		auto& cliComm = reactor.getCliComm();
+		if (progress.done) {
+			cliComm.printProgress(
+				strCat("Indexing filepool done: ", indexProgressMessage(progress)),
+				1.0f);
+			reindexing = false;
+		} else {
+			cliComm.printProgress(
+				strCat("Indexing filepool: ", indexProgressMessage(progress)),
+				progress.toHash ? float(progress.hashed) / float(progress.toHash) : -1.0f);
+		}
+	}
+	if (!progress.done) {
+		scheduleRT(250'000); // 4x per second
+	} else if (core.isWatching()) {
+		scheduleRT(1'000'000);
+	}
+}
+
 
 // class Sha1SumCommand
 
@@ -186,4 +245,36 @@ void FilePool::Sha1SumCommand::tabCompletion(std::vector<std::string>& tokens) c
 	completeFileName(tokens, userFileContext());
 }
 
+
+// class ReindexCommand
+
+FilePool::ReindexCommand::ReindexCommand(
+		CommandController& commandController_)
+	: Command(commandController_, "__filepool_reindex")
+{
+}
+
+void FilePool::ReindexCommand::execute(std::span<const TclObject> tokens, TclObject& result)
+{
+	checkNumArgs(tokens, 1, Prefix{1}, nullptr);
+	auto& filePool = OUTER(FilePool, reindexCommand);
+	auto& core = filePool.core;
+	if (filePool.reindexing) {
+		result = strCat("Indexing in progress: ",
+		                indexProgressMessage(core.getIndexProgress()));
+	} else {
+		core.startIndexing();
+		filePool.reindexing = true;
+		filePool.scheduleRT(0);
+		result = "Started indexing the filepool in the background.";
+	}
+}
+
+std::string FilePool::ReindexCommand::help(std::span<const TclObject> /*tokens*/) const
+{
+	return "Scan all filepool directories in the background and calculate "
+	       "the sha1sums of new or modified files. When indexing is already "
+	       "in progress, report its progress.";
+}
+
 } // namespace openmsx
@@ -1,10 +1,12 @@
 #ifndef FILEPOOL_HH
 #define FILEPOOL_HH
 
+#include "BooleanSetting.hh"
 #include "Command.hh"
 #include "EventListener.hh"
 #include "FilePoolCore.hh"
 #include "Observer.hh"
+#include "RTSchedulable.hh"
 #include "StringSetting.hh"
 
 #include <optional>
@@ -17,6 +19,7 @@ class Reactor;
 class Sha1SumCommand;
 
 class FilePool final : private Observer<Setting>, private EventListener
+                     , private RTSchedulable
 {
 public:
 	FilePool(CommandController& controller, Reactor& reactor);
@@ -39,6 +42,7 @@ public:
 
 private:
 	void reportProgress(std::string_view message, float fraction);
+	void updateWatching();
 
 	// Observer<Setting>
 	void update(const Setting& setting) noexcept override;
@@ -46,9 +50,13 @@ private:
 	// EventListener
 	int signalEvent(const Event& event) override;
 
+	// RTSchedulable
+	void executeRT() override;
+
 private:
 	FilePoolCore core;
 	StringSetting filePoolSetting;
+	BooleanSetting watchSetting;
 	Reactor& reactor;
 
 	class Sha1SumCommand final : public Command {
@@ -59,7 +67,15 @@ private:
 		void tabCompletion(std::vector<std::string>& tokens) const override;
 	} sha1SumCommand;
 
+	class ReindexCommand final : public Command {
+	public:
+		explicit ReindexCommand(CommandController& commandController);
+		void execute(std::span<const TclObject> tokens, TclObject& result) override;
+		[[nodiscard]] std::string help(std::span<const TclObject> tokens) const override;
+	} reindexCommand;
+
 	bool quit = false;
+	bool reindexing = false; // explicitly requested via 'filepool reindex'
 };
 
 } // namespace openmsx
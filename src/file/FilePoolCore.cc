@@ -1,16 +1,24 @@
 #include "FilePoolCore.hh"
+#include "DirectoryWatcher.hh"
 
 #include "File.hh"
 #include "FileException.hh"
 #include "foreach_file.hh"
+#include "ThreadPool.hh"
+#include "ZipFileAdapter.hh"
 
 #include "Date.hh"
 #include "Timer.hh"
+#include "hash_map.hh"
 #include "one_of.hh"
 #include "ranges.hh"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <mutex>
 #include <optional>
+#include <thread>
 #include <tuple>
 
 namespace openmsx {
@@ -23,6 +31,157 @@ struct GetSha1 {
 	}
 };
 
+// ZIP archives that contain more than one member get a separate database
+// entry per member, named 'archive.zip#member'. Returns an empty vector for
+// all other files (those get a single entry, as before).
+static std::vector<std::string> getZipMembers(const std::string& filename)
+{
+	std::vector<std::string> result;
+	if (!ZipFileAdapter::hasZipExtension(filename)) return result;
+	auto members = ZipFileAdapter::getMemberNames(filename);
+	if (members.size() <= 1) return result;
+	for (const auto& member : members) {
+		result.push_back(strCat(filename, '#', member));
+	}
+	return result;
+}
+
+// For 'archive.zip#member' return 'archive.zip', otherwise an empty string.
+[[nodiscard]] static std::string_view getArchiveName(std::string_view filename)
+{
+	auto pos = filename.rfind('#');
+	if (pos == std::string_view::npos) return {};
+	auto archive = filename.substr(0, pos);
+	return ZipFileAdapter::hasZipExtension(archive) ? archive : std::string_view{};
+}
+
+// Background indexer: walks the pool directories and calculates the sha1sum
+// of new or modified files, all on worker threads. The results are collected
+// here and only merged into the database on the main thread (see
+// FilePoolCore::processIndexResults()). Also used to hash the files that are
+// reported as changed by the directory watcher.
+struct FilePoolCore::Indexer
+{
+	struct Result {
+		std::string filename;
+		time_t time;
+		std::optional<Sha1Sum> sum; // empty when the file couldn't be read
+	};
+	using Known = hash_map<std::string, time_t, XXHasher>;
+
+	~Indexer() { stop = true; }
+
+	void startWalk(Known known_, std::vector<std::string> directories);
+	void enqueueHash(std::string filename, time_t time);
+	void walk(const std::vector<std::string>& directories);
+	void hash(const std::string& filename, time_t time);
+	[[nodiscard]] std::vector<Result> takeResults();
+
+	/** Stop as soon as possible, discard the work that didn't start yet.
+	  * Work that's already in progress still finishes in the background.
+	  */
+	void shutdown() {
+		stop = true;
+		threadPool.clear();
+	}
+
+	[[nodiscard]] IndexProgress getProgress() const {
+		// check 'pending' first, so that when 'done' is true the
+		// counters are guaranteed to be final
+		bool done = pending == 0;
+		return {scanned, toHash, hashed, done};
+	}
+
+	// snapshot of the database when walking started (read only while walking)
+	Known known;
+	bool walkStarted = false; // only accessed from the main thread
+
+	std::atomic<bool> stop = false;
+	std::atomic<unsigned> scanned = 0;
+	std::atomic<unsigned> toHash = 0;
+	std::atomic<unsigned> hashed = 0;
+	std::atomic<unsigned> pending = 0; // walk() + all not yet finished hash() calls
+
+	std::mutex mutex; // protects 'results'
+	std::vector<Result> results;
+
+	// Hashing is mostly I/O bound, so use (at least) as many threads as
+	// there are cores. Must be the last member: its destructor waits for
+	// the worker threads, which still access the members above.
+	ThreadPool threadPool{std::max(2u, std::thread::hardware_concurrency())};
+};
+
+void FilePoolCore::Indexer::startWalk(Known known_, std::vector<std::string> directories)
+{
+	assert(!walkStarted);
+	walkStarted = true;
+	known = std::move(known_);
+	++pending;
+	threadPool.enqueue([this, dirs = std::move(directories)] { walk(dirs); });
+}
+
+void FilePoolCore::Indexer::enqueueHash(std::string filename, time_t time)
+{
+	++toHash;
+	++pending;
+	threadPool.enqueue([this, filename = std::move(filename), time] { hash(filename, time); });
+}
+
+void FilePoolCore::Indexer::walk(const std::vector<std::string>& directories)
+{
+	for (const auto& directory : directories) {
+		foreach_file_recursive(directory, [&](const std::string& path, const FileOperations::Stat& st) {
+			if (stop) return false;
+			++scanned;
+			auto time = FileOperations::getModificationDate(st);
+			if (const auto* t = lookup(known, path); t && (*t == time)) {
+				return true; // database is up to date
+			}
+			enqueueHash(path, time);
+			return true;
+		});
+		if (stop) break;
+	}
+	--pending;
+}
+
+void FilePoolCore::Indexer::hash(const std::string& filename, time_t time)
+{
+	auto calc = [&](const std::string& name) {
+		std::optional<Sha1Sum> sum;
+		try {
+			File file(name);
+			sum = SHA1::calc(file.mmap());
+		} catch (MSXException&) {
+			// error reading file
+		}
+		std::scoped_lock lock(mutex);
+		results.push_back({name, time, sum});
+	};
+
+	if (!stop) {
+		if (auto members = getZipMembers(filename); members.empty()) {
+			calc(filename);
+		} else {
+			for (const auto& member : members) {
+				if (stop) break;
+				calc(member);
+			}
+			// an empty result removes the entry for the archive itself
+			std::scoped_lock lock(mutex);
+			results.push_back({filename, time, std::nullopt});
+		}
+		++hashed;
+	}
+	--pending;
+}
+
+std::vector<FilePoolCore::Indexer::Result> FilePoolCore::Indexer::takeResults()
+{
+	std::scoped_lock lock(mutex);
+	return std::exchange(results, {});
+}
+
 
 FilePoolCore::FilePoolCore(std::string fileCache_,
                            std::function<Directories()> getDirectories_,
@@ -40,6 +199,11 @@ FilePoolCore::FilePoolCore(std::string fileCache_,
 
 FilePoolCore::~FilePoolCore()
 {
+	if (indexer) {
+		// keep the results that are already calculated
+		indexer->shutdown();
+		mergeIndexResults();
+	}
 	if (needWrite) {
 		writeSha1sums();
 	}
@@ -240,8 +404,185 @@ void FilePoolCore::writeSha1sums()
 	}
 }
 
+void FilePoolCore::startIndexing()
+{
+	if (!indexer) indexer = std::make_unique<Indexer>();
+	if (indexer->walkStarted) return; // already in progress
+
+	Indexer::Known known;
+	known.reserve(narrow<unsigned>(sha1Index.size()));
+	for (auto idx : sha1Index) {
+		auto& entry = pool[idx];
+		known.emplace_noDuplicateCheck(std::string(entry.filename), entry.getTime());
+	}
+	// Also mark the archives of 'archive.zip#member' entries as known, so
+	// that walking doesn't rehash unmodified multi-member archives.
+	for (auto idx : sha1Index) {
+		auto& entry = pool[idx];
+		if (auto archive = getArchiveName(entry.filename); !archive.empty()) {
+			known.try_emplace(std::string(archive), entry.getTime());
+		}
+	}
+	std::vector<std::string> directories;
+	for (const auto& dir : getDirectories()) {
+		directories.push_back(FileOperations::expandTilde(std::string(dir.path)));
+	}
+
+	indexer->startWalk(std::move(known), std::move(directories));
+}
+
+FilePoolCore::IndexProgress FilePoolCore::getIndexProgress() const
+{
+	return indexer ? indexer->getProgress() : IndexProgress{};
+}
+
+FilePoolCore::IndexProgress FilePoolCore::processIndexResults()
+{
+	if (!indexer) return {};
+
+	// get progress before taking the results (afterwards more results
+	// could have been added, and then we'd lose those)
+	auto progress = indexer->getProgress();
+	mergeIndexResults();
+	if (progress.done) {
+		indexer.reset();
+		if (needWrite) {
+			writeSha1sums();
+			needWrite = false;
+		}
+	}
+	return progress;
+}
+
+void FilePoolCore::mergeIndexResults()
+{
+	for (auto& [filename, time, sum] : indexer->takeResults()) {
+		auto [idx, entry] = findInDatabase(filename);
+		if (!sum) {
+			// error reading file, remove from db
+			if (idx != Index(-1)) remove(idx, *entry);
+		} else if (idx == Index(-1)) {
+			// not in pool
+			insert(*sum, time, filename);
+		} else if (time >= entry->getTime()) { // else: result is outdated
+			// Note: also check the sum when the time is equal, a file
+			// can be modified twice within the same second.
+			if (entry->getTime() != time) {
+				entry->setTime(time);
+				needWrite = true;
+			}
+			if (entry->sum != *sum) {
+				adjustSha1(idx, *entry, *sum);
+			}
+		}
+	}
+}
+
+bool FilePoolCore::startWatching()
+{
+	watcher = std::make_unique<DirectoryWatcher>();
+	bool ok = watcher->isSupported();
+	for (const auto& dir : getDirectories()) {
+		if (!watcher->add(FileOperations::expandTilde(std::string(dir.path)), true)) {
+			ok = false;
+		}
+	}
+	// catch up with the changes that happened while we weren't watching
+	startIndexing();
+	return ok;
+}
+
+void FilePoolCore::stopWatching()
+{
+	watcher.reset();
+}
+
+void FilePoolCore::processWatchEvents()
+{
+	if (!watcher) return;
+
+	using enum DirectoryWatcher::Event::Type;
+	for (auto& event : watcher->poll()) {
+		switch (event.type) {
+		case CHANGED: {
+			auto st = FileOperations::getStat(event.path);
+			if (!st || !FileOperations::isRegularFile(*st)) break;
+			if (!indexer) indexer = std::make_unique<Indexer>();
+			indexer->enqueueHash(std::move(event.path), FileOperations::getModificationDate(*st));
+			break;
+		}
+		case REMOVED:
+			if (event.isDirectory) {
+				removeWithPrefix(event.path, '/');
+			} else {
+				if (auto [idx, entry] = findInDatabase(event.path); idx != Index(-1)) {
+					remove(idx, *entry);
+				}
+				removeWithPrefix(event.path, '#'); // ZIP archive members
+			}
+			break;
+		case LOST_EVENTS:
+			// we missed some changes
+			startIndexing();
+			break;
+		}
+	}
+}
+
+FilePoolCore::ArchiveMembers FilePoolCore::getArchiveMembers()
+{
+	ArchiveMembers result;
+	for (auto idx : sha1Index) {
+		auto archive = getArchiveName(pool[idx].filename);
+		if (archive.empty()) continue;
+		if (auto* indices = lookup(result, archive)) {
+			indices->push_back(idx);
+		} else {
+			result.emplace_noDuplicateCheck(std::string(archive), std::vector{idx});
+		}
+	}
+	return result;
+}
+
+// Does the database contain an up-to-date entry for each member of the given
+// ZIP archive? The number of members is only read once per modification time
+// of the archive.
+bool FilePoolCore::isArchiveIndexed(const std::string& archive, time_t time,
+                                    std::span<const Index> indices)
+{
+	if (!ranges::all_of(indices, [&](Index idx) { return pool[idx].getTime() == time; })) {
+		return false;
+	}
+	auto& [countTime, count] = zipMemberCounts[archive];
+	if (countTime != time) {
+		countTime = time;
+		count = ZipFileAdapter::getMemberNames(archive).size();
+	}
+	return indices.size() == count;
+}
+
+// Remove all entries that start with 'prefix' followed by 'separator'. E.g.
+// all files in a directory (or its subdirectories), or all members of a ZIP
+// archive.
+void FilePoolCore::removeWithPrefix(std::string_view prefix, char separator)
+{
+	auto i = sha1Index.size();
+	while (i != 0) { // 'sha1Index' changes while iterating, use indices
+		--i;
+		std::string_view filename = pool[sha1Index[i]].filename;
+		if ((filename.size() > prefix.size()) &&
+		    filename.starts_with(prefix) &&
+		    (filename[prefix.size()] == separator)) {
+			remove(begin(sha1Index) + i);
+		}
+	}
+}
+
 File FilePoolCore::getFile(FileType fileType, const Sha1Sum& sha1sum)
 {
+	processWatchEvents();
+	if (indexer) processIndexResults();
+
 	File result = getFromPool(sha1sum);
 	if (result.is_open()) return result;
 
@@ -376,8 +717,50 @@ File FilePoolCore::scanDirectory(
 			assert(!result.is_open());
 			return false; // abort foreach_file_recursive
 		}
-		result = scanFile(sha1sum, path, st, poolPath, progress);
-		return !result.is_open(); // abort traversal when found
+		if (ZipFileAdapter::hasZipExtension(path)) {
+			// Only parse the archive when the database is outdated.
+			auto time = FileOperations::getModificationDate(st);
+			if (auto [idx, entry] = findInDatabase(path);
+			    (idx != Index(-1)) && (entry->getTime() == time)) {
+				result = scanFile(sha1sum, path, st, poolPath, progress);
+				return !result.is_open();
+			}
+			if (!progress.archives) progress.archives = getArchiveMembers();
+			if (const auto* indices = lookup(*progress.archives, path)) {
+				if (isArchiveIndexed(path, time, *indices)) {
+					++progress.amountScanned;
+					for (auto idx : *indices) {
+						if (pool[idx].sum != sha1sum) continue;
+						try {
+							result = File(std::string(pool[idx].filename));
+							return false;
+						} catch (FileException&) {
+							// ignore
+						}
+					}
+					return true;
+				}
+				// the member entries are about to change
+				progress.archives->erase(path);
+			}
+		}
+		auto members = getZipMembers(path);
+		if (members.empty()) {
+			result = scanFile(sha1sum, path, st, poolPath, progress);
+			return !result.is_open(); // abort traversal when found
+		}
+		// multi-member ZIP archive: index each member separately
+		if (auto [idx, entry] = findInDatabase(path); idx != Index(-1)) {
+			remove(idx, *entry);
+		}
+		zipMemberCounts[path] = {FileOperations::getModificationDate(st), members.size()};
+		// index all members, also the ones after the match, so that the
+		// archive doesn't need to be parsed again on the next scan
+		for (const auto& member : members) {
+			auto file = scanFile(sha1sum, member, st, poolPath, progress);
+			if (file.is_open() && !result.is_open()) result = std::move(file);
+		}
+		return !result.is_open();
 	};
 	foreach_file_recursive(directory, fileAction);
 	return result;
@@ -459,6 +842,9 @@ std::pair<FilePoolCore::Index, FilePoolCore::Entry*> FilePoolCore::findInDatabas
 
 Sha1Sum FilePoolCore::getSha1Sum(File& file)
 {
+	processWatchEvents();
+	if (indexer) processIndexResults();
+
 	auto time = file.getModificationDate();
 	const std::string& filename = file.getURL();
 
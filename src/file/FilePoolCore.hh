@@ -5,18 +5,24 @@
 #include "ObjectPool.hh"
 #include "MemBuffer.hh"
 #include "SimpleHashSet.hh"
+#include "hash_map.hh"
 #include "sha1.hh"
 #include "xxhash.hh"
 #include <cassert>
 #include <cstdint>
 #include <ctime>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace openmsx {
 
+class DirectoryWatcher;
 class File;
 
 enum class FileType {
@@ -71,13 +77,48 @@ public:
 	 */
 	void abort() { stop = true; }
 
-private:
-	struct ScanProgress {
-		uint64_t lastTime;
-		unsigned amountScanned = 0;
-		bool printed = false;
+	struct IndexProgress {
+		unsigned scanned = 0; // number of files visited so far
+		unsigned toHash = 0;  // number of files that need a (new) sha1sum
+		unsigned hashed = 0;  // number of those that are already done
+		bool done = true;
 	};
 
+	/** Start (re)indexing all pool directories in the background.
+	 * Files that are not yet in the database, or that changed since
+	 * they were added, get their sha1sum calculated in parallel on a
+	 * set of worker threads. Does nothing if indexing is already in
+	 * progress.
+	 * The results only end up in the database (and '.filecache') via
+	 * processIndexResults(), so that must be called regularly until it
+	 * reports that indexing is done.
+	 */
+	void startIndexing();
+
+	/** Merge the results that are produced so far by the background
+	 * indexer into the database. When indexing is finished, this also
+	 * writes the updated database to disk.
+	 */
+	IndexProgress processIndexResults();
+
+	[[nodiscard]] bool isIndexing() const { return indexer != nullptr; }
+	[[nodiscard]] IndexProgress getIndexProgress() const;
+
+	/** Watch the pool directories for changes (currently only supported on
+	 * Linux). Changed files are rehashed in the background, removed files
+	 * are removed from the database. This also starts indexing, to catch up
+	 * with changes that were made while not watching.
+	 * processWatchEvents() and processIndexResults() must be called
+	 * regularly.
+	 * @return false when watching is not supported, or when (some of) the
+	 *         directories could not be watched.
+	 */
+	bool startWatching();
+	void stopWatching();
+	[[nodiscard]] bool isWatching() const { return watcher != nullptr; }
+	void processWatchEvents();
+
+private:
 	struct Entry {
 		Entry(const Sha1Sum& s, time_t t, std::string_view f)
 			: filename(f), time(t), sum(s)
@@ -104,6 +145,15 @@ private:
 	using Pool = ObjectPool<Entry>;
 	using Index = Pool::Index;
 	using Sha1Index = std::vector<Index>; // sorted on sha1sum
+	// Database entries of the 'archive.zip#member' files, grouped per archive.
+	using ArchiveMembers = hash_map<std::string, std::vector<Index>, XXHasher>;
+
+	struct ScanProgress {
+		uint64_t lastTime;
+		unsigned amountScanned = 0;
+		bool printed = false;
+		std::optional<ArchiveMembers> archives = {}; // built on first use
+	};
 
 	class FilenameIndexHelper {
 	public:
@@ -156,6 +206,11 @@ private:
 	        ScanProgress& progress);
 	[[nodiscard]] Sha1Sum calcSha1sum(File& file) const;
 	[[nodiscard]] std::pair<Index, Entry*> findInDatabase(std::string_view filename);
+	void mergeIndexResults();
+	void removeWithPrefix(std::string_view prefix, char separator);
+	[[nodiscard]] ArchiveMembers getArchiveMembers();
+	[[nodiscard]] bool isArchiveIndexed(const std::string& archive, time_t time,
+	                                    std::span<const Index> indices);
 
 private:
 	std::string fileCache; // path of the '.filecache' file.
@@ -167,8 +222,14 @@ private:
 
 	Pool pool; // the actual entries
 	Sha1Index sha1Index; // entries accessible via sha1, sorted on 'CompareSha1'
+	// number of members per ZIP archive, for the given modification time
+	hash_map<std::string, std::pair<time_t, size_t>, XXHasher> zipMemberCounts;
 	FilenameIndex filenameIndex{FilenameIndexHash(pool), FilenameIndexEqual(pool)}; // accessible via filename
 
+	struct Indexer;
+	std::unique_ptr<Indexer> indexer; // only while background indexing is in progress
+	std::unique_ptr<DirectoryWatcher> watcher; // only while watching
+
 	bool stop = false; // abort long search (set via reportProgress callback)
 	bool needWrite = false; // dirty '.filecache'? write on exit
 
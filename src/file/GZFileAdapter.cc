@@ -1,6 +1,7 @@
 #include "GZFileAdapter.hh"
 #include "ZlibInflate.hh"
 #include "FileException.hh"
+#include "endian.hh"
 
 namespace openmsx {
 
@@ -54,11 +55,19 @@ GZFileAdapter::GZFileAdapter(std::unique_ptr<FileBase> file_)
 
 void GZFileAdapter::decompress(FileBase& f, Decompressed& d)
 {
-	ZlibInflate zlib(f.mmap());
+	auto input = f.mmap();
+	ZlibInflate zlib(input);
 	if (!skipHeader(zlib, d.originalName)) {
 		throw FileException("Not a gzip header");
 	}
-	d.size = zlib.inflate(d.buf);
+	// The gzip trailer contains the uncompressed size (modulo 2^32), use
+	// it to (normally) avoid reallocations while decompressing. It can't
+	// be trusted, but inflate() limits it to a sane size.
+	size_t sizeHint = (input.size() >= 4)
+	                ? Endian::read_UA_L32(&input[input.size() - 4])
+	                : 0;
+	auto size = zlib.inflate(d.buf, sizeHint);
+	d.data = std::span{d.buf.data(), size};
 }
 
 } // namespace openmsx
@@ -1,19 +1,138 @@
 #include "ZipFileAdapter.hh"
 #include "ZlibInflate.hh"
 #include "FileException.hh"
+#include "FileOperations.hh"
+#include "LocalFile.hh"
+#include "StringOp.hh"
+
+#include "endian.hh"
+#include "ranges.hh"
+#include "strCat.hh"
+
+#include <bit>
 
 namespace openmsx {
 
-ZipFileAdapter::ZipFileAdapter(std::unique_ptr<FileBase> file_)
-	: CompressedFileAdapter(std::move(file_))
+static constexpr uint32_t LOCAL_HEADER_SIG   = 0x04034B50;
+static constexpr uint32_t CENTRAL_HEADER_SIG = 0x02014B50;
+static constexpr uint32_t END_OF_CENTRAL_SIG = 0x06054B50;
+static constexpr size_t LOCAL_HEADER_SIZE   = 30;
+static constexpr size_t CENTRAL_HEADER_SIZE = 46;
+static constexpr size_t END_OF_CENTRAL_SIZE = 22;
+
+ZipFileAdapter::ZipFileAdapter(std::unique_ptr<FileBase> file_, std::string member_)
+	: CompressedFileAdapter(std::move(file_), member_.empty() ? std::string{} : strCat('#', member_))
+	, member(std::move(member_))
 {
 }
 
-void ZipFileAdapter::decompress(FileBase& f, Decompressed& d)
+std::vector<ZipFileAdapter::Member> ZipFileAdapter::readCentralDirectory(std::span<const uint8_t> zip)
 {
-	ZlibInflate zlib(f.mmap());
+	// The 'end of central directory' record is at the end of the file,
+	// possibly followed by a comment of at most 64kB.
+	if (zip.size() < END_OF_CENTRAL_SIZE) {
+		throw FileException("Invalid ZIP file: too small");
+	}
+	size_t eocd = zip.size() - END_OF_CENTRAL_SIZE;
+	size_t lowest = (eocd > 0xFFFF) ? (eocd - 0xFFFF) : 0;
+	while (Endian::read_UA_L32(&zip[eocd]) != END_OF_CENTRAL_SIG) {
+		if (eocd == lowest) {
+			throw FileException("Invalid ZIP file: no central directory");
+		}
+		--eocd;
+	}
+	unsigned numEntries = Endian::read_UA_L16(&zip[eocd + 10]);
+	size_t cdSize       = Endian::read_UA_L32(&zip[eocd + 12]);
+	size_t cdOffset     = Endian::read_UA_L32(&zip[eocd + 16]);
+	if ((numEntries == 0xFFFF) || (cdOffset == 0xFFFF'FFFF)) {
+		throw FileException("Unsupported ZIP file: ZIP64");
+	}
+	if ((cdOffset + cdSize) > eocd) {
+		throw FileException("Invalid ZIP file: corrupt central directory");
+	}
+
+	std::vector<Member> result;
+	result.reserve(numEntries);
+	size_t p = cdOffset;
+	for (unsigned i = 0; i < numEntries; ++i) {
+		if (((p + CENTRAL_HEADER_SIZE) > eocd) ||
+		    (Endian::read_UA_L32(&zip[p]) != CENTRAL_HEADER_SIG)) {
+			throw FileException("Invalid ZIP file: corrupt central directory");
+		}
+		unsigned method         = Endian::read_UA_L16(&zip[p + 10]);
+		size_t compressedSize   = Endian::read_UA_L32(&zip[p + 20]);
+		size_t size             = Endian::read_UA_L32(&zip[p + 24]);
+		size_t nameLen          = Endian::read_UA_L16(&zip[p + 28]);
+		size_t extraLen         = Endian::read_UA_L16(&zip[p + 30]);
+		size_t commentLen       = Endian::read_UA_L16(&zip[p + 32]);
+		size_t localOffset      = Endian::read_UA_L32(&zip[p + 42]);
+		size_t next = p + CENTRAL_HEADER_SIZE + nameLen + extraLen + commentLen;
+		if (next > eocd) {
+			throw FileException("Invalid ZIP file: corrupt central directory");
+		}
+		std::string name(std::bit_cast<const char*>(&zip[p + CENTRAL_HEADER_SIZE]), nameLen);
+		if (!name.empty() && (name.back() != '/')) { // skip directories
+			result.push_back({std::move(name), localOffset, compressedSize, size, method});
+		}
+		p = next;
+	}
+	return result;
+}
+
+bool ZipFileAdapter::hasZipExtension(std::string_view filename)
+{
+	return StringOp::casecmp()(FileOperations::getExtension(filename), ".zip");
+}
+
+std::vector<std::string> ZipFileAdapter::getMemberNames(const std::string& filename)
+{
+	std::vector<std::string> result;
+	try {
+		LocalFile file(filename, File::NORMAL);
+		for (auto& m : readCentralDirectory(file.mmap())) {
+			result.push_back(std::move(m.name));
+		}
+	} catch (MSXException&) {
+		result.clear(); // not a (supported) ZIP file
+	}
+	return result;
+}
+
+// A '.zip' extension or a ZIP (local file) header.
+[[nodiscard]] static bool isZipArchive(const std::string& filename)
+{
+	if (!FileOperations::isRegularFile(filename)) return false;
+	if (ZipFileAdapter::hasZipExtension(filename)) return true;
+	auto f = FileOperations::openFile(filename, "rb");
+	if (!f) return false;
+	std::array<uint8_t, 4> buf;
+	return (fread(buf.data(), 1, buf.size(), f.get()) == buf.size()) &&
+	       (Endian::read_UA_L32(buf.data()) == LOCAL_HEADER_SIG);
+}
 
-	if (zlib.get32LE() != 0x04034B50) {
+std::optional<std::pair<std::string, std::string>>
+	ZipFileAdapter::splitMemberName(std::string_view filename)
+{
+	auto pos = filename.find('#');
+	if (pos == std::string_view::npos) return {};
+	if (FileOperations::exists(std::string(filename))) return {};
+	do {
+		std::string archive(filename.substr(0, pos));
+		if (isZipArchive(archive)) {
+			return std::pair{std::move(archive), std::string(filename.substr(pos + 1))};
+		}
+		pos = filename.find('#', pos + 1);
+	} while (pos != std::string_view::npos);
+	return {};
+}
+
+// Old style: only look at the first local file header. This still works for
+// (some) broken archives that lack a central directory.
+static void decompressFirstMember(std::span<const uint8_t> zip, CompressedFileAdapter::Decompressed& d)
+{
+	ZlibInflate zlib(zip);
+
+	if (zlib.get32LE() != LOCAL_HEADER_SIG) {
 		throw FileException("Invalid ZIP file");
 	}
 
@@ -35,7 +154,63 @@ void ZipFileAdapter::decompress(FileBase& f, Decompressed& d)
 	d.originalName = zlib.getString(filenameLen); // original filename
 	zlib.skip(extraFieldLen); // skip "extra field"
 
-	d.size = zlib.inflate(d.buf, origSize);
+	auto size = zlib.inflate(d.buf, origSize);
+	d.data = std::span{d.buf.data(), size};
+}
+
+void ZipFileAdapter::decompress(FileBase& f, Decompressed& d)
+{
+	auto zip = f.mmap();
+
+	std::vector<Member> members;
+	try {
+		members = readCentralDirectory(zip);
+	} catch (FileException&) {
+		if (!member.empty()) throw;
+		decompressFirstMember(zip, d);
+		return;
+	}
+
+	auto it = member.empty() ? members.begin()
+	                         : ranges::find(members, member, &Member::name);
+	if (it == members.end()) {
+		throw FileException(member.empty() ? std::string("Empty ZIP file")
+		                                   : strCat("No member '", member, "' in ZIP file"));
+	}
+	auto& m = *it;
+
+	// The local header may have a different 'extra field' length than the
+	// central directory entry, so parse it to find the start of the data.
+	if (((m.localHeaderOffset + LOCAL_HEADER_SIZE) > zip.size()) ||
+	    (Endian::read_UA_L32(&zip[m.localHeaderOffset]) != LOCAL_HEADER_SIG)) {
+		throw FileException("Invalid ZIP file: corrupt local header");
+	}
+	size_t nameLen  = Endian::read_UA_L16(&zip[m.localHeaderOffset + 26]);
+	size_t extraLen = Endian::read_UA_L16(&zip[m.localHeaderOffset + 28]);
+	size_t start = m.localHeaderOffset + LOCAL_HEADER_SIZE + nameLen + extraLen;
+	if ((start + m.compressedSize) > zip.size()) {
+		throw FileException("Invalid ZIP file: truncated member");
+	}
+	auto compressed = zip.subspan(start, m.compressedSize);
+	d.originalName = m.name;
+
+	switch (m.method) {
+	case 0: // stored: no need to copy, use the mmap()'ed archive directly
+		if (m.size != m.compressedSize) {
+			throw FileException("Invalid ZIP file: wrong size for stored member");
+		}
+		d.data = compressed;
+		d.keepFile = true;
+		break;
+	case 8: { // deflated
+		ZlibInflate zlib(compressed);
+		auto size = zlib.inflate(d.buf, m.size);
+		d.data = std::span{d.buf.data(), size};
+		break;
+	}
+	default:
+		throw FileException("Unsupported zip compression method");
+	}
 }
 
 } // namespace openmsx
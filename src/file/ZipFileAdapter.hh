@@ -3,15 +3,65 @@
 
 #include "CompressedFileAdapter.hh"
 
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 namespace openmsx {
 
+/** Access a member of a ZIP archive.
+  *
+  * A specific member can be selected with the syntax 'archive.zip#member'
+  * (see splitMemberName()), by default the first member is used. Members
+  * can be deflated (method 8) or stored (method 0), stored members are
+  * served directly from the mmap()'ed archive (without copying).
+  */
 class ZipFileAdapter final : public CompressedFileAdapter
 {
 public:
-	explicit ZipFileAdapter(std::unique_ptr<FileBase> file);
+	struct Member {
+		std::string name;
+		size_t localHeaderOffset;
+		size_t compressedSize;
+		size_t size;
+		unsigned method;
+	};
+
+	/** @param member Name of the member within the archive, empty for
+	  *        the first member. */
+	explicit ZipFileAdapter(std::unique_ptr<FileBase> file, std::string member = {});
+
+	/** Parse the central directory of a ZIP archive. Directory entries
+	  * are skipped.
+	  * @throws FileException when the central directory is missing or
+	  *         malformed (e.g. ZIP64 archives are not supported).
+	  */
+	[[nodiscard]] static std::vector<Member> readCentralDirectory(std::span<const uint8_t> zip);
+
+	/** Does the given filename have a '.zip' extension (case insensitive)? */
+	[[nodiscard]] static bool hasZipExtension(std::string_view filename);
+
+	/** Return the names of all (non-directory) members of the given ZIP
+	  * file, or an empty vector if it's not a (supported) ZIP file. */
+	[[nodiscard]] static std::vector<std::string> getMemberNames(const std::string& filename);
+
+	/** Split a name of the form 'archive.zip#member' into its two parts.
+	  * This is only done when 'filename' itself is not an existing file,
+	  * but the part in front of a '#' is, and that part has a '.zip'
+	  * extension or starts with a ZIP header.
+	  */
+	[[nodiscard]] static std::optional<std::pair<std::string, std::string>>
+		splitMemberName(std::string_view filename);
 
 private:
 	void decompress(FileBase& file, Decompressed& decompressed) override;
+
+private:
+	std::string member;
 };
 
 } // namespace openmsx
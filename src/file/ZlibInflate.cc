@@ -3,10 +3,36 @@
 #include "MemBuffer.hh"
 #include "narrow.hh"
 #include "xrange.hh"
+#include "components.hh"
+#include <algorithm>
 #include <limits>
+#include <memory>
+
+#if COMPONENT_FASTINFLATE
+#include <libdeflate.h>
+#endif
 
 namespace openmsx {
 
+#if COMPONENT_FASTINFLATE
+// Allocating a decompressor is relatively expensive, so keep one per thread
+// (files can be decompressed concurrently, e.g. by the filepool indexer).
+static libdeflate_decompressor* getDecompressor()
+{
+	struct Deleter {
+		void operator()(libdeflate_decompressor* d) const {
+			libdeflate_free_decompressor(d);
+		}
+	};
+	thread_local std::unique_ptr<libdeflate_decompressor, Deleter> decompressor(
+		libdeflate_alloc_decompressor());
+	if (!decompressor) {
+		throw FileException("Error initializing decompressor");
+	}
+	return decompressor.get();
+}
+#endif
+
 ZlibInflate::ZlibInflate(std::span<const uint8_t> input)
 {
 	if (input.size() > std::numeric_limits<decltype(s.avail_in)>::max()) {
@@ -80,6 +106,34 @@ std::string ZlibInflate::getCString()
 
 size_t ZlibInflate::inflate(MemBuffer<uint8_t>& output, size_t sizeHint)
 {
+	// Deflate can't compress better than about 1032:1, a larger hint
+	// (e.g. from a corrupt gzip trailer) must not cause a huge allocation.
+	static constexpr size_t MAX_RATIO = 1032;
+	size_t maxSize = (size_t(s.avail_in) + 1) * MAX_RATIO;
+	size_t outSize = std::clamp<size_t>(sizeHint, 1, maxSize);
+#if COMPONENT_FASTINFLATE
+	// libdeflate can't resume, when the output buffer turns out to be too
+	// small we have to start over (that's why a good 'sizeHint' matters).
+	auto* decompressor = getDecompressor();
+	while (true) {
+		output.resize(outSize);
+		size_t inUsed = 0;
+		size_t outUsed = 0;
+		auto result = libdeflate_deflate_decompress_ex(
+			decompressor, s.next_in, s.avail_in,
+			output.data(), outSize, &inUsed, &outUsed);
+		if (result == LIBDEFLATE_SUCCESS) {
+			s.next_in += inUsed;
+			s.avail_in -= static_cast<decltype(s.avail_in)>(inUsed);
+			output.resize(outUsed);
+			return outUsed;
+		}
+		if (result != LIBDEFLATE_INSUFFICIENT_SPACE) {
+			throw FileException("Error decompressing gzip: invalid data");
+		}
+		outSize *= 2; // double buffer size
+	}
+#else
 	if (int err = inflateInit2(&s, -MAX_WBITS);
 	    err != Z_OK) {
 		throw FileException(
@@ -87,7 +141,6 @@ size_t ZlibInflate::inflate(MemBuffer<uint8_t>& output, size_t sizeHint)
 	}
 	wasInit = true;
 
-	size_t outSize = sizeHint;
 	output.resize(outSize);
 	s.avail_out = uInt(outSize); // TODO overflow?
 	while (true) {
@@ -108,6 +161,24 @@ size_t ZlibInflate::inflate(MemBuffer<uint8_t>& output, size_t sizeHint)
 	// set actual size
 	output.resize(s.total_out);
 	return s.total_out;
+#endif
+}
+
+bool ZlibInflate::uncompress(std::span<const uint8_t> input, std::span<uint8_t> output)
+{
+#if COMPONENT_FASTINFLATE
+	size_t outUsed = 0;
+	return (libdeflate_zlib_decompress(
+			getDecompressor(), input.data(), input.size(),
+			output.data(), output.size(), &outUsed)
+		== LIBDEFLATE_SUCCESS) &&
+	       (outUsed == output.size());
+#else
+	auto dstLen = uLongf(output.size()); // TODO check for overflow?
+	return (::uncompress(output.data(), &dstLen, input.data(), uLong(input.size()))
+		== Z_OK) &&
+	       (dstLen == output.size());
+#endif
 }
 
 } // namespace openmsx
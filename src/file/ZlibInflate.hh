@@ -9,6 +9,12 @@
 
 namespace openmsx {
 
+/** Decompress deflate streams (as used in .gz and .zip files).
+  *
+  * The complete input must be available in memory. When openMSX is built
+  * with libdeflate (COMPONENT_FASTINFLATE), the actual decompression is
+  * done by that library in one go, otherwise zlib is used.
+  */
 class ZlibInflate
 {
 public:
@@ -26,8 +32,22 @@ public:
 	[[nodiscard]] std::string getString(size_t len);
 	[[nodiscard]] std::string getCString();
 
+	/** Decompress the (raw deflate) data that remains in the input.
+	  * @param sizeHint The expected size of the output. The closer to the
+	  *        actual size, the fewer reallocations are needed. It's
+	  *        often read from the (untrusted) input, so it's limited to
+	  *        what the remaining input could possibly decompress to.
+	  * @return The actual output size.
+	  */
 	[[nodiscard]] size_t inflate(MemBuffer<uint8_t>& output, size_t sizeHint = 65536);
 
+	/** Decompress a zlib stream (as produced by zlib's compress()) of
+	  * which the uncompressed size is exactly known.
+	  * @return true iff successful and the decompressed data exactly filled
+	  *         the output buffer.
+	  */
+	[[nodiscard]] static bool uncompress(std::span<const uint8_t> input, std::span<uint8_t> output);
+
 private:
 	z_stream s;
 	bool wasInit;
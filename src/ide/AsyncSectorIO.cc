@@ -0,0 +1,121 @@
+#include "AsyncSectorIO.hh"
+#include "File.hh"
+#include "MSXException.hh"
+
+#include "ranges.hh"
+
+#include <algorithm>
+#include <utility>
+
+namespace openmsx {
+
+AsyncSectorIO::AsyncSectorIO(File& file_, size_t nbSectors_)
+	: file(file_), nbSectors(nbSectors_)
+{
+}
+
+AsyncSectorIO::~AsyncSectorIO()
+{
+	try {
+		sync();
+	} catch (MSXException&) {
+		// ignore, nothing we can do about it anymore
+	}
+}
+
+void AsyncSectorIO::read(std::span<SectorBuffer> buffers, size_t startSector)
+{
+	auto num = buffers.size();
+	auto end = startSector + num;
+	bool sequential = startSector == nextSequential;
+	nextSequential = end;
+
+	bool done = false;
+	if (window && (window->start <= startSector) &&
+	    (end <= (window->start + window->data->bufs.size()))) {
+		window->done.wait();
+		if (window->data->ok) {
+			ranges::copy(std::span{window->data->bufs}.subspan(startSector - window->start, num),
+			             buffers);
+			done = true;
+		} else {
+			window.reset(); // e.g. read error, retry below to report it
+		}
+	}
+	if (!done) {
+		// This job runs after all pending writes, so it sees their data.
+		worker.enqueue([&] {
+			file.seek(startSector * sizeof(SectorBuffer));
+			file.read(buffers);
+		}).get(); // rethrows a possible exception
+	}
+
+	// Stay ahead of sequential reads: refill when less than half of the
+	// read-ahead window remains.
+	if (sequential &&
+	    (!window || ((window->start + window->data->bufs.size()) < (end + READ_AHEAD / 2)))) {
+		startReadAhead(end);
+	}
+}
+
+void AsyncSectorIO::startReadAhead(size_t startSector)
+{
+	if (startSector >= nbSectors) return;
+	auto data = std::make_shared<Window::Data>();
+	data->bufs.resize(std::min(READ_AHEAD, nbSectors - startSector));
+	auto done = worker.enqueue([this, data, startSector] {
+		try {
+			file.seek(startSector * sizeof(SectorBuffer));
+			file.read(std::span{data->bufs});
+			data->ok = true;
+		} catch (MSXException&) {
+			// ignore, the read will be repeated synchronously
+		}
+	});
+	window = Window{startSector, std::move(data), std::move(done)};
+}
+
+void AsyncSectorIO::write(size_t sector, const SectorBuffer& buf)
+{
+	checkWriteError();
+
+	// The read-ahead data (possibly still being read) becomes stale.
+	if (window && (window->start <= sector) &&
+	    (sector < (window->start + window->data->bufs.size()))) {
+		window.reset(); // the job keeps its own reference to the buffer
+	}
+
+	worker.enqueue([this, sector, buf] {
+		try {
+			file.seek(sector * sizeof(SectorBuffer));
+			file.write(buf.raw);
+		} catch (MSXException&) {
+			std::scoped_lock lock(mutex);
+			if (!writeError) writeError = std::current_exception();
+		}
+	});
+}
+
+void AsyncSectorIO::sync()
+{
+	waitIdle();
+	file.flush();
+	checkWriteError();
+}
+
+void AsyncSectorIO::waitIdle()
+{
+	worker.enqueue([] { /* nothing */ }).get();
+}
+
+void AsyncSectorIO::checkWriteError()
+{
+	std::exception_ptr error;
+	{
+		std::scoped_lock lock(mutex);
+		error = std::exchange(writeError, nullptr);
+	}
+	if (error) std::rethrow_exception(error);
+}
+
+} // namespace openmsx
@@ -0,0 +1,90 @@
+#ifndef ASYNCSECTORIO_HH
+#define ASYNCSECTORIO_HH
+
+#include "DiskImageUtils.hh"
+#include "ThreadPool.hh"
+
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace openmsx {
+
+class File;
+
+/** Sector based access to a (hard disk) image file, where the actual file
+  * I/O happens on a background thread.
+  *
+  * - Writes are queued and the call returns immediately (write-back). The
+  *   queued writes are executed in order. An error during a background
+  *   write is reported by the next call to write() or sync().
+  * - When sequential reads are detected, the following sectors are already
+  *   read in the background (read-ahead), so that subsequent reads can be
+  *   served from memory.
+  * - Reads always block until the requested data is available, so from the
+  *   point of view of the emulated machine nothing changes (the emulated
+  *   timing stays deterministic), only the host spends less time waiting.
+  *
+  * While an object of this class exists, the file should not be accessed
+  * directly, except right after a call to sync().
+  */
+class AsyncSectorIO
+{
+public:
+	/** Number of sectors that are read ahead (128kB). */
+	static constexpr size_t READ_AHEAD = 256;
+
+	AsyncSectorIO(File& file, size_t nbSectors);
+	AsyncSectorIO(const AsyncSectorIO&) = delete;
+	AsyncSectorIO(AsyncSectorIO&&) = delete;
+	AsyncSectorIO& operator=(const AsyncSectorIO&) = delete;
+	AsyncSectorIO& operator=(AsyncSectorIO&&) = delete;
+
+	/** Finishes all pending writes (errors are ignored). */
+	~AsyncSectorIO();
+
+	/** @throws MSXException */
+	void read(std::span<SectorBuffer> buffers, size_t startSector);
+
+	/** @throws MSXException when a previous (background) write failed. */
+	void write(size_t sector, const SectorBuffer& buf);
+
+	/** Wait until all pending writes are done and flush them to the file.
+	  * @throws MSXException when one of those writes failed.
+	  */
+	void sync();
+
+private:
+	void waitIdle();
+	void checkWriteError();
+	void startReadAhead(size_t startSector);
+
+private:
+	File& file;
+	const size_t nbSectors;
+
+	struct Window {
+		struct Data {
+			std::vector<SectorBuffer> bufs;
+			bool ok = false;
+		};
+		size_t start;
+		std::shared_ptr<Data> data; // shared with the background job
+		std::future<void> done;
+	};
+	std::optional<Window> window;
+	size_t nextSequential = size_t(-1);
+
+	std::mutex mutex; // protects 'writeError'
+	std::exception_ptr writeError;
+
+	ThreadPool worker{1}; // single thread, so the jobs run in order
+};
+
+} // namespace openmsx
+
+#endif
@@ -46,13 +46,17 @@ HD::HD(const DeviceConfig& config)
 	// (resolved) filename. For user-specified hd images (command line or
 	// via hda command) savestate will try to re-resolve the filename.
 	auto mode = File::NORMAL;
-	if (string cliImage = HDImageCLI::getImageForId(id);
-	    cliImage.empty()) {
+	if (auto cli = HDImageCLI::getImageForId(id);
+	    cli.filename.empty()) {
 		const auto& original = config.getChildData("filename");
 		filename = Filename(config.getFileContext().resolveCreate(original));
 		mode = File::CREATE;
 	} else {
-		filename = Filename(std::move(cliImage), userFileContext());
+		filename = Filename(std::move(cli.filename), userFileContext());
+		if (cli.overlay) {
+			overlay = cli.overlay->empty() ? SectorOverlay()
+			                               : SectorOverlay(*cli.overlay);
+		}
 	}
 
 	file = File(filename, mode);
@@ -63,6 +67,7 @@ HD::HD(const DeviceConfig& config)
 		file.truncate(size_t(config.getChildDataAsInt("size", 0)) * 1024 * 1024);
 		filesize = file.getSize();
 	}
+	io.emplace(file, getNbSectorsImpl());
 	tigerTree.emplace(*this, filesize, filename.getResolved());
 
 	(*hdInUse)[id] = true;
@@ -79,6 +84,15 @@ HD::HD(const DeviceConfig& config)
 
 HD::~HD()
 {
+	try {
+		syncWrites();
+	} catch (MSXException& e) {
+		motherBoard.getMSXCliComm().printWarning(
+			"Error writing to hard disk image ",
+			filename.getResolved(), ": ", e.getMessage());
+	}
+	io.reset();
+
 	motherBoard.unregisterMediaInfo(*this);
 	motherBoard.getMSXCliComm().update(CliComm::HARDWARE, name, "remove");
 
@@ -93,11 +107,17 @@ void HD::getMediaInfo(TclObject& result)
 	                        "readonly", isWriteProtected());
 }
 
-void HD::switchImage(const Filename& newFilename)
+void HD::switchImage(const Filename& newFilename,
+                     std::optional<SectorOverlay> newOverlay)
 {
-	file = File(newFilename);
+	File newFile(newFilename);
+	syncWrites();
+	io.reset();
+	file = std::move(newFile);
 	filename = newFilename;
+	overlay = std::move(newOverlay);
 	filesize = file.getSize();
+	io.emplace(file, getNbSectorsImpl());
 	tigerTree.emplace(*this, filesize, filename.getResolved());
 	motherBoard.getMSXCliComm().update(CliComm::MEDIA, getName(),
 	                                   filename.getResolved());
@@ -111,31 +131,65 @@ size_t HD::getNbSectorsImpl() const
 void HD::readSectorsImpl(
 	std::span<SectorBuffer> buffers, size_t startSector)
 {
-	file.seek(startSector * sizeof(SectorBuffer));
-	file.read(buffers);
+	readImage(buffers, startSector);
+	if (overlay) overlay->read(buffers, startSector);
+}
+
+void HD::readImage(std::span<SectorBuffer> buffers, size_t startSector)
+{
+	if (io) {
+		io->read(buffers, startSector);
+	} else {
+		file.seek(startSector * sizeof(SectorBuffer)); // throws, file is closed
+		file.read(buffers);
+	}
 }
 
 void HD::writeSectorImpl(size_t sector, const SectorBuffer& buf)
 {
-	file.seek(sector * sizeof(buf));
-	file.write(buf.raw);
-	tigerTree->notifyChange(sector * sizeof(buf), sizeof(buf),
-	                        file.getModificationDate());
+	if (overlay) {
+		// the image itself (and thus its tiger-tree-hash) doesn't change
+		overlay->write(sector, buf);
+		return;
+	}
+	// A background write only changes the file (and its modification time)
+	// later, and meanwhile the file shouldn't be accessed directly. So use a
+	// time that never matches, syncWrites() sets the actual time.
+	time_t time = 0;
+	if (io) {
+		io->write(sector, buf);
+	} else {
+		file.seek(sector * sizeof(buf)); // throws, file is closed
+		file.write(buf.raw);
+		time = file.getModificationDate();
+	}
+	tigerTree->notifyChange(sector * sizeof(buf), sizeof(buf), time);
 }
 
 bool HD::isWriteProtectedImpl() const
 {
-	return file.isReadOnly();
+	return !overlay && file.isReadOnly();
 }
 
 Sha1Sum HD::getSha1SumImpl(FilePool& filePool)
 {
-	if (hasPatches()) {
+	if (hasPatches() || (overlay && !overlay->empty())) {
 		return SectorAccessibleDisk::getSha1SumImpl(filePool);
 	}
+	syncWrites();
 	return filePool.getSha1Sum(file);
 }
 
+// Wait for the pending (background) writes. Only now the modification time
+// of the file is final, so also update the time in the tiger-tree-hash cache
+// (writeSectorImpl() couldn't do that).
+void HD::syncWrites()
+{
+	if (!io) return;
+	io->sync();
+	tigerTree->notifyChange(0, 0, file.getModificationDate());
+}
+
 void HD::showProgress(size_t position, size_t maxPosition)
 {
 	// only show progress iff:
@@ -178,7 +232,13 @@ uint8_t* HD::getData(size_t offset, size_t size)
 
 	size_t sector = offset / sizeof(SectorBuffer);
 	size_t num    = size   / sizeof(SectorBuffer);
-	readSectors(std::span{work.bufs.data(), num}, sector); // This possibly applies IPS patches.
+	if (overlay) {
+		// Only hash the (shared) image, the overlay itself is stored in
+		// the savestate. So the cached hash of the image remains valid.
+		readImage(std::span{work.bufs.data(), num}, sector);
+	} else {
+		readSectors(std::span{work.bufs.data(), num}, sector); // This possibly applies IPS patches.
+	}
 	return work.bufs[0].raw.data();
 }
 
@@ -217,6 +277,7 @@ int HD::insertDisk(const std::string& newFilename)
 
 // version 1: initial version
 // version 2: replaced 'checksum'(=sha1) with 'tthsum`
+// version 3: added copy-on-write overlay
 template<typename Archive>
 void HD::serialize(Archive& ar, unsigned version)
 {
@@ -240,6 +301,7 @@ void HD::serialize(Archive& ar, unsigned version)
 			//  - So to get in the same state as the initial
 			//    savestate we again close the file. Otherwise the
 			//    checksum-check code below goes wrong.
+			io.reset();
 			file.close();
 		} else {
 			tmp.updateAfterLoadState();
@@ -248,6 +310,16 @@ void HD::serialize(Archive& ar, unsigned version)
 		}
 	}
 
+	if (ar.versionAtLeast(version, 3)) {
+		bool withOverlay = overlay.has_value();
+		ar.serialize("overlay", withOverlay);
+		if constexpr (Archive::IS_LOADER) {
+			overlay.reset();
+			if (withOverlay) overlay.emplace();
+		}
+		if (overlay) ar.serialize("overlayData", *overlay);
+	}
+
 	// store/check checksum
 	if (file.is_open()) {
 		bool mismatch = false;
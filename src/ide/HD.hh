@@ -1,11 +1,13 @@
 #ifndef HD_HH
 #define HD_HH
 
+#include "AsyncSectorIO.hh"
 #include "DiskContainer.hh"
 #include "File.hh"
 #include "Filename.hh"
 #include "HDCommand.hh"
 #include "SectorAccessibleDisk.hh"
+#include "SectorOverlay.hh"
 #include "MSXMotherBoard.hh"
 #include "TigerTree.hh"
 #include "serialize_meta.hh"
@@ -31,7 +33,11 @@ public:
 
 	[[nodiscard]] const std::string& getName() const { return name; }
 	[[nodiscard]] const Filename& getImageName() const { return filename; }
-	void switchImage(const Filename& filename);
+	/** @param overlay When given, writes go to this overlay instead of
+	  *        to the image file. */
+	void switchImage(const Filename& filename,
+	                 std::optional<SectorOverlay> overlay = {});
+	[[nodiscard]] bool hasOverlay() const { return overlay.has_value(); }
 
 	[[nodiscard]] std::string getTigerTreeHash();
 
@@ -62,7 +68,9 @@ private:
 	[[nodiscard]] uint8_t* getData(size_t offset, size_t size) override;
 	[[nodiscard]] bool isCacheStillValid(time_t& time) override;
 
+	void readImage(std::span<SectorBuffer> buffers, size_t startSector);
 	void showProgress(size_t position, size_t maxPosition);
+	void syncWrites();
 
 private:
 	MSXMotherBoard& motherBoard;
@@ -73,6 +81,8 @@ private:
 	File file;
 	Filename filename;
 	size_t filesize;
+	std::optional<AsyncSectorIO> io; // must be destroyed before 'file'
+	std::optional<SectorOverlay> overlay;
 
 	std::shared_ptr<HDInUse> hdInUse;
 
@@ -81,7 +91,7 @@ private:
 };
 
 REGISTER_BASE_CLASS(HD, "HD");
-SERIALIZE_CLASS_VERSION(HD, 2);
+SERIALIZE_CLASS_VERSION(HD, 3);
 
 } // namespace openmsx
 
@@ -2,10 +2,13 @@
 #include "HD.hh"
 #include "FileContext.hh"
 #include "FileException.hh"
+#include "FileOperations.hh"
 #include "CommandException.hh"
 #include "BooleanSetting.hh"
 #include "TclObject.hh"
+#include "strCat.hh"
 #include <array>
+#include <optional>
 
 namespace openmsx {
 
@@ -29,18 +32,23 @@ void HDCommand::execute(std::span<const TclObject> tokens, TclObject& result,
 		result.addListElement(tmpStrCat(hd.getName(), ':'),
 		                      hd.getImageName().getResolved());
 
+		TclObject options;
 		if (hd.isWriteProtected()) {
-			TclObject options = makeTclList("readonly");
+			options.addListElement("readonly");
+		}
+		if (hd.hasOverlay()) {
+			options.addListElement("overlay");
+		}
+		if (options.getListLength(getInterpreter()) != 0) {
 			result.addListElement(options);
 		}
-	} else if ((tokens.size() == 2) ||
-	           ((tokens.size() == 3) && tokens[1] == "insert")) {
+	} else {
 		if (powerSetting.getBoolean()) {
 			throw CommandException(
 				"Can only change hard disk image when MSX "
 				"is powered down.");
 		}
-		int fileToken = 1;
+		size_t fileToken = 1;
 		if (tokens[1] == "insert") {
 			if (tokens.size() > 2) {
 				fileToken = 2;
@@ -50,9 +58,20 @@ void HDCommand::execute(std::span<const TclObject> tokens, TclObject& result,
 			}
 		}
 		try {
+			std::optional<SectorOverlay> overlay;
+			for (size_t i = fileToken + 1; i < tokens.size(); ++i) { // 'i' changes in loop
+				std::string_view option = tokens[i].getString();
+				if (!overlay && (option == "-overlay")) {
+					overlay.emplace();
+				} else if (!overlay && (option == "-delta") && (++i < tokens.size())) {
+					overlay.emplace(FileOperations::expandTilde(std::string(tokens[i].getString())));
+				} else {
+					throw CommandException("Too many or wrong arguments.");
+				}
+			}
 			Filename filename(tokens[fileToken].getString(),
 			                  userFileContext());
-			hd.switchImage(filename);
+			hd.switchImage(filename, std::move(overlay));
 			// Note: the diskX command doesn't do this either,
 			// so this has not been converted to TclObject style here
 			// return filename;
@@ -60,14 +79,16 @@ void HDCommand::execute(std::span<const TclObject> tokens, TclObject& result,
 			throw CommandException("Can't change hard disk image: ",
 			                       e.getMessage());
 		}
-	} else {
-		throw CommandException("Too many or wrong arguments.");
 	}
 }
 
 std::string HDCommand::help(std::span<const TclObject> /*tokens*/) const
 {
-	return hd.getName() + ": change the hard disk image for this hard disk drive\n";
+	return strCat(
+		hd.getName(), ": change the hard disk image for this hard disk drive\n"
+		"The following options are supported when inserting an image:\n"
+		"-overlay        : don't modify the image, keep the changes in memory\n"
+		"-delta <file>   : don't modify the image, keep the changes in the given file");
 }
 
 void HDCommand::tabCompletion(std::vector<std::string>& tokens) const
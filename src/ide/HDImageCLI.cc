@@ -9,11 +9,11 @@ namespace openmsx {
 
 namespace {
 	struct IdImage {
-		IdImage(int i, std::string m)
+		IdImage(int i, HDImageCLI::Image m)
 			: id(i), image(std::move(m)) {} // clang-15 workaround
 
 		int id;
-		std::string image;
+		HDImageCLI::Image image;
 	};
 }
 static std::vector<IdImage> images;
@@ -29,14 +29,22 @@ void HDImageCLI::parseOption(const std::string& option, std::span<std::string>&
 {
 	// Machine has not been loaded yet. Only remember the image.
 	int id = option[3] - 'a';
-	images.emplace_back(id, getArgument(option, cmdLine));
+	Image image{getArgument(option, cmdLine), {}};
+	if (peekArgument(cmdLine) == "-overlay") {
+		cmdLine = cmdLine.subspan(1);
+		image.overlay.emplace();
+	} else if (peekArgument(cmdLine) == "-delta") {
+		cmdLine = cmdLine.subspan(1);
+		image.overlay = getArgument("-delta", cmdLine);
+	}
+	images.emplace_back(id, std::move(image));
 }
 
-std::string HDImageCLI::getImageForId(int id)
+HDImageCLI::Image HDImageCLI::getImageForId(int id)
 {
 	// HD queries image. Return (and clear) the remembered value, or return
-	// an empty string.
-	std::string result;
+	// an empty filename.
+	Image result;
 	if (auto it = ranges::find(images, id, &IdImage::id);
 	    it != end(images)) {
 		result = std::move(it->image);
@@ -57,7 +65,9 @@ void HDImageCLI::parseDone()
 
 std::string_view HDImageCLI::optionHelp() const
 {
-	return "Use hard disk image in argument for the IDE or SCSI extensions";
+	return "Use hard disk image in argument for the IDE or SCSI extensions "
+	       "(optionally followed by -overlay or -delta <file>, to not "
+	       "modify the image itself)";
 }
 
 } // namespace openmsx
@@ -2,6 +2,8 @@
 #define HDIMAGECLI_HH
 
 #include "CLIOption.hh"
+#include <optional>
+#include <string>
 
 namespace openmsx {
 
@@ -16,7 +18,13 @@ public:
 	void parseDone() override;
 	[[nodiscard]] std::string_view optionHelp() const override;
 
-	[[nodiscard]] static std::string getImageForId(int id);
+	struct Image {
+		std::string filename;
+		// nullopt: no overlay, empty: overlay in memory,
+		// otherwise: overlay in this delta file
+		std::optional<std::string> overlay;
+	};
+	[[nodiscard]] static Image getImageForId(int id);
 
 private:
 	CommandLineParser& parser;
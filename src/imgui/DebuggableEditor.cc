@@ -332,6 +332,11 @@ void DebuggableEditor::drawContents(const Sizes& s, Debuggable& debuggable, unsi
 		auto addr = unsigned(line) * columns;
 		ImGui::StrCat(formatAddr(s, addr), ':');
 
+		// fetch the content of this line at once
+		std::array<uint8_t, MAX_COLUMNS> lineData;
+		auto lineSize = std::min(unsigned(columns), memSize - addr);
+		debuggable.readBlock(addr, std::span{lineData.data(), lineSize});
+
 		auto previewDataTypeSize = DataTypeGetSize(previewDataType);
 		auto inside = [](unsigned a, unsigned start, unsigned size) {
 			return (start <= a) && (a < (start + size));
@@ -390,7 +395,7 @@ void DebuggableEditor::drawContents(const Sizes& s, Debuggable& debuggable, unsi
 					},
 					ImGuiInputTextFlags_CharsHexadecimal);
 			} else {
-				uint8_t b = debuggable.read(addr);
+				uint8_t b = lineData[n];
 				im::StyleColor(b == 0 && greyOutZeroes, ImGuiCol_Text, getColor(imColor::TEXT_DISABLED), [&]{
 					ImGui::StrCat(formatData(b), ' ');
 				});
@@ -440,7 +445,7 @@ void DebuggableEditor::drawContents(const Sizes& s, Debuggable& debuggable, unsi
 							return b;
 						});
 				} else {
-					uint8_t c = debuggable.read(addr);
+					uint8_t c = lineData[n];
 					char display = formatAsciiData(c);
 					im::StyleColor(display != char(c), ImGuiCol_Text, getColor(imColor::TEXT_DISABLED), [&]{
 						ImGui::TextUnformatted(&display, &display + 1);
@@ -4,27 +4,39 @@
 #include "ImGuiManager.hh"
 #include "ImGuiUtils.hh"
 
+#include "Debugger.hh"
+#include "MSXException.hh"
+#include "MSXMotherBoard.hh"
+
 #include "narrow.hh"
+#include "ranges.hh"
 #include "stl.hh"
 #include "view.hh"
 
+#include <optional>
+
 namespace openmsx {
 
 using namespace std::literals;
 
-void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
+// Showing more results isn't useful (and would be slow).
+static constexpr size_t MAX_RESULTS = 10000;
+
+void ImGuiCheatFinder::paint(MSXMotherBoard* motherBoard)
 {
-	if (!show) return;
+	if (!show || !motherBoard) return;
+	auto& memorySearch = motherBoard->getMemorySearch();
 
 	bool start = false;
-	std::string searchExpr;
+	std::optional<MemorySearch::Compare> compare;
+	std::optional<int> compareValue;
 
 	ImGui::SetNextWindowSize(gl::vec2{35, 0} * ImGui::GetFontSize(), ImGuiCond_FirstUseEver);
 	im::Window("Cheat Finder", &show, [&]{
 		const auto& style = ImGui::GetStyle();
 		auto tSize = ImGui::CalcTextSize("=="sv).x + 2.0f * style.FramePadding.x;
 		auto bSpacing = 2.0f;
-		auto height = 12.5f * ImGui::GetTextLineHeightWithSpacing();
+		auto height = 17.5f * ImGui::GetTextLineHeightWithSpacing();
 		auto sWidth = 2.0f * (style.WindowBorderSize + style.WindowPadding.x)
 		              + style.IndentSpacing + 6 * tSize + 5 * bSpacing;
 		im::Child("search", {sWidth, height}, ImGuiChildFlags_Border, [&]{
@@ -34,44 +46,65 @@ void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
 			           "  http://www.youtube.com/watch?v=F11ltfkCtKo\n"
 			           "The UI has changed, but the ideas remain the same.");
 			im::Disabled(searchResults.empty(), [&]{
+				using enum MemorySearch::Compare;
 				ImGui::TextUnformatted("Compare"sv);
 				im::Indent([&]{
 					auto bSize = ImVec2{tSize, 0.0f};
-					if (ImGui::Button("<",  bSize)) searchExpr = "$new < $old";
+					if (ImGui::Button("<",  bSize)) compare = LESS;
 					simpleToolTip("Search for memory locations with strictly decreased value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button("<=", bSize)) searchExpr = "$new <= $old";
+					if (ImGui::Button("<=", bSize)) compare = LESS_EQUAL;
 					simpleToolTip("Search for memory locations with decreased value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button("!=", bSize)) searchExpr = "$new != $old";
+					if (ImGui::Button("!=", bSize)) compare = NOT_EQUAL;
 					simpleToolTip("Search for memory locations with changed value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button("==", bSize)) searchExpr = "$new == $old";
+					if (ImGui::Button("==", bSize)) compare = EQUAL;
 					simpleToolTip("Search for memory locations with unchanged value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button(">=", bSize)) searchExpr = "$new >= $old";
+					if (ImGui::Button(">=", bSize)) compare = GREATER_EQUAL;
 					simpleToolTip("Search for memory locations with increased value");
 					ImGui::SameLine(0.0f, bSpacing);
-					if (ImGui::Button(">",  bSize)) searchExpr = "$new > $old";
+					if (ImGui::Button(">",  bSize)) compare = GREATER;
 					simpleToolTip("Search for memory locations with strictly increased value");
 				});
 				ImGui::TextUnformatted("Specific value"sv);
 				im::Indent([&]{
-					ImGui::SetNextItemWidth(3 * ImGui::GetFontSize());
-					ImGui::InputScalar("##value", ImGuiDataType_U8, &searchValue);
+					ImGui::SetNextItemWidth(4 * ImGui::GetFontSize());
+					ImGui::InputScalar("##value", ImGuiDataType_S32, &searchValue);
 					ImGui::SameLine();
 					if (ImGui::Button("Go")) {
-						searchExpr = strCat("$new == ", searchValue);
+						compare = EQUAL;
+						compareValue = searchValue;
 					}
 					simpleToolTip("Search for memory locations with a specific value");
 				});
 			});
+			ImGui::Separator();
+			ImGui::TextUnformatted("Search in"sv);
+			im::Indent([&]{
+				ImGui::SetNextItemWidth(-FLT_MIN);
+				im::Combo("##debuggable", searchDebuggable.c_str(), [&]{
+					auto names = to_vector<std::string>(view::keys(motherBoard->getDebugger().getDebuggables()));
+					ranges::sort(names);
+					for (const auto& name : names) {
+						if (ImGui::Selectable(name.c_str(), name == searchDebuggable)) {
+							searchDebuggable = name;
+						}
+					}
+				});
+				ImGui::Checkbox("16-bit", &searchWord);
+				simpleToolTip("Search for 16-bit (little endian) instead of 8-bit values");
+				ImGui::SameLine();
+				ImGui::Checkbox("signed", &searchSigned);
+			});
 			start |= ImGui::Button("Restart search");
+			simpleToolTip("The settings above only take effect when (re)starting a search");
 		});
 
 		ImGui::SameLine();
 		im::Child("result", {0.0f, height}, ImGuiChildFlags_Border, [&]{
-			auto num = searchResults.size();
+			auto num = searchResults.empty() ? 0 : memorySearch.getNumCandidates();
 			if (num == 0) {
 				ImGui::TextUnformatted("Results: no remaining locations"sv);
 				start |= ImGui::Button("Start a new search");
@@ -81,6 +114,10 @@ void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
 				} else {
 					ImGui::Text("Results: %d remaining locations", narrow<int>(num));
 				}
+				if (searchResults.size() < num) {
+					ImGui::SameLine();
+					ImGui::Text("(showing the first %d)", narrow<int>(searchResults.size()));
+				}
 				int flags = ImGuiTableFlags_RowBg |
 				            ImGuiTableFlags_BordersV |
 				            ImGuiTableFlags_BordersOuter |
@@ -92,7 +129,8 @@ void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
 					ImGui::TableSetupColumn("New value");
 					ImGui::TableHeadersRow();
 
-					for (const auto& row : searchResults) {
+					im::ListClipper(searchResults.size(), [&](int i) {
+						const auto& row = searchResults[i];
 						if (ImGui::TableNextColumn()) { // addr
 							ImGui::Text("0x%04x", row.address);
 						}
@@ -102,27 +140,23 @@ void ImGuiCheatFinder::paint(MSXMotherBoard* /*motherBoard*/)
 						if (ImGui::TableNextColumn()) { // new
 							ImGui::Text("%d", row.newValue);
 						}
-					}
+					});
 				});
 			}
 		});
 	});
 
-	if (start) {
-		manager.execute(TclObject("cheat_finder::start"));
-		searchExpr = "1"; // could be optimized, but good enough
-	}
-	if (!searchExpr.empty()) {
-		auto result = manager.execute(makeTclList("cheat_finder::search", searchExpr)).value_or(TclObject{});
-		searchResults = to_vector(view::transform(xrange(result.size()), [&](size_t i) {
-			auto line = result.getListIndexUnchecked(narrow<unsigned>(i));
-			auto addr     = line.getListIndexUnchecked(0).getOptionalInt().value_or(0);
-			auto oldValue = line.getListIndexUnchecked(1).getOptionalInt().value_or(0);
-			auto newValue = line.getListIndexUnchecked(2).getOptionalInt().value_or(0);
-			return SearchResult{narrow_cast<uint16_t>(addr),
-			                    narrow_cast<uint8_t>(oldValue),
-			                    narrow_cast<uint8_t>(newValue)};
-		}));
+	if (!start && !compare) return;
+	try {
+		if (start) {
+			memorySearch.start(searchDebuggable, searchWord, searchSigned);
+		} else {
+			memorySearch.search(*compare, compareValue);
+		}
+		searchResults = memorySearch.getResults(MAX_RESULTS);
+	} catch (MSXException& e) {
+		manager.printError("Cheat finder: ", e.getMessage());
+		searchResults.clear();
 	}
 }
 
@@ -3,7 +3,9 @@
 
 #include "ImGuiPart.hh"
 
-#include <cstdint>
+#include "MemorySearch.hh"
+
+#include <string>
 #include <vector>
 
 namespace openmsx {
@@ -19,13 +21,11 @@ public:
 	bool show = false;
 
 private:
-	struct SearchResult {
-		uint16_t address;
-		uint8_t oldValue;
-		uint8_t newValue;
-	};
-	std::vector<SearchResult> searchResults;
-	uint8_t searchValue = 0;
+	std::vector<MemorySearch::Result> searchResults;
+	int searchValue = 0;
+	std::string searchDebuggable = "memory";
+	bool searchWord = false; // 16-bit values
+	bool searchSigned = false;
 };
 
 } // namespace openmsx
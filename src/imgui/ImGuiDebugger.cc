@@ -158,6 +158,8 @@ void ImGuiDebugger::showMenu(MSXMotherBoard* motherBoard)
 		ImGui::MenuItem("CPU flags", nullptr, &showFlags);
 		ImGui::MenuItem("Slots", nullptr, &showSlots);
 		ImGui::MenuItem("Stack", nullptr, &showStack);
+		ImGui::MenuItem("Profiler", nullptr, &showProfiler);
+		ImGui::MenuItem("Access heatmap", nullptr, &showAccessHeatmap);
 		auto it = ranges::lower_bound(hexEditors, "memory", {}, &DebuggableEditor::getDebuggableName);
 		bool memoryOpen = (it != hexEditors.end()) && (*it)->open;
 		if (ImGui::MenuItem("Memory", nullptr, &memoryOpen)) {
@@ -206,6 +208,8 @@ void ImGuiDebugger::paint(MSXMotherBoard* motherBoard)
 	drawStack(regs, cpuInterface, time);
 	drawRegisters(regs);
 	drawFlags(regs);
+	drawProfiler(motherBoard->getSamplingProfiler());
+	drawAccessHeatmap(motherBoard->getAccessStats());
 }
 
 void ImGuiDebugger::drawControl(MSXCPUInterface& cpuInterface)
@@ -367,6 +371,7 @@ void ImGuiDebugger::drawDisassembly(CPURegs& regs, MSXCPUInterface& cpuInterface
 		std::optional<BreakPoint> addBp;
 		std::optional<unsigned> removeBpId;
 
+		dasmCache.update(cpuInterface, time);
 		auto pc = regs.getPC();
 		if (followPC && !MSXCPUInterface::isBreaked()) {
 			gotoTarget = pc;
@@ -402,7 +407,7 @@ void ImGuiDebugger::drawDisassembly(CPURegs& regs, MSXCPUInterface& cpuInterface
 			}
 			std::optional<unsigned> nextGotoTarget;
 			while (clipper.Step()) {
-				auto addr16 = instructionBoundary(cpuInterface, narrow<uint16_t>(clipper.DisplayStart), time);
+				auto addr16 = dasmCache.instructionBoundary(narrow<uint16_t>(clipper.DisplayStart));
 				for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
 					unsigned addr = addr16;
 					ImGui::TableNextRow();
@@ -483,7 +488,7 @@ void ImGuiDebugger::drawDisassembly(CPURegs& regs, MSXCPUInterface& cpuInterface
 						mnemonic.clear();
 						std::optional<uint16_t> mnemonicAddr;
 						std::span<const Symbol* const> mnemonicLabels;
-						auto len = dasm(cpuInterface, addr16, opcodes, mnemonic, time,
+						auto len = dasmCache.dasm(addr16, opcodes, mnemonic,
 							[&](std::string& output, uint16_t a) {
 								mnemonicAddr = a;
 								mnemonicLabels = symbolManager.lookupValue(a);
@@ -650,7 +655,7 @@ void ImGuiDebugger::drawDisassembly(CPURegs& regs, MSXCPUInterface& cpuInterface
 				auto winHeight = ImGui::GetWindowHeight();
 				auto lines = std::max(1, int(winHeight / itemHeight) - 1); // approx
 
-				auto topAddr = nInstructionsBefore(cpuInterface, pc, time, narrow<int>(lines / 4) + 1);
+				auto topAddr = dasmCache.nInstructionsBefore(pc, narrow<int>(lines / 4) + 1);
 
 				ImGui::SetScrollY(topAddr * itemHeight);
 			}
@@ -766,6 +771,199 @@ void ImGuiDebugger::drawStack(const CPURegs& regs, const MSXCPUInterface& cpuInt
 	});
 }
 
+void ImGuiDebugger::drawProfiler(SamplingProfiler& profiler)
+{
+	if (!showProfiler) return;
+
+	ImGui::SetNextWindowSize({400, 300}, ImGuiCond_FirstUseEver);
+	im::Window("Profiler", &showProfiler, [&]{
+		if (profiler.isRunning()) {
+			if (ImGui::Button("Stop")) profiler.stop();
+		} else {
+			if (ImGui::Button("Start")) profiler.start(EmuDuration::usec(100));
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear")) profiler.clear();
+		ImGui::SameLine();
+		auto total = profiler.getTotalSamples();
+		ImGui::StrCat("samples: ", total);
+		ImGui::SameLine();
+		bool changed = ImGui::RadioButton("function", &profileGroupBy, 0);
+		ImGui::SameLine();
+		changed |= ImGui::RadioButton("address", &profileGroupBy, 1);
+
+		// Recalculating the report is relatively expensive, so only do
+		// it when there are sufficiently many new samples.
+		if (changed || (total < profileEntriesSamples) ||
+		    (total - profileEntriesSamples) >= std::max<uint64_t>(1000, total / 64)) {
+			profileEntries = profiler.getReport(profileGroupBy == 0
+				? SamplingProfiler::GroupBy::FUNCTION
+				: SamplingProfiler::GroupBy::ADDRESS);
+			profileEntriesSamples = total;
+		}
+
+		int flags = ImGuiTableFlags_RowBg |
+			ImGuiTableFlags_BordersV |
+			ImGuiTableFlags_Resizable |
+			ImGuiTableFlags_Hideable |
+			ImGuiTableFlags_ScrollY;
+		im::Table("table", 4, flags, [&]{
+			ImGui::TableSetupScrollFreeze(0, 1); // Make top row always visible
+			ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("slot", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("address", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("symbol", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableHeadersRow();
+
+			im::ScopedFont sf(manager.fontMono);
+			auto sum = double(std::max<uint64_t>(1, profileEntriesSamples));
+			im::ListClipperID(profileEntries.size(), [&](int row) {
+				const auto& e = profileEntries[row];
+				if (ImGui::TableNextColumn()) {
+					ImGui::Text("%5.1f", 100.0 * double(e.samples) / sum);
+				}
+				if (ImGui::TableNextColumn()) {
+					ImGui::TextUnformatted(e.location.slotString());
+				}
+				if (ImGui::TableNextColumn()) {
+					if (ImGui::Selectable(tmpStrCat(hex_string<4>(e.location.pc)).c_str(),
+					                      false, ImGuiSelectableFlags_SpanAllColumns)) {
+						// show in the disassembly view
+						gotoTarget = e.location.pc;
+						showDisassembly = true;
+					}
+				}
+				if (ImGui::TableNextColumn()) {
+					if (!e.symbol.empty()) {
+						if (e.offset) {
+							ImGui::StrCat(e.symbol, '+', e.offset);
+						} else {
+							ImGui::TextUnformatted(e.symbol);
+						}
+					}
+				}
+			});
+		});
+	});
+}
+
+void ImGuiDebugger::drawAccessHeatmap(AccessStats& stats)
+{
+	if (!showAccessHeatmap) return;
+
+	ImGui::SetNextWindowSize({560, 600}, ImGuiCond_FirstUseEver);
+	im::Window("Memory access heatmap", &showAccessHeatmap, [&]{
+		if (stats.isRunning()) {
+			if (ImGui::Button("Stop")) stats.stop();
+		} else {
+			if (ImGui::Button("Start")) stats.start();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear")) {
+			stats.clear();
+			heatmapTexValid = false;
+		}
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(12.0f * ImGui::GetFontSize());
+		im::Combo("region", heatmapRegion.c_str(), [&]{
+			for (const auto* r : stats.getRegions()) {
+				if (ImGui::Selectable(r->getName().c_str(), r->getName() == heatmapRegion)) {
+					heatmapRegion = r->getName();
+				}
+			}
+		});
+		const auto* region = stats.findRegion(heatmapRegion);
+		if (!region) {
+			ImGui::TextUnformatted("Select a region"sv);
+			return;
+		}
+
+		static constexpr std::array types = {
+			std::pair{AccessStats::Type::WRITE,   "write (red)"},
+			std::pair{AccessStats::Type::READ,    "read (green)"},
+			std::pair{AccessStats::Type::EXECUTE, "execute (blue)"},
+		};
+		bool first = true;
+		for (auto [type, label] : types) {
+			if (!region->hasType(type)) continue;
+			if (!first) ImGui::SameLine();
+			first = false;
+			heatmapTexValid &= !ImGui::CheckboxFlags(label, &heatmapTypes, AccessStats::typeBit(type));
+		}
+
+		// The whole region is a single texture, so for big regions the width
+		// must be large enough to stay within the maximum texture height
+		// (e.g. a 4MB mapper with a 4096 texture size limit needs 1024).
+		static const auto maxTexSize = [] {
+			GLint result = 0;
+			glGetIntegerv(GL_MAX_TEXTURE_SIZE, &result);
+			return unsigned(std::max(result, 1024)); // OpenGL guarantees at least this
+		}();
+		unsigned minWidth = 64;
+		while (AccessStats::getImageHeight(*region, minWidth) > maxTexSize) minWidth *= 2;
+		if (minWidth > maxTexSize) {
+			ImGui::TextUnformatted("This region is too large to display"sv);
+			return;
+		}
+		auto width = std::max(unsigned(heatmapWidth), minWidth);
+
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(5.0f * ImGui::GetFontSize());
+		im::Combo("width", tmpStrCat(width).c_str(), [&]{
+			for (unsigned w = minWidth; w <= std::max(1024u, minWidth); w *= 2) {
+				if (ImGui::Selectable(tmpStrCat(w).c_str(), w == width)) {
+					heatmapWidth = int(w);
+					heatmapTexValid = false;
+				}
+			}
+		});
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(5.0f * ImGui::GetFontSize());
+		ImGui::SliderInt("zoom", &heatmapZoom, 1, 4);
+
+		auto height = AccessStats::getImageHeight(*region, width);
+		// Rendering a big region (e.g. a 4MB memory mapper) isn't free, so
+		// only do it when the counters (or the presentation) can change.
+		if (!heatmapTex || !heatmapTexValid || (heatmapTexRegion != region) || stats.isRunning()) {
+			heatmapPixels.resize(size_t(width) * height);
+			AccessStats::renderImage(*region, heatmapTypes, width, heatmapPixels);
+			if (!heatmapTex) {
+				heatmapTex.emplace(false, false); // no interpolation, no wrapping
+			}
+			heatmapTex->bind();
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, int(width), int(height), 0,
+			             GL_RGBA, GL_UNSIGNED_BYTE, heatmapPixels.data());
+			heatmapTexRegion = region;
+			heatmapTexValid = true;
+		}
+
+		auto zoom = float(heatmapZoom);
+		gl::vec2 scrnPos;
+		gl::vec2 size(float(width) * zoom, float(height) * zoom);
+		gl::vec2 availSize = gl::vec2(ImGui::GetContentRegionAvail()) - gl::vec2(0.0f, ImGui::GetTextLineHeightWithSpacing());
+		im::Child("##heatmap", availSize, 0, ImGuiWindowFlags_HorizontalScrollbar, [&]{
+			scrnPos = ImGui::GetCursorScreenPos();
+			ImGui::Image(heatmapTex->getImGui(), size);
+		});
+		if (ImGui::IsItemHovered()) {
+			auto [x, y] = trunc((gl::vec2(ImGui::GetIO().MousePos) - scrnPos) / zoom);
+			if ((0 <= x) && (unsigned(x) < width) && (0 <= y)) {
+				auto addr = size_t(y) * width + size_t(x);
+				if (addr < region->getSize()) {
+					im::ScopedFont sf(manager.fontMono);
+					ImGui::Text("0x%05x", unsigned(addr));
+					for (auto [type, label] : types) {
+						auto counters = region->getCounters(type);
+						if (counters.empty()) continue;
+						ImGui::SameLine();
+						ImGui::StrCat(AccessStats::getTypeName(type), ": ", counters[addr]);
+					}
+				}
+			}
+		}
+	});
+}
+
 void ImGuiDebugger::drawRegisters(CPURegs& regs)
 {
 	if (!showRegisters) return;
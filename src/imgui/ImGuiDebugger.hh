@@ -4,7 +4,11 @@
 #include "DebuggableEditor.hh"
 #include "ImGuiPart.hh"
 
+#include "AccessStats.hh"
+#include "DasmCache.hh"
 #include "EmuTime.hh"
+#include "GLUtil.hh"
+#include "SamplingProfiler.hh"
 
 #include <memory>
 #include <optional>
@@ -42,12 +46,15 @@ private:
 	void drawStack(const CPURegs& regs, const MSXCPUInterface& cpuInterface, EmuTime::param time);
 	void drawRegisters(CPURegs& regs);
 	void drawFlags(CPURegs& regs);
+	void drawProfiler(SamplingProfiler& profiler);
+	void drawAccessHeatmap(AccessStats& stats);
 
 private:
 	SymbolManager& symbolManager;
 	size_t cycleLabelsCounter = 0;
 
 	std::vector<std::unique_ptr<DebuggableEditor>> hexEditors; // sorted on 'getDebuggableName()'
+	DasmCache dasmCache; // for the disassembly view
 
 	std::string gotoAddr;
 	std::string runToAddr;
@@ -61,10 +68,25 @@ private:
 	bool showRegisters = false;
 	bool showFlags = false;
 	bool showXYFlags = false;
+	bool showProfiler = false;
+	bool showAccessHeatmap = false;
 	int flagsLayout = 1;
 
 	bool syncDisassemblyWithPC = false;
 
+	std::vector<SamplingProfiler::Entry> profileEntries;
+	uint64_t profileEntriesSamples = 0; // total samples when 'profileEntries' was calculated
+	int profileGroupBy = 0; // SamplingProfiler::GroupBy
+
+	std::string heatmapRegion = "memory";
+	unsigned heatmapTypes = AccessStats::ALL_TYPES;
+	int heatmapWidth = 256; // addresses per row
+	int heatmapZoom = 2;
+	std::vector<uint32_t> heatmapPixels;
+	std::optional<gl::Texture> heatmapTex;
+	const AccessStats::Region* heatmapTexRegion = nullptr; // the texture shows this region
+	bool heatmapTexValid = false;
+
 	static constexpr auto persistentElements = std::tuple{
 		PersistentElement{"showControl",     &ImGuiDebugger::showControl},
 		PersistentElement{"showDisassembly", &ImGuiDebugger::showDisassembly},
@@ -74,6 +96,11 @@ private:
 		PersistentElement{"showStack",       &ImGuiDebugger::showStack},
 		PersistentElement{"showFlags",       &ImGuiDebugger::showFlags},
 		PersistentElement{"showXYFlags",     &ImGuiDebugger::showXYFlags},
+		PersistentElement{"showProfiler",    &ImGuiDebugger::showProfiler},
+		PersistentElement{"showAccessHeatmap", &ImGuiDebugger::showAccessHeatmap},
+		PersistentElement{"heatmapRegion",   &ImGuiDebugger::heatmapRegion},
+		PersistentElementMinMax{"heatmapWidth", &ImGuiDebugger::heatmapWidth, 64, 16385},
+		PersistentElementMinMax{"heatmapZoom", &ImGuiDebugger::heatmapZoom, 1, 5},
 		PersistentElementMax{"flagsLayout",  &ImGuiDebugger::flagsLayout, 2}
 		// manually handle "showDebuggable.xxx"
 	};
@@ -22,8 +22,10 @@
 #include "xrange.hh"
 
 #include <imgui.h>
+#include <imgui_stdlib.h>
 
 #include <cassert>
+#include <utility>
 
 namespace openmsx {
 
@@ -105,10 +107,10 @@ void ImGuiSymbols::loadFile(const std::string& filename, SymbolManager::LoadEmpt
 	}
 }
 
-static void checkSort(const SymbolManager& manager, std::vector<SymbolRef>& symbols)
+static void checkSort(const SymbolManager& manager, std::vector<SymbolRef>& symbols, bool force)
 {
 	auto* sortSpecs = ImGui::TableGetSortSpecs();
-	if (!sortSpecs->SpecsDirty) return;
+	if (!sortSpecs->SpecsDirty && !force) return;
 
 	sortSpecs->SpecsDirty = false;
 	assert(sortSpecs->SpecsCount == 1);
@@ -130,7 +132,8 @@ static void checkSort(const SymbolManager& manager, std::vector<SymbolRef>& symb
 	}
 }
 template<bool FILTER_FILE>
-static void drawTable(ImGuiManager& manager, const SymbolManager& symbolManager, std::vector<SymbolRef>& symbols, const std::string& file = {})
+static void drawTable(ImGuiManager& manager, const SymbolManager& symbolManager, std::vector<SymbolRef>& symbols,
+                      const std::string& file = {}, bool forceSort = false)
 {
 	assert(FILTER_FILE == !file.empty());
 
@@ -151,11 +154,9 @@ static void drawTable(ImGuiManager& manager, const SymbolManager& symbolManager,
 			ImGui::TableSetupColumn("file");
 		}
 		ImGui::TableHeadersRow();
-		checkSort(symbolManager, symbols);
-
-		for (const auto& sym : symbols) {
-			if (FILTER_FILE && (sym.file(symbolManager) != file)) continue;
+		checkSort(symbolManager, symbols, forceSort);
 
+		auto drawRow = [&](const SymbolRef& sym) {
 			if (ImGui::TableNextColumn()) { // name
 				im::ScopedFont sf(manager.fontMono);
 				ImGui::TextUnformatted(sym.name(symbolManager));
@@ -167,6 +168,15 @@ static void drawTable(ImGuiManager& manager, const SymbolManager& symbolManager,
 			if (!FILTER_FILE && ImGui::TableNextColumn()) { // file
 				ImGui::TextUnformatted(sym.file(symbolManager));
 			}
+		};
+		// there can be many (tens of thousands) symbols, only draw the visible rows
+		if (FILTER_FILE) {
+			auto fileSymbols = to_vector(view::filter(symbols, [&](const auto& sym) {
+				return sym.file(symbolManager) == file;
+			}));
+			im::ListClipper(fileSymbols.size(), [&](int i) { drawRow(fileSymbols[i]); });
+		} else {
+			im::ListClipper(symbols.size(), [&](int i) { drawRow(symbols[i]); });
 		}
 	});
 }
@@ -239,7 +249,13 @@ void ImGuiSymbols::paint(MSXMotherBoard* /*motherBoard*/)
 				symbolManager.removeAllFiles();
 				fileError.clear();
 			}
-			drawTable<false>(manager, symbolManager, symbols);
+			if (ImGui::InputTextWithHint("##filter", "search", &filterString)) {
+				updateFilter();
+			}
+			simpleToolTip("Case-insensitive search, also finds names with small typos.");
+			// a new (or no longer) filtered list is not yet sorted on the selected column
+			drawTable<false>(manager, symbolManager, filterString.empty() ? symbols : filteredSymbols,
+			                 {}, std::exchange(filterChanged, false));
 		});
 	});
 }
@@ -257,8 +273,16 @@ void ImGuiSymbols::notifySymbolsChanged()
 		}
 	}
 
+	updateFilter();
+
 	manager.breakPoints->refreshSymbols();
 	manager.watchExpr->refreshSymbols();
 }
 
+void ImGuiSymbols::updateFilter()
+{
+	filteredSymbols = symbolManager.fuzzySearch(filterString);
+	filterChanged = true;
+}
+
 } // namespace openmsx
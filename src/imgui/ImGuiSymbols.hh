@@ -13,15 +13,6 @@
 
 namespace openmsx {
 
-struct SymbolRef {
-	unsigned fileIdx;
-	unsigned symbolIdx;
-
-	[[nodiscard]] std::string_view file(const SymbolManager& m) const { return m.getFiles()[fileIdx].filename; }
-	[[nodiscard]] std::string_view name(const SymbolManager& m) const { return m.getFiles()[fileIdx].symbols[symbolIdx].name; }
-	[[nodiscard]] uint16_t        value(const SymbolManager& m) const { return m.getFiles()[fileIdx].symbols[symbolIdx].value; }
-};
-
 class ImGuiSymbols final : public ImGuiPart, private SymbolObserver
 {
 	struct FileInfo {
@@ -49,6 +40,7 @@ public:
 
 private:
 	void loadFile(const std::string& filename, SymbolManager::LoadEmpty loadEmpty, SymbolFile::Type type);
+	void updateFilter();
 
 	// SymbolObserver
 	void notifySymbolsChanged() override;
@@ -56,6 +48,9 @@ private:
 private:
 	SymbolManager& symbolManager;
 	std::vector<SymbolRef> symbols;
+	std::string filterString;
+	std::vector<SymbolRef> filteredSymbols; // when 'filterString' is not empty
+	bool filterChanged = false; // re-apply the sort order to the shown list
 
 	std::vector<FileInfo> fileError;
 
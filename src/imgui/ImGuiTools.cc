@@ -12,6 +12,7 @@
 
 #include "AviRecorder.hh"
 #include "Display.hh"
+#include "HostProfiler.hh"
 
 #include "ranges.hh"
 #include "FileOperations.hh"
@@ -20,6 +21,7 @@
 #include <imgui.h>
 #include <imgui_stdlib.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -87,6 +89,8 @@ void ImGuiTools::showMenu(MSXMotherBoard* motherBoard)
 		ImGui::Separator();
 		ImGui::MenuItem("Disk Manipulator ...", nullptr, &manager.diskManipulator->show);
 		ImGui::Separator();
+		ImGui::MenuItem("Host Profiler ...", nullptr, &showHostProfiler);
+		ImGui::Separator();
 		ImGui::MenuItem("Trainer Selector ...", nullptr, &manager.trainer->show);
 		ImGui::MenuItem("Cheat Finder ...", nullptr, &manager.cheatFinder->show);
 		ImGui::Separator();
@@ -112,6 +116,7 @@ void ImGuiTools::paint(MSXMotherBoard* /*motherBoard*/)
 {
 	if (showScreenshot) paintScreenshot();
 	if (showRecord) paintRecord();
+	if (showHostProfiler) paintHostProfiler();
 
 	const auto popupTitle = "Confirm##Tools";
 	if (openConfirmPopup) {
@@ -351,4 +356,99 @@ void ImGuiTools::paintRecord()
 	});
 }
 
+void ImGuiTools::paintHostProfiler()
+{
+	auto& profiler = manager.getReactor().getHostProfiler();
+
+	ImGui::SetNextWindowSize({500, 400}, ImGuiCond_FirstUseEver);
+	im::Window("Host Profiler", &showHostProfiler, [&]{
+		if (profiler.isRunning()) {
+			if (ImGui::Button("Stop")) profiler.stop();
+		} else {
+			if (ImGui::Button("Start")) profiler.start();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Clear")) {
+			profiler.clear();
+			hostProfileEntries.clear();
+		}
+		ImGui::SameLine();
+		auto elapsed = profiler.getElapsed();
+		ImGui::Text("measured: %.1fs,", elapsed);
+		ImGui::SameLine();
+		ImGui::StrCat(profiler.getNumFrames(), " frames");
+		HelpMarker("Host time spent per C++ class. Times are exclusive: e.g. time spent "
+		           "generating sound is not included in the time of the device that "
+		           "triggered it. Time spent in the CPU emulation itself is not listed.");
+
+		// Rolling histogram of the host time per emulated frame.
+		auto graphName = [](int i) {
+			return (i == 0) ? std::string_view("frame")
+			                : HostProfiler::getCategoryName(HostProfiler::Category(i - 1));
+		};
+		ImGui::SetNextItemWidth(ImGui::GetFontSize() * 8.0f);
+		im::Combo("##graph", std::string(graphName(hostProfileGraph)).c_str(), [&]{
+			for (int i = 0; i <= int(HostProfiler::NUM_CATEGORIES); ++i) {
+				if (ImGui::Selectable(std::string(graphName(i)).c_str(), i == hostProfileGraph)) {
+					hostProfileGraph = i;
+				}
+			}
+		});
+		const auto& history = profiler.getFrameHistory();
+		const auto& values = (hostProfileGraph == 0)
+		                   ? history.total
+		                   : history.category[hostProfileGraph - 1];
+		ImGui::SameLine();
+		ImGui::Text("last frame: %.2f ms", double(values[(history.pos + values.size() - 1) % values.size()]));
+		// same scale for all graphs
+		auto maxValue = std::max(std::ranges::max(history.total), 1.0f);
+		ImGui::PlotHistogram("##frames", values.data(), int(values.size()), int(history.pos),
+		                     nullptr, 0.0f, maxValue, {-FLT_MIN, ImGui::GetFontSize() * 4.0f});
+
+		// Recalculating (sorting, demangling) is relatively expensive, only
+		// do it a few times per second.
+		hostProfileRefresh += ImGui::GetIO().DeltaTime;
+		if (hostProfileRefresh > 0.5f) {
+			hostProfileRefresh = 0.0f;
+			hostProfileEntries = profiler.getReport();
+		}
+
+		int flags = ImGuiTableFlags_RowBg |
+			ImGuiTableFlags_BordersV |
+			ImGuiTableFlags_Resizable |
+			ImGuiTableFlags_Hideable |
+			ImGuiTableFlags_ScrollY;
+		im::Table("table", 5, flags, [&]{
+			ImGui::TableSetupScrollFreeze(0, 1); // Make top row always visible
+			ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("ms", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("calls", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("category", ImGuiTableColumnFlags_WidthFixed);
+			ImGui::TableSetupColumn("name", ImGuiTableColumnFlags_WidthStretch);
+			ImGui::TableHeadersRow();
+
+			auto total = std::max(elapsed, 1e-9);
+			im::ListClipperID(hostProfileEntries.size(), [&](int row) {
+				const auto& e = hostProfileEntries[row];
+				auto ms = double(e.stat.nanos) * 1e-6;
+				if (ImGui::TableNextColumn()) {
+					ImGui::Text("%5.1f", 0.1 * ms / total);
+				}
+				if (ImGui::TableNextColumn()) {
+					ImGui::Text("%.1f", ms);
+				}
+				if (ImGui::TableNextColumn()) {
+					ImGui::StrCat(e.stat.calls);
+				}
+				if (ImGui::TableNextColumn()) {
+					ImGui::TextUnformatted(HostProfiler::getCategoryName(e.category));
+				}
+				if (ImGui::TableNextColumn()) {
+					ImGui::TextUnformatted(e.name);
+				}
+			});
+		});
+	});
+}
+
 } // namespace openmsx
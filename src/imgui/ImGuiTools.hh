@@ -3,8 +3,11 @@
 
 #include "ImGuiPart.hh"
 
+#include "HostProfiler.hh"
 #include "TclObject.hh"
 
+#include <vector>
+
 namespace openmsx {
 
 class ImGuiTools final : public ImGuiPart
@@ -21,6 +24,7 @@ public:
 private:
 	void paintScreenshot();
 	void paintRecord();
+	void paintHostProfiler();
 
 	[[nodiscard]] bool screenshotNameExists() const;
 	void generateScreenshotName();
@@ -31,6 +35,7 @@ private:
 private:
 	bool showScreenshot = false;
 	bool showRecord = false;
+	bool showHostProfiler = false;
 
 	std::string screenshotName;
 	enum class SsType : int { RENDERED, MSX, NUM };
@@ -48,6 +53,10 @@ private:
 	enum class VideoSize : int { V_320, V_640, V_960, NUM };
 	int recordVideoSize = static_cast<int>(VideoSize::V_320);
 
+	std::vector<HostProfiler::Entry> hostProfileEntries;
+	float hostProfileRefresh = 0.0f;
+	int hostProfileGraph = 0; // 0: total frame time, otherwise category + 1
+
 	TclObject confirmCmd;
 	std::string confirmText;
 	bool openConfirmPopup = false;
@@ -55,6 +64,7 @@ private:
 	static constexpr auto persistentElements = std::tuple{
 		PersistentElement{"showScreenshot",  &ImGuiTools::showScreenshot},
 		PersistentElement{"showRecord", &ImGuiTools::showRecord},
+		PersistentElement{"showHostProfiler", &ImGuiTools::showHostProfiler},
 		PersistentElementMax{"screenshotType", &ImGuiTools::screenshotType, static_cast<int>(SsType::NUM)},
 		PersistentElementMax{"screenshotSize", &ImGuiTools::screenshotSize, static_cast<int>(SsSize::NUM)},
 		PersistentElement{"screenshotWithOsd", &ImGuiTools::screenshotWithOsd},
@@ -139,7 +139,7 @@ static int main(int argc, char **argv)
 			if (parseStatus != CommandLineParser::TEST) {
 				display.repaint();
 
-				CliServer cliServer(reactor.getCommandController(),
+				CliServer cliServer(reactor.getGlobalCommandController(),
 				                    reactor.getEventDistributor(),
 				                    reactor.getGlobalCliComm());
 				reactor.run(parser);
@@ -13,6 +13,9 @@ namespace openmsx {
 CheckedRam::CheckedRam(const DeviceConfig& config, const std::string& name,
                        static_string_view description, size_t size)
 	: ram(config, name, description, size)
+	, accessRegion(config.getMotherBoard().getAccessStats(), name, size,
+	               AccessStats::typeBit(AccessStats::Type::READ) |
+	               AccessStats::typeBit(AccessStats::Type::WRITE))
 	, msxcpu(config.getMotherBoard().getCPU())
 	, umrCallback(config.getGlobalSettings().getUMRCallBackSetting())
 {
@@ -33,24 +36,28 @@ byte CheckedRam::read(size_t addr)
 			umrCallback.execute(narrow<int>(addr), ram.getName());
 		}
 	}
+	accessRegion.count(AccessStats::Type::READ, addr);
 	return ram[addr];
 }
 
 const byte* CheckedRam::getReadCacheLine(size_t addr) const
 {
-	return (completely_initialized_cacheline[addr >> CacheLine::BITS])
+	return (completely_initialized_cacheline[addr >> CacheLine::BITS] &&
+	        !accessRegion.isEnabled())
 	     ? &ram[addr] : nullptr;
 }
 
 byte* CheckedRam::getWriteCacheLine(size_t addr) const
 {
-	return (completely_initialized_cacheline[addr >> CacheLine::BITS])
+	return (completely_initialized_cacheline[addr >> CacheLine::BITS] &&
+	        !accessRegion.isEnabled())
 	     ? const_cast<byte*>(&ram[addr]) : nullptr;
 }
 
 byte* CheckedRam::getRWCacheLines(size_t addr, size_t size) const
 {
 	// TODO optimize
+	if (accessRegion.isEnabled()) return nullptr;
 	size_t num = size >> CacheLine::BITS;
 	size_t first = addr >> CacheLine::BITS;
 	for (auto i : xrange(num)) {
@@ -79,6 +86,7 @@ void CheckedRam::write(size_t addr, const byte value)
 			msxcpu.invalidateAllSlotsRWCache(0, 0x10000);
 		}
 	}
+	accessRegion.count(AccessStats::Type::WRITE, addr);
 	ram[addr] = value;
 }
 
@@ -1,6 +1,7 @@
 #ifndef CHECKEDRAM_HH
 #define CHECKEDRAM_HH
 
+#include "AccessStats.hh"
 #include "Ram.hh"
 #include "TclCallback.hh"
 #include "CacheLine.hh"
@@ -23,6 +24,10 @@ class Setting;
  * the turboR, only the normal memory mapper runs via CheckedRam. The RAM
  * accessed in DRAM mode or via the ROM mapper are unchecked! Note that there
  * is basically no overhead for using CheckedRam over Ram, thanks to Wouter.
+ *
+ * It also reports reads and writes to the AccessStats (memory heatmap). While
+ * those statistics are running, no cache lines are handed out at all, so that
+ * all accesses go via read() and write().
  */
 class CheckedRam final : private Observer<Setting>
 {
@@ -64,6 +69,7 @@ private:
 	std::vector<bool> completely_initialized_cacheline;
 	std::vector<std::bitset<CacheLine::SIZE>> uninitialized;
 	Ram ram;
+	AccessStats::Region accessRegion;
 	MSXCPU& msxcpu;
 	TclCallback umrCallback;
 };
@@ -8,6 +8,7 @@
 #include "HexDump.hh"
 #include "narrow.hh"
 #include "one_of.hh"
+#include "ranges.hh"
 #include "serialize.hh"
 
 #include <zlib.h>
@@ -103,6 +104,16 @@ void RamDebuggable::write(unsigned address, byte value)
 	ram[address] = value;
 }
 
+void RamDebuggable::readBlock(unsigned start, std::span<byte> output)
+{
+	ranges::copy(std::span{&ram[start], output.size()}, output);
+}
+
+void RamDebuggable::writeBlock(unsigned start, std::span<const byte> input)
+{
+	ranges::copy(input, &ram[start]);
+}
+
 
 template<typename Archive>
 void Ram::serialize(Archive& ar, unsigned /*version*/)
@@ -45,6 +45,8 @@ public:
 	[[nodiscard]] std::string_view getDescription() const override;
 	[[nodiscard]] byte read(unsigned address) override;
 	void write(unsigned address, byte value) override;
+	void readBlock(unsigned start, std::span<byte> output) override;
+	void writeBlock(unsigned start, std::span<const byte> input) override;
 	void moved(Rom& r);
 private:
 	Debugger& debugger;
@@ -419,6 +421,17 @@ void RomDebuggable::write(unsigned /*address*/, byte /*value*/)
 	// ignore
 }
 
+void RomDebuggable::readBlock(unsigned start, std::span<byte> output)
+{
+	assert((start + output.size()) <= getSize());
+	ranges::copy(std::span{&(*rom)[start], output.size()}, output);
+}
+
+void RomDebuggable::writeBlock(unsigned /*start*/, std::span<const byte> /*input*/)
+{
+	// ignore
+}
+
 void RomDebuggable::moved(Rom& r)
 {
 	rom = &r;
@@ -8,6 +8,7 @@
 #include "MemBuffer.hh"
 #include "FileOperations.hh"
 #include "Version.hh"
+#include "ZlibInflate.hh"
 #include "Date.hh"
 #include "narrow.hh"
 #include "one_of.hh"
@@ -147,11 +148,7 @@ void InputArchiveBase<Derived>::serialize_blob(
 
 	if (encoding == "gz-base64") {
 		auto [buf, bufSize] = Base64::decode(tmp);
-		auto dstLen = uLongf(data.size()); // TODO check for overflow?
-		if ((uncompress(std::bit_cast<Bytef*>(data.data()), &dstLen,
-		                std::bit_cast<const Bytef*>(buf.data()), uLong(bufSize))
-		     != Z_OK) ||
-		    (dstLen != data.size())) {
+		if (!ZlibInflate::uncompress(std::span{buf.data(), bufSize}, data)) {
 			throw MSXException("Error while decompressing blob.");
 		}
 	} else if (encoding == one_of("hex", "base64")) {
@@ -15,6 +15,7 @@
 #include "Filename.hh"
 #include "FileOperations.hh"
 #include "MSXCliComm.hh"
+#include "ThreadPool.hh"
 
 #include "stl.hh"
 #include "aligned.hh"
@@ -23,12 +24,15 @@
 #include "one_of.hh"
 #include "outer.hh"
 #include "ranges.hh"
+#include "scope_exit.hh"
 #include "unreachable.hh"
 #include "view.hh"
 #include "vla.hh"
+#include "xrange.hh"
 
 #include <cassert>
 #include <cmath>
+#include <future>
 #include <memory>
 #include <tuple>
 
@@ -477,9 +481,23 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime::param time)
 	constexpr unsigned HAS_STEREO_FLAG = 2;
 	unsigned usedBuffers = 0;
 
+	// Optionally let all devices generate their samples in parallel (in
+	// separate buffers). Mixing below is still done serially and in the
+	// same order, so the result is bit-identical to the serial case.
+	bool parallel = (infos.size() > 1) &&
+	                mixer.getMultithreadedSetting().getBoolean();
+	if (parallel) generateParallel(samples, time);
+	auto updateBuffer = [&](size_t i, SoundDevice& device, float* buffer) {
+		if (!parallel) return device.updateBuffer(samples, buffer, time);
+		const auto& devBuf = deviceBuffers[i];
+		if (!devBuf.generated) return false;
+		ranges::copy(std::span{devBuf.buffer.data(), devBuf.size}, buffer);
+		return true;
+	};
+
 	// FIXME: The Infos should be ordered such that all the mono
 	// devices are handled first
-	for (auto& info : infos) {
+	for (auto&& [i, info] : enumerate(infos)) {
 		SoundDevice& device = *info.device;
 		auto l1 = info.left1;
 		auto r1 = info.right1;
@@ -490,14 +508,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime::param time)
 				if (!(usedBuffers & HAS_MONO_FLAG)) {
 					// generate in 'monoBuf' (because it was still empty)
 					// then multiply in-place
-					if (device.updateBuffer(samples, monoBufPtr, time)) {
+					if (updateBuffer(i, device, monoBufPtr)) {
 						usedBuffers |= HAS_MONO_FLAG;
 						mul(monoBuf, l1);
 					}
 				} else {
 					// generate in 'tmpBuf' (as mono data)
 					// then multiply-accumulate into 'monoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(i, device, tmpBufPtr)) {
 						mulAcc(monoBuf, tmpBufMono, l1);
 					}
 				}
@@ -506,14 +524,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime::param time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// 'stereoBuf' (which is still empty) is first filled with mono-data,
 					// then in-place expanded to stereo-data
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(i, device, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mulExpand(stereoBuf, l1, r1);
 					}
 				} else {
 					// 'tmpBuf' is first filled with mono-data,
 					// then expanded to stereo and mul-acc into 'stereoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(i, device, tmpBufPtr)) {
 						mulExpandAcc(stereoBuf, tmpBufMono, l1, r1);
 					}
 				}
@@ -529,14 +547,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime::param time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// generate in 'stereoBuf' (because it was still empty)
 					// then multiply in-place
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(i, device, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mul(stereoBuf, l1);
 					}
 				} else {
 					// generate in 'tmpBuf' (as stereo data)
 					// then multiply-accumulate into 'stereoBuf'
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(i, device, tmpBufPtr)) {
 						mulAcc(stereoBuf, tmpBufStereo, l1);
 					}
 				}
@@ -546,14 +564,14 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime::param time)
 				if (!(usedBuffers & HAS_STEREO_FLAG)) {
 					// generate in 'stereoBuf' (because it was still empty)
 					// then mix in-place
-					if (device.updateBuffer(samples, stereoBufPtr, time)) {
+					if (updateBuffer(i, device, stereoBufPtr)) {
 						usedBuffers |= HAS_STEREO_FLAG;
 						mulMix2(stereoBuf, l1, l2, r1, r2);
 					}
 				} else {
 					// 'tmpBuf' is first filled with stereo-data,
 					// then mixed into stereoBuf
-					if (device.updateBuffer(samples, tmpBufPtr, time)) {
+					if (updateBuffer(i, device, tmpBufPtr)) {
 						mulMix2Acc(stereoBuf, tmpBufStereo, l1, l2, r1, r2);
 					}
 				}
@@ -600,6 +618,47 @@ void MSXMixer::generate(std::span<StereoFloat> output, EmuTime::param time)
 	}
 }
 
+void MSXMixer::generateParallel(size_t samples, EmuTime::param time)
+{
+	// Generate the output of each device in its own buffer. Devices are
+	// independent of each other (between two register-write sync points),
+	// so this can safely be done on multiple threads. The first device
+	// is handled on the current thread.
+	if (deviceBuffers.size() < infos.size()) {
+		deviceBuffers.resize(infos.size());
+	}
+	auto generateDevice = [&](size_t i) {
+		SoundDevice& device = *infos[i].device;
+		auto& devBuf = deviceBuffers[i];
+		// +3: see generate()
+		size_t required = 2 * (samples + 3);
+		if (devBuf.capacity < required) {
+			devBuf.buffer.resize(required);
+			devBuf.capacity = required;
+		}
+		devBuf.size = samples * (device.isStereo() ? 2 : 1);
+		devBuf.generated = device.updateBuffer(samples, devBuf.buffer.data(), time);
+	};
+
+	auto& pool = mixer.getThreadPool();
+	std::vector<std::future<void>> futures;
+	futures.reserve(infos.size() - 1);
+	// The tasks refer to local variables, so all of them must have finished
+	// before we leave this function, also when an exception is thrown.
+	scope_exit waitAll([&] {
+		for (auto& f : futures) {
+			if (f.valid()) f.wait(); // not yet consumed by get()
+		}
+	});
+	for (auto i : xrange(size_t(1), infos.size())) {
+		futures.push_back(pool.enqueue([&generateDevice, i] { generateDevice(i); }));
+	}
+	generateDevice(0);
+	for (auto& f : futures) {
+		f.get(); // wait and propagate exceptions (if any)
+	}
+}
+
 bool MSXMixer::needStereoRecording() const
 {
 	return ranges::any_of(infos, [](auto& info) {
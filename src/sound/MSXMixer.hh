@@ -7,7 +7,9 @@
 #include "Mixer.hh"
 #include "Schedulable.hh"
 
+#include "MemBuffer.hh"
 #include "Observer.hh"
+#include "aligned.hh"
 #include "dynarray.hh"
 
 #include <memory>
@@ -148,6 +150,7 @@ private:
 	void reschedule();
 	void reschedule2();
 	void generate(std::span<StereoFloat> output, EmuTime::param time);
+	void generateParallel(size_t samples, EmuTime::param time);
 
 	// Schedulable
 	void executeUntil(EmuTime::param time) override;
@@ -169,6 +172,17 @@ private:
 
 	std::vector<SoundDeviceInfo> infos;
 
+	/** Output of the individual sound devices, only used when generating
+	  * in parallel (see generateParallel()). Same order as 'infos'.
+	  */
+	struct DeviceBuffer {
+		MemBuffer<float, SSE_ALIGNMENT> buffer;
+		size_t capacity = 0; // in floats
+		size_t size = 0; // in floats, only valid if 'generated'
+		bool generated = false;
+	};
+	std::vector<DeviceBuffer> deviceBuffers;
+
 	Mixer& mixer;
 	MSXMotherBoard& motherBoard;
 	MSXCommandController& commandController;
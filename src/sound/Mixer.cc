@@ -5,6 +5,7 @@
 #include "CommandController.hh"
 #include "CliComm.hh"
 #include "MSXException.hh"
+#include "ThreadPool.hh"
 #include "one_of.hh"
 #include "stl.hh"
 #include "unreachable.hh"
@@ -46,6 +47,10 @@ Mixer::Mixer(Reactor& reactor_, CommandController& commandController_)
 	, samplesSetting(
 		commandController, "samples",
 		"mixer samples", defaultSamples, 64, 8192)
+	, multithreadedSetting(
+		commandController, "multithreaded_sound",
+		"generate the sound of the different sound chips in parallel",
+		false)
 {
 	muteSetting       .attach(*this);
 	frequencySetting  .attach(*this);
@@ -111,6 +116,14 @@ void Mixer::unregisterMixer(MSXMixer& mixer)
 	muteHelper();
 }
 
+ThreadPool& Mixer::getThreadPool()
+{
+	if (!threadPool) {
+		threadPool = std::make_unique<ThreadPool>();
+	}
+	return *threadPool;
+}
+
 
 void Mixer::mute()
 {
@@ -12,6 +12,7 @@ namespace openmsx {
 
 class SoundDriver;
 class Reactor;
+class ThreadPool;
 class CommandController;
 class MSXMixer;
 
@@ -52,6 +53,12 @@ public:
 
 	[[nodiscard]] IntegerSetting& getMasterVolume() { return masterVolume; }
 	[[nodiscard]] BooleanSetting& getMuteSetting() { return muteSetting; }
+	[[nodiscard]] BooleanSetting& getMultithreadedSetting() { return multithreadedSetting; }
+
+	/** Worker threads for generating sound in parallel, see
+	  * MSXMixer::generate(). Created on first use.
+	  */
+	[[nodiscard]] ThreadPool& getThreadPool();
 
 private:
 	void reloadDriver();
@@ -72,6 +79,9 @@ private:
 	IntegerSetting masterVolume;
 	IntegerSetting frequencySetting;
 	IntegerSetting samplesSetting;
+	BooleanSetting multithreadedSetting;
+
+	std::unique_ptr<ThreadPool> threadPool;
 
 	int muteCount = 0;
 };
@@ -5,6 +5,7 @@
 #include "Mixer.hh"
 #include "XMLElement.hh"
 #include "Filename.hh"
+#include "HostProfiler.hh"
 #include "StringOp.hh"
 #include "MemBuffer.hh"
 #include "MSXException.hh"
@@ -23,8 +24,10 @@
 
 namespace openmsx {
 
-static MemBuffer<float, SSE_ALIGNMENT> mixBuffer;
-static size_t mixBufferSize = 0;
+// thread_local: MSXMixer can generate the sound of different devices in
+// parallel (see 'multithreaded_sound' setting).
+static thread_local MemBuffer<float, SSE_ALIGNMENT> mixBuffer;
+static thread_local size_t mixBufferSize = 0;
 
 static void allocateMixBuffer(size_t size)
 {
@@ -241,7 +244,10 @@ bool SoundDevice::mixChannels(float* dataOut, size_t samples)
 		assert(count == separateChannels);
 	}
 
-	generateChannels(bufs, narrow<unsigned>(samples));
+	{
+		HostProfiler::Scope scope(HostProfiler::Category::SOUND, *this);
+		generateChannels(bufs, narrow<unsigned>(samples));
+	}
 
 	if (separateChannels == 0) {
 		return ranges::any_of(xrange(numChannels),
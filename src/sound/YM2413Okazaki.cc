@@ -1092,7 +1092,7 @@ ALWAYS_INLINE void YM2413::calcChannel(Channel& ch, std::span<float> buf)
 		mod_fixed_env = ch.mod.calc_fixed_env<HAS_MOD_AM>();
 	}
 
-	for (auto& b : buf) {
+	auto nextLfo = [&] {
 		unsigned lfo_pm = 0;
 		if constexpr (HAS_CAR_PM || HAS_MOD_PM) {
 			// Copied from Burczynski:
@@ -1110,11 +1110,61 @@ ALWAYS_INLINE void YM2413::calcChannel(Channel& ch, std::span<float> buf)
 			}
 			lfo_am = lfo_am_table[tmp_am_phase / 64];
 		}
+		return std::pair{lfo_pm, lfo_am};
+	};
+
+	// When the carrier reaches the end of the SETTLE state, both slots
+	// are keyed-on, and that resets their phase. So as long as we're in
+	// this (short) state, calculate sample per sample.
+	size_t start = 0;
+	while ((start < buf.size()) && (ch.car.state == SETTLE)) {
+		auto [lfo_pm, lfo_am] = nextLfo();
 		int fm = ch.mod.calc_slot_mod<HAS_MOD_AM, HAS_MOD_FB, HAS_MOD_FIXED_ENV>(
 		                      HAS_MOD_PM ? lfo_pm : 0, lfo_am, mod_fixed_env);
-		b += narrow_cast<float>(ch.car.calc_slot_car<HAS_CAR_AM, HAS_CAR_FIXED_ENV>(
+		buf[start++] += narrow_cast<float>(ch.car.calc_slot_car<HAS_CAR_AM, HAS_CAR_FIXED_ENV>(
 		                      HAS_CAR_PM ? lfo_pm : 0, lfo_am, fm, car_fixed_env));
 	}
+
+	// After that, the phase, output and feedback of the slots are only
+	// changed by the loop below. Keep those in local variables (the
+	// compiler can't do that by itself, e.g. because calc_envelope() may
+	// call out-of-line code). This is bit-identical to calling
+	// calc_slot_mod() and calc_slot_car() for each sample.
+	if (start == buf.size()) return;
+	auto& mod = ch.mod;
+	auto& car = ch.car;
+	unsigned modPhase = mod.cPhase;
+	unsigned carPhase = car.cPhase;
+	int modOutput = mod.output;
+	int modFeedback = mod.feedback;
+	int carOutput = car.output;
+	const auto modWF = mod.patch.WF;
+	const auto carWF = car.patch.WF;
+	for (auto& b : buf.subspan(start)) {
+		auto [lfo_pm, lfo_am] = nextLfo();
+
+		modPhase += mod.dPhase[HAS_MOD_PM ? lfo_pm : 0];
+		unsigned mPhase = modPhase >> DP_BASE_BITS;
+		unsigned modEnv = mod.calc_envelope<HAS_MOD_AM, HAS_MOD_FIXED_ENV>(lfo_am, mod_fixed_env);
+		if constexpr (HAS_MOD_FB) {
+			mPhase += wave2_8pi(modFeedback) >> mod.patch.FB;
+		}
+		int modNew = dB2LinTab[modWF[mPhase & PG_MASK] + modEnv];
+		modFeedback = (modOutput + modNew) >> 1;
+		modOutput = modNew;
+
+		carPhase += car.dPhase[HAS_CAR_PM ? lfo_pm : 0];
+		int cPhase = narrow<int>(carPhase >> DP_BASE_BITS) + wave2_8pi(modFeedback);
+		unsigned carEnv = car.calc_envelope<HAS_CAR_AM, HAS_CAR_FIXED_ENV>(lfo_am, car_fixed_env);
+		int carNew = dB2LinTab[carWF[cPhase & PG_MASK] + carEnv];
+		carOutput = (carOutput + carNew) >> 1;
+		b += narrow_cast<float>(carOutput);
+	}
+	mod.cPhase = modPhase;
+	car.cPhase = carPhase;
+	mod.output = modOutput;
+	mod.feedback = modFeedback;
+	car.output = carOutput;
 }
 
 void YM2413::generateChannels(std::span<float*, 9 + 5> bufs, unsigned num)
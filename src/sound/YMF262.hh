@@ -125,8 +125,8 @@ private:
 
 	class Channel {
 	public:
-		void chan_calc(unsigned lfo_am);
-		void chan_calc_ext(unsigned lfo_am);
+		void chan_calc(unsigned lfo_am, int& phase_modulation, int& phase_modulation2);
+		void chan_calc_ext(unsigned lfo_am, int& phase_modulation, int phase_modulation2);
 
 		template<typename Archive>
 		void serialize(Archive& ar, unsigned version);
@@ -202,6 +202,9 @@ private:
 	IRQHelper irq;
 
 	std::array<int, 18> chanOut = {};      // 18 channels
+	int phase_modulation = 0;  // phase modulation input (SLOT 2)
+	int phase_modulation2 = 0; // phase modulation input (SLOT 3
+	                           // in 4 operator channels)
 
 	std::array<uint8_t, 512> reg = {};
 	std::array<Channel, 18> channel;  // OPL3 chips have 18 channels
@@ -329,113 +329,109 @@ uint16_t YMF278::Slot::compute_am() const
 }
 
 
-void YMF278::advance()
+void YMF278::Slot::advance(unsigned eg_cnt)
 {
-	eg_cnt++;
-
 	// modulo counters for volume interpolation
 	auto tl_int_cnt  =  eg_cnt % 9;      // 0 .. 8
 	auto tl_int_step = (eg_cnt / 9) % 3; // 0 .. 2
 
-	for (auto& op : slots) {
-		// volume interpolation
-		if (tl_int_cnt == 0) {
-			if (tl_int_step == 0) {
-				// decrease volume by one step every 27 samples
-				if (op.TL < op.TLdest) ++op.TL;
-			} else {
-				// increase volume by one step every 13.5 samples
-				if (op.TL > op.TLdest) --op.TL;
-			}
+	// volume interpolation
+	if (tl_int_cnt == 0) {
+		if (tl_int_step == 0) {
+			// decrease volume by one step every 27 samples
+			if (TL < TLdest) ++TL;
+		} else {
+			// increase volume by one step every 13.5 samples
+			if (TL > TLdest) --TL;
 		}
+	}
 
-		if (op.lfo_active) {
-			op.lfo_cnt = (op.lfo_cnt + lfo_period[op.lfo]) & (LFO_PERIOD - 1);
-		}
+	if (lfo_active) {
+		lfo_cnt = (lfo_cnt + lfo_period[lfo]) & (LFO_PERIOD - 1);
+	}
 
-		// Envelope Generator
-		switch (op.state) {
-		case EG_ATT: { // attack phase
-			uint8_t rate = op.compute_rate(op.AR);
-			// Verified by HW recording (and matches Nemesis' tests of the YM2612):
-			// AR = 0xF during KeyOn results in instant switch to EG_DEC. (see keyOnHelper)
-			// Setting AR = 0xF while the attack phase is in progress freezes the envelope.
-			if (rate >= 63) {
-				break;
-			}
-			uint8_t shift = eg_rate_shift[rate];
-			if (!(eg_cnt & ((1 << shift) - 1))) {
-				uint8_t select = eg_rate_select[rate];
-				// >>4 makes the attack phase's shape match the actual chip -Valley Bell
-				op.env_vol = narrow<int16_t>(op.env_vol + ((~op.env_vol * eg_inc[select + ((eg_cnt >> shift) & 7)]) >> 4));
-				if (op.env_vol <= MIN_ATT_INDEX) {
-					op.env_vol = MIN_ATT_INDEX;
-					// TODO does the real HW skip EG_DEC completely,
-					//      or is it active for 1 sample?
-					op.state = op.DL ? EG_DEC : EG_SUS;
-				}
-			}
+	// Envelope Generator
+	switch (state) {
+	case EG_ATT: { // attack phase
+		uint8_t rate = compute_rate(AR);
+		// Verified by HW recording (and matches Nemesis' tests of the YM2612):
+		// AR = 0xF during KeyOn results in instant switch to EG_DEC. (see keyOnHelper)
+		// Setting AR = 0xF while the attack phase is in progress freezes the envelope.
+		if (rate >= 63) {
 			break;
 		}
-		case EG_DEC: { // decay phase
-			uint8_t rate = op.compute_decay_rate(op.D1R);
-			uint8_t shift = eg_rate_shift[rate];
-			if (!(eg_cnt & ((1 << shift) - 1))) {
-				uint8_t select = eg_rate_select[rate];
-				op.env_vol = narrow<int16_t>(op.env_vol + eg_inc[select + ((eg_cnt >> shift) & 7)]);
-				if (op.env_vol >= op.DL) {
-					op.state = (op.env_vol < MAX_ATT_INDEX) ? EG_SUS : EG_OFF;
-				}
+		uint8_t shift = eg_rate_shift[rate];
+		if (!(eg_cnt & ((1 << shift) - 1))) {
+			uint8_t select = eg_rate_select[rate];
+			// >>4 makes the attack phase's shape match the actual chip -Valley Bell
+			env_vol = narrow<int16_t>(env_vol + ((~env_vol * eg_inc[select + ((eg_cnt >> shift) & 7)]) >> 4));
+			if (env_vol <= MIN_ATT_INDEX) {
+				env_vol = MIN_ATT_INDEX;
+				// TODO does the real HW skip EG_DEC completely,
+				//      or is it active for 1 sample?
+				state = DL ? EG_DEC : EG_SUS;
 			}
-			break;
 		}
-		case EG_SUS: { // sustain phase
-			uint8_t rate = op.compute_decay_rate(op.D2R);
-			uint8_t shift = eg_rate_shift[rate];
-			if (!(eg_cnt & ((1 << shift) - 1))) {
-				uint8_t select = eg_rate_select[rate];
-				op.env_vol = narrow<int16_t>(op.env_vol + eg_inc[select + ((eg_cnt >> shift) & 7)]);
-				if (op.env_vol >= MAX_ATT_INDEX) {
-					op.env_vol = MAX_ATT_INDEX;
-					op.state = EG_OFF;
-				}
+		break;
+	}
+	case EG_DEC: { // decay phase
+		uint8_t rate = compute_decay_rate(D1R);
+		uint8_t shift = eg_rate_shift[rate];
+		if (!(eg_cnt & ((1 << shift) - 1))) {
+			uint8_t select = eg_rate_select[rate];
+			env_vol = narrow<int16_t>(env_vol + eg_inc[select + ((eg_cnt >> shift) & 7)]);
+			if (env_vol >= DL) {
+				state = (env_vol < MAX_ATT_INDEX) ? EG_SUS : EG_OFF;
 			}
-			break;
 		}
-		case EG_REL: { // release phase
-			uint8_t rate = op.compute_decay_rate(op.RR);
-			uint8_t shift = eg_rate_shift[rate];
-			if (!(eg_cnt & ((1 << shift) - 1))) {
-				uint8_t select = eg_rate_select[rate];
-				op.env_vol = narrow<int16_t>(op.env_vol + eg_inc[select + ((eg_cnt >> shift) & 7)]);
-				if (op.env_vol >= MAX_ATT_INDEX) {
-					op.env_vol = MAX_ATT_INDEX;
-					op.state = EG_OFF;
-				}
+		break;
+	}
+	case EG_SUS: { // sustain phase
+		uint8_t rate = compute_decay_rate(D2R);
+		uint8_t shift = eg_rate_shift[rate];
+		if (!(eg_cnt & ((1 << shift) - 1))) {
+			uint8_t select = eg_rate_select[rate];
+			env_vol = narrow<int16_t>(env_vol + eg_inc[select + ((eg_cnt >> shift) & 7)]);
+			if (env_vol >= MAX_ATT_INDEX) {
+				env_vol = MAX_ATT_INDEX;
+				state = EG_OFF;
 			}
-			break;
 		}
-		case EG_OFF:
-			// nothing
-			break;
-
-		default:
-			UNREACHABLE;
+		break;
+	}
+	case EG_REL: { // release phase
+		uint8_t rate = compute_decay_rate(RR);
+		uint8_t shift = eg_rate_shift[rate];
+		if (!(eg_cnt & ((1 << shift) - 1))) {
+			uint8_t select = eg_rate_select[rate];
+			env_vol = narrow<int16_t>(env_vol + eg_inc[select + ((eg_cnt >> shift) & 7)]);
+			if (env_vol >= MAX_ATT_INDEX) {
+				env_vol = MAX_ATT_INDEX;
+				state = EG_OFF;
+			}
 		}
+		break;
+	}
+	case EG_OFF:
+		// nothing
+		break;
+
+	default:
+		UNREACHABLE;
 	}
 }
 
+template<uint8_t BITS>
 int16_t YMF278::getSample(const Slot& slot, uint16_t pos) const
 {
 	// TODO How does this behave when R#2 bit 0 = 1?
 	//      As-if read returns 0xff? (Like for CPU memory reads.) Or is
 	//      sound generation blocked at some higher level?
-	switch (slot.bits) {
-	case 0: {
+	assert(slot.bits == BITS);
+	if constexpr (BITS == 0) {
 		// 8 bit
 		return narrow_cast<int16_t>(readMem(slot.startAddr + pos) << 8);
-	}
-	case 1: {
+	} else if constexpr (BITS == 1) {
 		// 12 bit
 		unsigned addr = slot.startAddr + ((pos / 2) * 3);
 		if (pos & 1) {
@@ -447,15 +443,13 @@ int16_t YMF278::getSample(const Slot& slot, uint16_t pos) const
 				 (readMem(addr + 0) << 8) |
 				((readMem(addr + 1) << 4) & 0xF0));
 		}
-	}
-	case 2: {
+	} else if constexpr (BITS == 2) {
 		// 16 bit
 		unsigned addr = slot.startAddr + (pos * 2);
 		return narrow_cast<int16_t>(
 			(readMem(addr + 0) << 8) |
 			(readMem(addr + 1) << 0));
-	}
-	default:
+	} else {
 		// TODO unspecified
 		return 0;
 	}
@@ -504,27 +498,40 @@ void YMF278::setMixLevel(uint8_t x, EmuTime::param time)
 	setSoftwareVolume(level[x & 7], level[(x >> 3) & 7], time);
 }
 
-void YMF278::generateChannels(std::span<float*> bufs, unsigned num)
+template<uint8_t BITS>
+void YMF278::generateSlot(Slot& sl, float* buf, unsigned num)
 {
-	if (!anyActive()) {
-		// TODO update internal state, even if muted
-		// TODO also mute individual channels
-		ranges::fill(bufs, nullptr);
-		return;
-	}
-
+	// Panning is also done separately. (low-volume TL + low-volume panning goes below -60dB)
+	// I'll be taking wild guess and assume that -3dB is approximated with 75%. (same as with TL and envelope levels)
+	// The same applies to the PCM mix level.
+	int32_t volLeft  = pan_left [sl.pan]; // note: register 0xF9 is handled externally
+	int32_t volRight = pan_right[sl.pan];
+	// 0 -> 0x20, 8 -> 0x18, 16 -> 0x10, 24 -> 0x0C, etc. (not using vol_factor here saves array boundary checks)
+	volLeft  = (0x20 - (volLeft  & 0x0f)) >> (volLeft  >> 4);
+	volRight = (0x20 - (volRight & 0x0f)) >> (volRight >> 4);
+
+	// The (decoded) samples at 'pos0' and at the position right after it.
+	// Usually the position advances by less than one sample per output
+	// sample (or by exactly one), so these can often be reused.
+	bool cacheValid = false;
+	uint16_t pos0 = 0, pos1 = 0;
+	int16_t sample0 = 0, sample1 = 0;
+
+	unsigned egCnt = eg_cnt;
 	for (auto j : xrange(num)) {
-		for (auto i : xrange(24)) {
-			auto& sl = slots[i];
-			if (sl.state == EG_OFF) {
-				//bufs[i][2 * j + 0] += 0;
-				//bufs[i][2 * j + 1] += 0;
-				continue;
+		if (sl.state != EG_OFF) {
+			if (!cacheValid || (sl.pos != pos0)) {
+				sample0 = (cacheValid && (sl.pos == pos1))
+				        ? sample1
+				        : getSample<BITS>(sl, sl.pos);
+				pos0 = sl.pos;
+				pos1 = nextPos(sl, pos0, 1);
+				sample1 = getSample<BITS>(sl, pos1);
+				cacheValid = true;
 			}
-
 			auto sample = narrow_cast<int16_t>(
-				(getSample(sl, sl.pos) * (0x10000 - sl.stepPtr) +
-				 getSample(sl, nextPos(sl, sl.pos, 1)) * sl.stepPtr) >> 16);
+				(sample0 * (0x10000 - sl.stepPtr) +
+				 sample1 * sl.stepPtr) >> 16);
 			// TL levels are 00..FF internally (TL register value 7F is mapped to TL level FF)
 			// Envelope levels have 4x the resolution (000..3FF)
 			// Volume levels are approximate logarithmic. -6dB result in half volume. Steps in between use linear interpolation.
@@ -536,17 +543,8 @@ void YMF278::generateChannels(std::span<float*> bufs, unsigned num)
 				         MAX_ATT_INDEX));
 			int smplOut = vol_factor(vol_factor(sample, envVol), sl.TL << TL_SHIFT);
 
-			// Panning is also done separately. (low-volume TL + low-volume panning goes below -60dB)
-			// I'll be taking wild guess and assume that -3dB is approximated with 75%. (same as with TL and envelope levels)
-			// The same applies to the PCM mix level.
-			int32_t volLeft  = pan_left [sl.pan]; // note: register 0xF9 is handled externally
-			int32_t volRight = pan_right[sl.pan];
-			// 0 -> 0x20, 8 -> 0x18, 16 -> 0x10, 24 -> 0x0C, etc. (not using vol_factor here saves array boundary checks)
-			volLeft  = (0x20 - (volLeft  & 0x0f)) >> (volLeft  >> 4);
-			volRight = (0x20 - (volRight & 0x0f)) >> (volRight >> 4);
-
-			bufs[i][2 * j + 0] += narrow_cast<float>((smplOut * volLeft ) >> 5);
-			bufs[i][2 * j + 1] += narrow_cast<float>((smplOut * volRight) >> 5);
+			buf[2 * j + 0] += narrow_cast<float>((smplOut * volLeft ) >> 5);
+			buf[2 * j + 1] += narrow_cast<float>((smplOut * volRight) >> 5);
 
 			unsigned step = (sl.lfo_active && sl.vib)
 			              ? calcStep(sl.OCT, sl.FN, sl.compute_vib())
@@ -558,8 +556,34 @@ void YMF278::generateChannels(std::span<float*> bufs, unsigned num)
 				sl.stepPtr &= 0xffff;
 			}
 		}
-		advance();
+		sl.advance(++egCnt);
+	}
+}
+
+void YMF278::generateChannels(std::span<float*> bufs, unsigned num)
+{
+	if (!anyActive()) {
+		// TODO update internal state, even if muted
+		// TODO also mute individual channels
+		ranges::fill(bufs, nullptr);
+		return;
+	}
+
+	// The slots don't influence each other (and the registers and the
+	// sample memory don't change during this call). So instead of
+	// calculating all slots for one sample, we can calculate all samples
+	// for one slot. This allows to move the checks that only depend on
+	// the slot (e.g. the sample format) out of the inner loop.
+	for (auto i : xrange(24)) {
+		auto& sl = slots[i];
+		switch (sl.bits) {
+		case 0:  generateSlot<0>(sl, bufs[i], num); break;
+		case 1:  generateSlot<1>(sl, bufs[i], num); break;
+		case 2:  generateSlot<2>(sl, bufs[i], num); break;
+		default: generateSlot<3>(sl, bufs[i], num); break;
+		}
 	}
+	eg_cnt += num;
 }
 
 void YMF278::keyOnHelper(YMF278::Slot& slot) const
@@ -572,7 +596,7 @@ void YMF278::keyOnHelper(YMF278::Slot& slot) const
 		// Nuke.YKT verified that the FM part does it exactly this way,
 		// and the OPL4 manual says it's instant as well.
 		slot.env_vol = MIN_ATT_INDEX;
-		// see comment in 'case EG_ATT' in YMF278::advance()
+		// see comment in 'case EG_ATT' in YMF278::Slot::advance()
 		slot.state = slot.DL ? EG_DEC : EG_SUS;
 	}
 	slot.stepPtr = 0;
@@ -48,6 +48,7 @@ private:
 		void envelope_next(int sample_rate);
 		[[nodiscard]] int16_t compute_vib() const;
 		[[nodiscard]] uint16_t compute_am() const;
+		void advance(unsigned eg_cnt);
 
 		template<typename Archive>
 		void serialize(Archive& ar, unsigned version);
@@ -94,9 +95,11 @@ private:
 
 	void writeRegDirect(uint8_t reg, uint8_t data, EmuTime::param time);
 	[[nodiscard]] unsigned getRamAddress(unsigned addr) const;
+	template<uint8_t BITS>
+	void generateSlot(Slot& slot, float* buf, unsigned num);
+	template<uint8_t BITS>
 	[[nodiscard]] int16_t getSample(const Slot& slot, uint16_t pos) const;
 	[[nodiscard]] static uint16_t nextPos(const Slot& slot, uint16_t pos, uint16_t increment);
-	void advance();
 	[[nodiscard]] bool anyActive();
 	void keyOnHelper(Slot& slot) const;
 
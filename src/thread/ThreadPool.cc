@@ -0,0 +1,70 @@
+#include "ThreadPool.hh"
+
+#include "xrange.hh"
+
+#include <algorithm>
+
+namespace openmsx {
+
+ThreadPool::ThreadPool(unsigned numThreads)
+{
+	if (numThreads == 0) {
+		numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	}
+	workers.reserve(numThreads);
+	for (auto i : xrange(numThreads)) {
+		(void)i;
+		workers.emplace_back([this]() { run(); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::scoped_lock lock(mutex);
+		exitLoop = true;
+		tasks.clear();
+	}
+	condition.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+std::future<void> ThreadPool::enqueue(std::packaged_task<void()> task)
+{
+	auto result = task.get_future();
+	{
+		std::scoped_lock lock(mutex);
+		tasks.push_back(std::move(task));
+	}
+	condition.notify_one();
+	return result;
+}
+
+void ThreadPool::clear()
+{
+	std::deque<std::packaged_task<void()>> discarded;
+	{
+		std::scoped_lock lock(mutex);
+		std::swap(discarded, tasks);
+	}
+	// 'discarded' is destroyed outside the lock
+}
+
+void ThreadPool::run()
+{
+	while (true) {
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock lock(mutex);
+			condition.wait(lock, [&] { return exitLoop || !tasks.empty(); });
+			if (exitLoop) return;
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+} // namespace openmsx
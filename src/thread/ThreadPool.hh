@@ -0,0 +1,69 @@
+#ifndef THREADPOOL_HH
+#define THREADPOOL_HH
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace openmsx {
+
+/**
+ * A fixed set of worker threads that execute queued tasks in FIFO order.
+ *
+ * An exception thrown by a task is captured in its future and rethrown by
+ * future::get(). Callers must wait for the futures of all tasks that refer
+ * to their local state, also when they themselves exit via an exception.
+ */
+class ThreadPool final
+{
+public:
+	/** Start the worker threads.
+	  * @param numThreads The number of worker threads, when zero use
+	  *        one thread less than the number of hardware threads (but
+	  *        at least one).
+	  */
+	explicit ThreadPool(unsigned numThreads = 0);
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool(ThreadPool&&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	ThreadPool& operator=(ThreadPool&&) = delete;
+
+	/** Tasks that are already running are finished, tasks that are
+	  * still queued are discarded.
+	  */
+	~ThreadPool();
+
+	/** Queue a task for execution on one of the worker threads.
+	  * @return A future that becomes ready when the task has finished.
+	  */
+	std::future<void> enqueue(std::packaged_task<void()> task);
+
+	template<typename F>
+	std::future<void> enqueue(F&& f) {
+		return enqueue(std::packaged_task<void()>(std::forward<F>(f)));
+	}
+
+	/** Discard all tasks that didn't start yet.
+	  * Their futures will report a 'broken_promise' error.
+	  */
+	void clear();
+
+	[[nodiscard]] unsigned size() const { return unsigned(workers.size()); }
+
+private:
+	void run();
+
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::packaged_task<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool exitLoop = false;
+};
+
+} // namespace openmsx
+
+#endif
@@ -0,0 +1,86 @@
+#include "catch.hpp"
+#include "AsyncSectorIO.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "ranges.hh"
+#include "xrange.hh"
+#include <random>
+#include <vector>
+
+using namespace openmsx;
+
+static SectorBuffer makeSector(size_t sector, unsigned generation)
+{
+	SectorBuffer buf;
+	for (auto i : xrange(buf.raw.size())) {
+		buf.raw[i] = uint8_t(sector * 7 + generation * 13 + i);
+	}
+	return buf;
+}
+
+TEST_CASE("AsyncSectorIO")
+{
+	static constexpr size_t NUM = 2000;
+	auto filename = FileOperations::getTempDir() + "/asyncsectorio_unittest.dsk";
+	std::vector<SectorBuffer> expected;
+	{
+		File file(filename, File::TRUNCATE);
+		for (auto s : xrange(NUM)) {
+			expected.push_back(makeSector(s, 0));
+		}
+		file.write(std::span{expected});
+	}
+
+	auto check = [&](AsyncSectorIO& io, size_t start, size_t num) {
+		std::vector<SectorBuffer> bufs(num);
+		io.read(bufs, start);
+		for (auto i : xrange(num)) {
+			CHECK(bufs[i].raw == expected[start + i].raw);
+		}
+	};
+
+	File file(filename);
+	SECTION("sequential reads, interleaved with writes") {
+		AsyncSectorIO io(file, NUM);
+		for (size_t s = 0; s < NUM; ) {
+			auto num = std::min<size_t>(1 + s % 5, NUM - s);
+			check(io, s, num);
+			// write within the read-ahead window, just ahead of the reads
+			if (auto w = s + num + 3; w < NUM) {
+				expected[w] = makeSector(w, 1);
+				io.write(w, expected[w]);
+			}
+			s += num;
+		}
+		check(io, 0, NUM);
+	}
+	SECTION("random access") {
+		std::minstd_rand rng(1234);
+		{
+			AsyncSectorIO io(file, NUM);
+			for (auto i : xrange(5000)) {
+				auto s = rng() % NUM;
+				if (rng() % 3 == 0) {
+					expected[s] = makeSector(s, unsigned(i));
+					io.write(s, expected[s]);
+				} else {
+					check(io, s, std::min<size_t>(1 + rng() % 16, NUM - s));
+				}
+			}
+		}
+		// the pending writes are done when 'io' is destroyed
+		std::vector<SectorBuffer> bufs(NUM);
+		file.seek(0);
+		file.read(std::span{bufs});
+		CHECK(ranges::equal(bufs, expected, [](auto& x, auto& y) { return x.raw == y.raw; }));
+	}
+	SECTION("read beyond end of file") {
+		AsyncSectorIO io(file, NUM);
+		check(io, NUM - 10, 5);
+		check(io, NUM - 5, 5); // read-ahead is clamped to the file size
+		std::vector<SectorBuffer> bufs(2);
+		CHECK_THROWS(io.read(bufs, NUM - 1));
+	}
+	file.close();
+	FileOperations::unlink(filename);
+}
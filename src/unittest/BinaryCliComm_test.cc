@@ -0,0 +1,61 @@
+#include "catch.hpp"
+#include "BinaryCliComm.hh"
+#include "MSXException.hh"
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+using namespace openmsx::BinaryCliComm;
+
+static std::vector<std::string> parse(const std::string& stream, size_t chunk)
+{
+	std::vector<std::string> result;
+	Parser parser([&](std::string message) { result.push_back(std::move(message)); });
+	for (size_t i = 0; i < stream.size(); i += chunk) {
+		parser.parse(std::span{stream}.subspan(i, std::min(chunk, stream.size() - i)));
+	}
+	return result;
+}
+
+TEST_CASE("BinaryCliComm: Writer/Reader")
+{
+	std::array<uint8_t, 3> data = {1, 2, 0};
+	auto message = Writer(Type::WRITE_BLOCK, 0x12345678)
+		.str("VRAM").u32(0x1000).u16(0xABCD).bytes(data).finish();
+	REQUIRE(message.size() == 4 + 1 + 4 + (4 + 4) + 4 + 2 + 3);
+	CHECK(message.substr(0, 4) == std::string("\x16\0\0\0", 4));
+
+	Reader reader(std::string_view(message).substr(4));
+	CHECK(Type(reader.u8()) == Type::WRITE_BLOCK);
+	CHECK(reader.u32() == 0x12345678);
+	CHECK(reader.str() == "VRAM");
+	CHECK(reader.u32() == 0x1000);
+	CHECK(reader.u16() == 0xABCD);
+	auto rest = reader.rest();
+	CHECK(std::vector<uint8_t>(rest.begin(), rest.end()) == std::vector<uint8_t>{1, 2, 0});
+	CHECK_THROWS_AS(reader.u8(), MSXException);
+
+	Reader truncated(std::string_view("\x05\0\0\0ab", 6));
+	CHECK_THROWS_AS(truncated.str(), MSXException);
+}
+
+TEST_CASE("BinaryCliComm: Parser")
+{
+	auto m1 = Writer(Type::COMMAND, 1).str("set power on").finish();
+	auto m2 = Writer(Type::STEP, 2).finish();
+	auto m3 = Writer(Type::READ_BLOCK, 3).str("memory").u32(0).u32(0x10000).finish();
+	std::string empty(4, '\0'); // empty messages are ignored
+	auto stream = m1 + empty + m2 + m3;
+
+	for (auto chunk : {size_t(1), size_t(3), size_t(7), stream.size()}) {
+		auto result = parse(stream, chunk);
+		REQUIRE(result.size() == 3);
+		CHECK(result[0] == m1.substr(4));
+		CHECK(result[1] == m2.substr(4));
+		CHECK(result[2] == m3.substr(4));
+	}
+
+	// incomplete message is not reported (yet)
+	CHECK(parse(m1.substr(0, m1.size() - 1), 5).empty());
+}
@@ -0,0 +1,112 @@
+#include "catch.hpp"
+#include "CompressedFileAdapter.hh"
+#include "File.hh"
+#include "FileOperations.hh"
+#include "ReadDir.hh"
+#include <ctime>
+#include <fstream>
+#include <string>
+#ifndef _MSC_VER
+#include <utime.h>
+#else
+#include <sys/utime.h>
+#endif
+#include <zlib.h>
+
+using namespace openmsx;
+
+static void createGzFile(const std::string& filename, const std::string& content, time_t time)
+{
+	gzFile f = gzopen(filename.c_str(), "wb");
+	REQUIRE(f);
+	gzwrite(f, content.data(), unsigned(content.size()));
+	gzclose(f);
+
+	struct utimbuf t;
+	t.actime = time;
+	t.modtime = time;
+	utime(filename.c_str(), &t);
+}
+
+static std::string readAll(const std::string& filename)
+{
+	File file(filename);
+	auto data = file.mmap();
+	return {reinterpret_cast<const char*>(data.data()), data.size()};
+}
+
+TEST_CASE("CompressedFileAdapter: cache")
+{
+	auto tmp = FileOperations::getTempDir() + "/decompress_cache_unittest";
+	FileOperations::deleteRecursive(tmp);
+	FileOperations::mkdirp(tmp);
+	auto gz = tmp + "/test.gz";
+	time_t time = 1'000'000'000;
+
+	// Replace the file without changing its modification time, so that
+	// we can detect whether the content came from the cache.
+	createGzFile(gz, "first", time);
+	SECTION("no cache") {
+		CompressedFileAdapter::setCacheSize(0);
+		CHECK(readAll(gz) == "first");
+		createGzFile(gz, "second", time);
+		CHECK(readAll(gz) == "second");
+	}
+	SECTION("keep unused files") {
+		CompressedFileAdapter::setCacheSize(1024 * 1024);
+		CHECK(readAll(gz) == "first");
+		createGzFile(gz, "second", time);
+		CHECK(readAll(gz) == "first"); // from the cache
+
+		// but a modified file is decompressed again
+		createGzFile(gz, "third", time + 1);
+		CHECK(readAll(gz) == "third");
+
+		// shrinking the cache drops the unused entries
+		CompressedFileAdapter::setCacheSize(0);
+		createGzFile(gz, "fourth", time + 1);
+		CHECK(readAll(gz) == "fourth");
+	}
+	SECTION("shared while in use") {
+		CompressedFileAdapter::setCacheSize(0);
+		File file1(gz);
+		CHECK(file1.getSize() == 5);
+		createGzFile(gz, "second", time);
+		CHECK(readAll(gz) == "first"); // still in use by 'file1'
+	}
+	SECTION("disk cache") {
+		CompressedFileAdapter::setCacheSize(0);
+		auto cacheDir = tmp + "/cache";
+		CompressedFileAdapter::setDiskCacheDirectory(cacheDir);
+		CHECK(readAll(gz) == "first");
+		std::string cached;
+		ReadDir dir(cacheDir);
+		while (auto* d = dir.getEntry()) {
+			if (d->d_name[0] == '.') continue;
+			CHECK(cached.empty());
+			cached = cacheDir + '/' + d->d_name;
+		}
+		REQUIRE(!cached.empty());
+
+		// modify the cached file, to verify it's really used
+		{
+			std::ofstream of(cached, std::ios::binary);
+			of.write("FIRST" "name" "\4\0\0\0", 5 + 4 + 4);
+		}
+		{
+			File file(gz);
+			CHECK(file.getSize() == 5);
+			auto data = file.mmap();
+			CHECK(std::string(reinterpret_cast<const char*>(data.data()), data.size()) == "FIRST");
+			CHECK(file.getOriginalName() == "name");
+		}
+
+		// different content results in a different cache entry
+		createGzFile(gz, "second", time);
+		CHECK(readAll(gz) == "second");
+		CompressedFileAdapter::setDiskCacheDirectory({});
+	}
+	CompressedFileAdapter::setCacheSize(64 * 1024 * 1024);
+
+	FileOperations::deleteRecursive(tmp);
+}
@@ -0,0 +1,72 @@
+#include "catch.hpp"
+#include "Dasm.hh"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace openmsx;
+
+TEST_CASE("Dasm: instructionLength")
+{
+	CHECK(instructionLength(0x00, 0x00) == 1); // nop
+	CHECK(instructionLength(0x3E, 0x00) == 2); // ld a,n
+	CHECK(instructionLength(0xC3, 0x00) == 3); // jp nn
+	CHECK(instructionLength(0xCB, 0x47) == 2); // bit 0,a
+	CHECK(instructionLength(0xED, 0xB0) == 2); // ldir
+	CHECK(instructionLength(0xED, 0x43) == 4); // ld (nn),bc
+	CHECK(instructionLength(0xDD, 0x09) == 2); // add ix,bc
+	CHECK(instructionLength(0xDD, 0x21) == 4); // ld ix,nn
+	CHECK(instructionLength(0xFD, 0x36) == 4); // ld (iy+d),n
+}
+
+TEST_CASE("Dasm: instructionBoundary, nInstructionsBefore")
+{
+	std::vector<uint8_t> mem(0x10000, 0x00); // all 'nop'
+	std::array<uint8_t, 14> code = {
+		0x3E, 0x12,             // 0000: ld a,#12
+		0x00,                   // 0002: nop
+		0xC3, 0x00, 0x00,       // 0003: jp #0000
+		0xDD, 0x21, 0x34, 0x12, // 0006: ld ix,#1234
+		0xCB, 0x47,             // 000A: bit 0,a
+		0xED, 0xB0,             // 000C: ldir
+	};
+	std::ranges::copy(code, mem.begin());
+	auto length = [&](uint16_t addr) {
+		return instructionLength(mem[addr], mem[uint16_t(addr + 1)]);
+	};
+
+	CHECK(instructionBoundary(length, 0x0000) == 0x0000);
+	CHECK(instructionBoundary(length, 0x0001) == 0x0000);
+	CHECK(instructionBoundary(length, 0x0002) == 0x0002);
+	CHECK(instructionBoundary(length, 0x0005) == 0x0003);
+	CHECK(instructionBoundary(length, 0x0008) == 0x0006);
+	CHECK(instructionBoundary(length, 0x000B) == 0x000A);
+	CHECK(instructionBoundary(length, 0x000D) == 0x000C);
+	CHECK(instructionBoundary(length, 0x8000) == 0x8000);
+
+	CHECK(nInstructionsBefore(length, 0x000C, 0) == 0x000C);
+	CHECK(nInstructionsBefore(length, 0x000D, 0) == 0x000C);
+	CHECK(nInstructionsBefore(length, 0x000C, 1) == 0x000A);
+	CHECK(nInstructionsBefore(length, 0x000C, 2) == 0x0006);
+	CHECK(nInstructionsBefore(length, 0x000C, 4) == 0x0002);
+	CHECK(nInstructionsBefore(length, 0x0003, 5) == 0x0000);
+	CHECK(nInstructionsBefore(length, 0x8000, 3) == 0x7FFD);
+}
+
+TEST_CASE("Dasm: from a byte buffer")
+{
+	auto check = [](std::vector<uint8_t> opcode, uint16_t pc, unsigned len, std::string_view expected) {
+		std::string dest;
+		CHECK(dasm(opcode, pc, dest) == len);
+		CHECK(dest == expected);
+	};
+	check({0x00}, 0x0000, 1, "nop");
+	check({0x3E, 0x12}, 0x0000, 2, "ld     a,#12");
+	check({0xC3, 0x34, 0x12}, 0x0000, 3, "jp     #1234");
+	check({0x18, 0xFE}, 0x4000, 2, "jr     #4000"); // relative to 'pc'
+	check({0xDD, 0x36, 0x05, 0x7F}, 0x0000, 4, "ld     (ix+#05),#7f");
+	check({0xED, 0xB0}, 0x0000, 2, "ldir");
+	check({0xCB}, 0x0000, 2, "rlc    b"); // missing bytes are taken as 0
+}
@@ -4,6 +4,7 @@
 #include "File.hh"
 #include "FileOperations.hh"
 #include "one_of.hh"
+#include "ranges.hh"
 #include "StringOp.hh"
 #include "Timer.hh"
 #include <iostream>
@@ -133,3 +134,141 @@ TEST_CASE("FilePoolCore")
 
 	FileOperations::deleteRecursive(tmp);
 }
+
+TEST_CASE("FilePoolCore: background indexing")
+{
+	auto tmp = FileOperations::getTempDir() + "/filepool_index_unittest";
+	FileOperations::deleteRecursive(tmp);
+	auto poolDir = tmp + "/pool";
+	FileOperations::mkdirp(poolDir + "/sub");
+	createFile(poolDir + "/a",     "aaa"); // 7e240de74fb1ed08fa08d38063f6a6a91462a815
+	createFile(poolDir + "/sub/b", "bbb"); // 5cb138284d431abd6a053a56625ec088bfb88912
+	createFile(poolDir + "/sub/c", "ccc"); // f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2
+
+	auto getDirectories = [&] {
+		FilePoolCore::Directories result;
+		result.emplace_back(poolDir, FileType::ROM);
+		return result;
+	};
+	auto indexAll = [](FilePoolCore& pool) {
+		pool.startIndexing();
+		CHECK(pool.isIndexing());
+		while (true) {
+			auto progress = pool.processIndexResults();
+			if (progress.done) return progress;
+			Timer::sleep(1'000); // 1ms
+		}
+	};
+
+	{
+		FilePoolCore pool(tmp + "/cache",
+				  getDirectories,
+				  [](std::string_view, float) { /* report progress: nothing */});
+		auto progress = indexAll(pool);
+		CHECK(!pool.isIndexing());
+		CHECK(progress.scanned == 3);
+		CHECK(progress.toHash == 3);
+		CHECK(progress.hashed == 3);
+
+		// the cache is written as soon as indexing is done
+		auto lines = readLines(tmp + "/cache");
+		REQUIRE(lines.size() == 3);
+		CHECK(lines[0].starts_with("5cb138284d431abd6a053a56625ec088bfb88912"));
+		CHECK(lines[0].ends_with(poolDir + "/sub/b"));
+		CHECK(lines[1].starts_with("7e240de74fb1ed08fa08d38063f6a6a91462a815"));
+		CHECK(lines[1].ends_with(poolDir + "/a"));
+		CHECK(lines[2].starts_with("f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2"));
+		CHECK(lines[2].ends_with(poolDir + "/sub/c"));
+
+		auto file = pool.getFile(FileType::ROM, Sha1Sum("f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2"));
+		CHECK(file.is_open());
+		CHECK(file.getURL() == poolDir + "/sub/c");
+	}
+	{
+		// only new files need to be hashed
+		createFile(poolDir + "/sub/d", "ddd"); // 9c969ddf454079e3d439973bbab63ea6233e4087
+		FilePoolCore pool(tmp + "/cache",
+				  getDirectories,
+				  [](std::string_view, float) { /* report progress: nothing */});
+		auto progress = indexAll(pool);
+		CHECK(progress.scanned == 4);
+		CHECK(progress.toHash == 1);
+		CHECK(progress.hashed == 1);
+
+		auto file = pool.getFile(FileType::ROM, Sha1Sum("9c969ddf454079e3d439973bbab63ea6233e4087"));
+		CHECK(file.is_open());
+		CHECK(file.getURL() == poolDir + "/sub/d");
+	}
+
+	FileOperations::deleteRecursive(tmp);
+}
+
+TEST_CASE("FilePoolCore: watch directories")
+{
+	auto tmp = FileOperations::getTempDir() + "/filepool_watch_unittest";
+	FileOperations::deleteRecursive(tmp);
+	auto poolDir = tmp + "/pool";
+	FileOperations::mkdirp(poolDir);
+	createFile(poolDir + "/a", "aaa"); // 7e240de74fb1ed08fa08d38063f6a6a91462a815
+
+	auto getDirectories = [&] {
+		FilePoolCore::Directories result;
+		result.emplace_back(poolDir, FileType::ROM);
+		return result;
+	};
+	auto cacheContains = [&](std::string_view sum) {
+		return ranges::any_of(readLines(tmp + "/cache"), [&](const auto& line) {
+			return line.starts_with(sum);
+		});
+	};
+
+	{
+		FilePoolCore pool(tmp + "/cache",
+				  getDirectories,
+				  [](std::string_view, float) { /* report progress: nothing */});
+		if (!pool.startWatching()) {
+			// not supported on this platform
+			FileOperations::deleteRecursive(tmp);
+			return;
+		}
+		// Process events until the (initial or change-triggered) indexing
+		// is finished, that's when the 'cache' file gets written.
+		auto waitUntil = [&](auto condition) {
+			for (int i = 0; i < 5000; ++i) {
+				pool.processWatchEvents();
+				(void)pool.processIndexResults();
+				if (condition()) return true;
+				Timer::sleep(1'000); // 1ms
+			}
+			return false;
+		};
+		CHECK(waitUntil([&] { return cacheContains("7e240de74fb1ed08fa08d38063f6a6a91462a815"); }));
+
+		// new file
+		createFile(poolDir + "/b", "bbb"); // 5cb138284d431abd6a053a56625ec088bfb88912
+		CHECK(waitUntil([&] { return cacheContains("5cb138284d431abd6a053a56625ec088bfb88912"); }));
+
+		// new directory with a file
+		FileOperations::mkdirp(poolDir + "/sub");
+		createFile(poolDir + "/sub/c", "ccc"); // f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2
+		CHECK(waitUntil([&] { return cacheContains("f36b4825e5db2cf7dd2d2593b3f5c24c0311d8b2"); }));
+
+		// modified file (within the same second)
+		createFile(poolDir + "/b", "BBB"); // aa6878b1c31a9420245df1daffb7b223338737a3
+		CHECK(waitUntil([&] { return cacheContains("aa6878b1c31a9420245df1daffb7b223338737a3"); }));
+		CHECK(!cacheContains("5cb138284d431abd6a053a56625ec088bfb88912"));
+
+		// removed file and directory
+		FileOperations::unlink(poolDir + "/a");
+		FileOperations::deleteRecursive(poolDir + "/sub");
+		Timer::sleep(10'000);
+		pool.processWatchEvents();
+	}
+	// removals are written when the pool is destroyed
+	auto lines = readLines(tmp + "/cache");
+	REQUIRE(lines.size() == 1);
+	CHECK(lines[0].starts_with("aa6878b1c31a9420245df1daffb7b223338737a3"));
+	CHECK(lines[0].ends_with(poolDir + "/b"));
+
+	FileOperations::deleteRecursive(tmp);
+}
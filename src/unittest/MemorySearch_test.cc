@@ -0,0 +1,177 @@
+#include "catch.hpp"
+#include "MemorySearchCore.hh"
+#include "Debuggable.hh"
+#include <algorithm>
+#include <span>
+#include <vector>
+
+using namespace openmsx;
+using Compare = MemorySearchCore::Compare;
+
+namespace {
+
+class TestDebuggable final : public Debuggable
+{
+public:
+	explicit TestDebuggable(size_t size) : data(size) {}
+
+	[[nodiscard]] unsigned getSize() const override { return unsigned(data.size()); }
+	[[nodiscard]] std::string_view getDescription() const override { return "test"; }
+	[[nodiscard]] byte read(unsigned address) override { return data[address]; }
+	void write(unsigned address, byte value) override { data[address] = value; }
+	void readBlock(unsigned /*start*/, std::span<byte> /*output*/) override {
+		FAIL("searching must not have side effects, use peekBlock()");
+	}
+	void peekBlock(unsigned start, std::span<byte> output) override {
+		bytesRead += output.size();
+		std::copy_n(&data[start], output.size(), output.data());
+	}
+
+	std::vector<uint8_t> data;
+	size_t bytesRead = 0;
+};
+
+} // namespace
+
+static std::vector<unsigned> addresses(const MemorySearchCore& search)
+{
+	std::vector<unsigned> result;
+	for (const auto& r : search.getResults(1000)) result.push_back(r.address);
+	return result;
+}
+
+TEST_CASE("MemorySearch: 8-bit")
+{
+	TestDebuggable debuggable(2000);
+	debuggable.data[10] = 0xFF;
+	debuggable.data[100] = 5;
+
+	MemorySearchCore search;
+	CHECK(!search.isStarted());
+
+	SECTION("unsigned") {
+		search.start(debuggable, false, false);
+		CHECK(search.isStarted());
+		CHECK(search.getNumCandidates() == 2000);
+
+		search.search(debuggable, Compare::GREATER, 200);
+		CHECK(addresses(search) == std::vector<unsigned>{10});
+		auto results = search.getResults(10);
+		REQUIRE(results.size() == 1);
+		CHECK(results[0].oldValue == 255);
+		CHECK(results[0].newValue == 255);
+	}
+	SECTION("signed") {
+		search.start(debuggable, false, true);
+		search.search(debuggable, Compare::LESS, 0);
+		CHECK(addresses(search) == std::vector<unsigned>{10});
+		CHECK(search.getResults(10)[0].newValue == -1);
+	}
+	SECTION("compare with value") {
+		search.start(debuggable, false, false);
+		search.search(debuggable, Compare::NOT_EQUAL, 0);
+		CHECK(addresses(search) == std::vector<unsigned>{10, 100});
+		search.search(debuggable, Compare::LESS_EQUAL, 5);
+		CHECK(addresses(search) == std::vector<unsigned>{100});
+		search.search(debuggable, Compare::GREATER_EQUAL, 6);
+		CHECK(search.getNumCandidates() == 0);
+		CHECK(search.getResults(10).empty());
+	}
+}
+
+TEST_CASE("MemorySearch: 16-bit")
+{
+	TestDebuggable debuggable(1024);
+	MemorySearchCore search;
+
+	SECTION("last address") {
+		// a 16-bit value can't start at the very last address
+		search.start(debuggable, true, false);
+		CHECK(search.getNumCandidates() == 1023);
+
+		debuggable.data[1022] = 0xCD; // little endian
+		debuggable.data[1023] = 0xAB;
+		search.search(debuggable, Compare::EQUAL, 0xABCD);
+		CHECK(addresses(search) == std::vector<unsigned>{1022});
+		auto results = search.getResults(10);
+		REQUIRE(results.size() == 1);
+		CHECK(results[0].oldValue == 0);
+		CHECK(results[0].newValue == 0xABCD);
+	}
+	SECTION("signed") {
+		debuggable.data[20] = 0x00;
+		debuggable.data[21] = 0x80;
+		search.start(debuggable, true, true);
+		search.search(debuggable, Compare::LESS_EQUAL, -32768);
+		CHECK(addresses(search) == std::vector<unsigned>{20});
+		CHECK(search.getResults(10)[0].newValue == -32768);
+
+		search.start(debuggable, true, false);
+		search.search(debuggable, Compare::EQUAL, 0x8000);
+		CHECK(addresses(search) == std::vector<unsigned>{20});
+	}
+	SECTION("chunk boundary") {
+		static constexpr unsigned B = MemorySearchCore::CHUNK_SIZE;
+		// value straddles the boundary between the first two chunks
+		debuggable.data[B - 1] = 0x34;
+		debuggable.data[B + 0] = 0x12;
+		search.start(debuggable, true, false);
+		search.search(debuggable, Compare::EQUAL, 0x1234);
+		CHECK(addresses(search) == std::vector<unsigned>{B - 1});
+
+		// only change the byte in the second chunk, which itself no
+		// longer contains any candidates
+		debuggable.data[B + 0] = 0x13;
+		search.search(debuggable, Compare::NOT_EQUAL, {});
+		CHECK(addresses(search) == std::vector<unsigned>{B - 1});
+		auto results = search.getResults(10);
+		REQUIRE(results.size() == 1);
+		CHECK(results[0].oldValue == 0x1234);
+		CHECK(results[0].newValue == 0x1334);
+
+		search.search(debuggable, Compare::EQUAL, {});
+		CHECK(addresses(search) == std::vector<unsigned>{B - 1});
+		debuggable.data[B + 0] = 0x12;
+		search.search(debuggable, Compare::LESS, {});
+		CHECK(addresses(search) == std::vector<unsigned>{B - 1});
+		CHECK(search.getResults(10)[0].oldValue == 0x1334);
+		CHECK(search.getResults(10)[0].newValue == 0x1234);
+	}
+}
+
+TEST_CASE("MemorySearch: changed/unchanged")
+{
+	TestDebuggable debuggable(0x10000);
+	MemorySearchCore search;
+	search.start(debuggable, false, false);
+	CHECK(search.getNumCandidates() == 0x10000);
+
+	debuggable.data[3] = 1;
+	debuggable.data[600] = 1;
+	debuggable.data[40000] = 1;
+	search.search(debuggable, Compare::NOT_EQUAL, {}); // changed
+	CHECK(addresses(search) == std::vector<unsigned>{3, 600, 40000});
+	CHECK(search.getResults(2).size() == 2);
+
+	debuggable.data[600] = 2;
+	search.search(debuggable, Compare::EQUAL, {}); // unchanged
+	CHECK(addresses(search) == std::vector<unsigned>{3, 40000});
+
+	debuggable.data[3] = 7;
+	search.search(debuggable, Compare::NOT_EQUAL, {});
+	CHECK(addresses(search) == std::vector<unsigned>{3});
+	auto results = search.getResults(10);
+	REQUIRE(results.size() == 1);
+	CHECK(results[0].oldValue == 1);
+	CHECK(results[0].newValue == 7);
+
+	// chunks without candidates are no longer read
+	debuggable.bytesRead = 0;
+	search.search(debuggable, Compare::EQUAL, {});
+	CHECK(addresses(search) == std::vector<unsigned>{3});
+	CHECK(debuggable.bytesRead == MemorySearchCore::CHUNK_SIZE);
+
+	// a new search starts over
+	search.start(debuggable, false, false);
+	CHECK(search.getNumCandidates() == 0x10000);
+}
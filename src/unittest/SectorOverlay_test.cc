@@ -0,0 +1,77 @@
+#include "catch.hpp"
+#include "SectorOverlay.hh"
+#include "FileException.hh"
+#include "FileOperations.hh"
+#include "xrange.hh"
+#include <fstream>
+#include <vector>
+
+using namespace openmsx;
+
+static SectorBuffer makeSector(uint8_t value)
+{
+	SectorBuffer buf;
+	buf.raw.fill(value);
+	return buf;
+}
+
+static std::vector<uint8_t> readBack(SectorOverlay& overlay, size_t start, size_t num)
+{
+	// first byte of each sector, 0 for sectors that were never written
+	std::vector<SectorBuffer> bufs(num, makeSector(0));
+	overlay.read(bufs, start);
+	std::vector<uint8_t> result;
+	for (const auto& b : bufs) result.push_back(b.raw[0]);
+	return result;
+}
+
+static void test(SectorOverlay& overlay)
+{
+	CHECK(overlay.empty());
+	CHECK(readBack(overlay, 0, 4) == std::vector<uint8_t>{0, 0, 0, 0});
+
+	overlay.write(2, makeSector(20));
+	overlay.write(100, makeSector(100));
+	overlay.write(1, makeSector(10));
+	CHECK(!overlay.empty());
+	CHECK(readBack(overlay, 0, 4) == std::vector<uint8_t>{0, 10, 20, 0});
+	CHECK(readBack(overlay, 2, 1) == std::vector<uint8_t>{20});
+	CHECK(readBack(overlay, 99, 3) == std::vector<uint8_t>{0, 100, 0});
+
+	overlay.write(2, makeSector(21)); // rewrite
+	CHECK(readBack(overlay, 0, 4) == std::vector<uint8_t>{0, 10, 21, 0});
+}
+
+TEST_CASE("SectorOverlay: memory")
+{
+	SectorOverlay overlay;
+	CHECK(overlay.getDeltaFile().empty());
+	test(overlay);
+}
+
+TEST_CASE("SectorOverlay: delta file")
+{
+	auto filename = FileOperations::getTempDir() + "/sectoroverlay_unittest.delta";
+	FileOperations::unlink(filename);
+	{
+		SectorOverlay overlay(filename);
+		CHECK(overlay.getDeltaFile() == filename);
+		test(overlay);
+	}
+	// 16 bytes header, 3 records (the rewritten sector is updated in-place)
+	CHECK(FileOperations::getStat(filename)->st_size == 16 + 3 * (8 + 512));
+	{
+		// reopen, the changes are still there
+		SectorOverlay overlay(filename);
+		CHECK(readBack(overlay, 0, 4) == std::vector<uint8_t>{0, 10, 21, 0});
+		CHECK(readBack(overlay, 100, 1) == std::vector<uint8_t>{100});
+		overlay.write(3, makeSector(30));
+		CHECK(readBack(overlay, 0, 4) == std::vector<uint8_t>{0, 10, 21, 30});
+	}
+	{
+		std::ofstream of(filename, std::ios::binary);
+		of << "not a delta file";
+	}
+	CHECK_THROWS_AS(SectorOverlay(filename), FileException);
+	FileOperations::unlink(filename);
+}
@@ -0,0 +1,147 @@
+#include "catch.hpp"
+#include "SpriteChecker.hh"
+#include "random.hh"
+#include "xrange.hh"
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+using namespace openmsx;
+using SpriteInfo = SpriteChecker::SpriteInfo;
+using SpritePattern = SpriteChecker::SpritePattern;
+
+// Reference implementation: check every pair of sprites (this is how
+// SpriteChecker used to do it).
+static int referenceCollision(std::span<const SpriteInfo> sprites,
+                              byte noCollideMask, bool can0collide)
+{
+	auto collides = [&](byte colorAttrib) {
+		if (!can0collide && ((colorAttrib & 0xf) == 0)) return false;
+		return (colorAttrib & noCollideMask) == 0;
+	};
+	int minXCollision = 999;
+	for (int i = int(sprites.size()); --i >= 1; /**/) {
+		if (!collides(sprites[i].colorAttrib)) continue;
+		int x_i = sprites[i].x;
+		SpritePattern pattern_i = sprites[i].pattern;
+		for (int j = i; --j >= 0; /**/) {
+			if (!collides(sprites[j].colorAttrib)) continue;
+			int dist = sprites[j].x - x_i;
+			if ((-32 < dist) && (dist < 32)) {
+				SpritePattern pattern_j = sprites[j].pattern;
+				if (dist < 0) {
+					pattern_j <<= -dist;
+				} else {
+					pattern_j >>= dist;
+				}
+				SpritePattern colPat = pattern_i & pattern_j;
+				if (x_i < 0) {
+					colPat &= (1 << (32 + x_i)) - 1;
+				}
+				if (colPat) {
+					int xCollision = x_i + std::countl_zero(colPat);
+					minXCollision = std::min(minXCollision, xCollision);
+				}
+			}
+		}
+	}
+	return (minXCollision < 256) ? minXCollision : -1;
+}
+
+static SpriteInfo makeSprite(SpritePattern pattern, int x, byte colorAttrib = 0x0f)
+{
+	SpriteInfo result;
+	result.pattern = pattern;
+	result.x = int16_t(x);
+	result.colorAttrib = colorAttrib;
+	return result;
+}
+
+TEST_CASE("SpriteChecker::findCollision")
+{
+	SECTION("no sprites") {
+		CHECK(SpriteChecker::findCollision({}, 0x60, true) == -1);
+	}
+	SECTION("single sprite never collides") {
+		std::vector<SpriteInfo> s = {makeSprite(0xFFFF0000, 10)};
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == -1);
+	}
+	SECTION("overlap") {
+		std::vector<SpriteInfo> s = {
+			makeSprite(0xFF000000, 10),
+			makeSprite(0xFF000000, 14),
+		};
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == 14);
+	}
+	SECTION("adjacent, no overlap") {
+		std::vector<SpriteInfo> s = {
+			makeSprite(0xFF000000, 10),
+			makeSprite(0xFF000000, 18),
+		};
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == -1);
+	}
+	SECTION("color 0") {
+		std::vector<SpriteInfo> s = {
+			makeSprite(0xFF000000, 10, 0x00),
+			makeSprite(0xFF000000, 12),
+		};
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == 12);
+		CHECK(SpriteChecker::findCollision(s, 0x60, false) == -1);
+	}
+	SECTION("CC/IC bits only matter in sprite mode 2") {
+		std::vector<SpriteInfo> s = {
+			makeSprite(0xFF000000, 10, 0x4f),
+			makeSprite(0xFF000000, 12),
+		};
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == -1);
+		CHECK(SpriteChecker::findCollision(s, 0x00, true) == 12);
+	}
+	SECTION("left border") {
+		std::vector<SpriteInfo> s = {
+			makeSprite(0xFFFF0000, -32),
+			makeSprite(0xFFFF0000, -20),
+		};
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == -1);
+		s[1].x = -24;
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == -1);
+		s[1].x = -25;
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == -1);
+		s[0].x = -10;
+		s[1].x = -5;
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == 0);
+	}
+	SECTION("right border") {
+		std::vector<SpriteInfo> s = {
+			makeSprite(0xFFFFFFFF, 250),
+			makeSprite(0xFFFFFFFF, 255),
+		};
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == 255);
+		s[0].x = 255;
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == 255);
+		s[0].x = 224;
+		s[1].x = 240;
+		CHECK(SpriteChecker::findCollision(s, 0x60, true) == 240);
+	}
+	SECTION("random, compare with reference") {
+		for (auto iter : xrange(20000)) {
+			(void)iter;
+			auto n = random_int(0, 8);
+			std::vector<SpriteInfo> s;
+			for (auto i : xrange(n)) {
+				(void)i;
+				// mostly sparse patterns, so that not every pair collides
+				auto pattern = SpritePattern(random_int(0, 0xFFFF)
+				                           & random_int(0, 0xFFFF)) << 16;
+				if (random_bool()) pattern = SpriteChecker::doublePattern(pattern);
+				s.push_back(makeSprite(pattern, random_int(-32, 255),
+				                       byte(random_int(0, 255))));
+			}
+			for (byte mask : {byte(0x00), byte(0x60)}) {
+				for (bool can0collide : {false, true}) {
+					CHECK(SpriteChecker::findCollision(s, mask, can0collide) ==
+					      referenceCollision(s, mask, can0collide));
+				}
+			}
+		}
+	}
+}
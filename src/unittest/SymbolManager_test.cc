@@ -247,3 +247,84 @@ TEST_CASE("SymbolManager: loadLinkMap")
 	CHECK(file.symbols[5].name == "last");
 	CHECK(file.symbols[5].value == 0x8765);
 }
+
+TEST_CASE("SymbolManager: buildIndex, findSymbol")
+{
+	std::string_view buffer =
+		"main: equ #4010\n"
+		"Loop: equ #4020\n"
+		"init: equ #4000\n"
+		"LOOP: equ #4030\n"
+		"alias: equ #4010\n";
+	auto file = SymbolManager::loadGeneric("myfile.sym", buffer);
+	SymbolManager::buildIndex(file);
+
+	REQUIRE(file.byValue.size() == 5);
+	CHECK(file.symbols[file.byValue[0]].name == "init");
+	CHECK(file.symbols[file.byValue[1]].name == "main"); // stable: file order
+	CHECK(file.symbols[file.byValue[2]].name == "alias");
+	CHECK(file.symbols[file.byValue[3]].name == "Loop");
+	CHECK(file.symbols[file.byValue[4]].name == "LOOP");
+
+	REQUIRE(file.byName.size() == 5);
+	CHECK(file.symbols[file.byName[0]].name == "alias");
+	CHECK(file.symbols[file.byName[1]].name == "init");
+	CHECK(file.symbols[file.byName[2]].name == "Loop");
+	CHECK(file.symbols[file.byName[3]].name == "LOOP");
+	CHECK(file.symbols[file.byName[4]].name == "main");
+
+	auto find = [&](std::string_view name, bool caseSensitive, bool last = false) -> std::optional<uint16_t> {
+		if (const auto* sym = SymbolManager::findSymbol(file, name, caseSensitive, last)) return sym->value;
+		return {};
+	};
+	CHECK(find("main", true) == 0x4010);
+	CHECK(find("MAIN", true) == std::nullopt);
+	CHECK(find("MAIN", false) == 0x4010);
+	CHECK(find("LOOP", true) == 0x4030);
+	CHECK(find("loop", false) == 0x4020); // first in file order
+	CHECK(find("loop", false, true) == 0x4030); // last in file order
+	CHECK(find("LOOP", true, true) == 0x4030);
+	CHECK(find("foo", false) == std::nullopt);
+
+	// duplicate names: first or last occurrence
+	auto dups = SymbolManager::loadGeneric("dups.sym",
+		"dup: equ #1000\n"
+		"other: equ #2000\n"
+		"dup: equ #3000\n");
+	SymbolManager::buildIndex(dups);
+	CHECK(SymbolManager::findSymbol(dups, "dup", true)->value == 0x1000);
+	CHECK(SymbolManager::findSymbol(dups, "dup", true, true)->value == 0x3000);
+}
+
+TEST_CASE("SymbolManager: fuzzySearch")
+{
+	std::string_view buffer1 =
+		"print_string: equ 1\n"
+		"print_char: equ 2\n"
+		"clear_screen: equ 3\n";
+	std::string_view buffer2 =
+		"PRINT: equ 4\n"
+		"sprint_string_fast: equ 5\n";
+	std::vector<SymbolFile> files;
+	files.push_back(SymbolManager::loadGeneric("file1.sym", buffer1));
+	files.push_back(SymbolManager::loadGeneric("file2.sym", buffer2));
+	for (auto& file : files) SymbolManager::buildIndex(file);
+
+	auto search = [&](std::string_view pattern) {
+		std::vector<std::string> result;
+		for (const auto& ref : SymbolManager::fuzzySearch(files, pattern)) {
+			result.push_back(files[ref.fileIdx].symbols[ref.symbolIdx].name);
+		}
+		return result;
+	};
+	using V = std::vector<std::string>;
+	CHECK(search("").empty());
+	// short patterns: substring match, shortest names first
+	CHECK(search("ch") == V{"print_char"});
+	CHECK(search("xyz").empty());
+	// case-insensitive substring matches, shortest first
+	CHECK(search("print") == V{"PRINT", "print_char", "print_string", "sprint_string_fast"});
+	// typo: not a substring anymore, but still found
+	CHECK(search("print_strng") == V{"print_string", "sprint_string_fast"});
+	CHECK(search("clear_scren") == V{"clear_screen"});
+}
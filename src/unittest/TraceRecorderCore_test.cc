@@ -0,0 +1,137 @@
+#include "catch.hpp"
+#include "TraceRecorderCore.hh"
+#include "FileOperations.hh"
+#include "MSXException.hh"
+#include "endian.hh"
+#include "xrange.hh"
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace openmsx;
+using Core = TraceRecorderCore;
+
+static std::vector<uint8_t> readFile(const std::string& filename)
+{
+	std::ifstream is(filename, std::ios::binary);
+	return {std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+}
+
+static std::vector<std::string> readLines(const std::string& filename)
+{
+	std::vector<std::string> result;
+	std::ifstream is(filename);
+	std::string line;
+	while (std::getline(is, line)) {
+		result.push_back(line);
+	}
+	return result;
+}
+
+static void record(Core& core, uint16_t pc, std::array<uint8_t, 4> opcode, uint64_t time)
+{
+	core.beginInstruction(pc, 0x4320, opcode);
+	core.endInstruction(time);
+}
+
+TEST_CASE("TraceRecorderCore: save and decode")
+{
+	auto tmp = FileOperations::getTempDir() + "/tracerecorder_unittest";
+	FileOperations::deleteRecursive(tmp);
+	FileOperations::mkdirp(tmp);
+	auto trace = tmp + "/trace.bin";
+	auto text = tmp + "/trace.txt";
+
+	Core core;
+	CHECK(!core.isRecording());
+	core.start(1); // rounded up to the minimum
+	CHECK(core.isRecording());
+	CHECK(core.size() == 0);
+
+	static constexpr uint64_t T0 = uint64_t(3) * 3579545 * 1000; // some arbitrary time
+	record(core, 0x4000, {0x3E, 0x12, 0x00, 0x00}, T0);      // ld a,#12
+	core.beginInstruction(0x4002, 0x4320, std::array<uint8_t, 4>{0xD3, 0x98, 0x00, 0x00}); // out (#98),a
+	core.noteAccess(Core::ACCESS_IO_WRITE, 0x1298, 0x12);
+	core.noteAccess(Core::ACCESS_MEM_WRITE, 0xC000, 0x34); // only the first access is kept
+	core.endInstruction(T0 + 100);
+	core.beginInstruction(0x4004, 0x4320, std::array<uint8_t, 4>{0x32, 0x00, 0xC0, 0x00}); // ld (#C000),a
+	core.noteAccess(Core::ACCESS_MEM_WRITE, 0xC000, 0x12);
+	core.endInstruction(T0 + 300);
+	core.stop();
+	CHECK(!core.isRecording());
+	CHECK(core.size() == 3);
+
+	core.save(trace);
+	auto bin = readFile(trace);
+	REQUIRE(bin.size() == Core::HEADER_SIZE + 3 * sizeof(Core::Record));
+	CHECK(std::string_view(reinterpret_cast<const char*>(bin.data()), 16) == Core::MAGIC);
+	CHECK(Endian::read_UA_L32(&bin[16]) == Core::FILE_VERSION);
+	CHECK(Endian::read_UA_L32(&bin[20]) == sizeof(Core::Record));
+	CHECK(Endian::read_UA_L64(&bin[24]) == 3);
+	CHECK(Endian::read_UA_L64(&bin[32]) == T0);
+
+	Core::decode(trace, text);
+	auto lines = readLines(text);
+	REQUIRE(lines.size() == 3);
+	// time, slot per page, pc, opcode, disassembly, data access
+	CHECK(lines[0] == "3.125000000 0-0 0-2 0-3 1-0 4000 : 3e 12       ld     a,#12       ");
+	CHECK(lines[1] == "3.125000029 0-0 0-2 0-3 1-0 4002 : d3 98       out    (#98),a      out (#98) <- #12");
+	CHECK(lines[2] == "3.125000087 0-0 0-2 0-3 1-0 4004 : 32 00 c0    ld     (#c000),a    (#c000) <- #12");
+
+	// not a trace file
+	CHECK_THROWS_AS(Core::decode(text, tmp + "/out.txt"), MSXException);
+	// truncated
+	bin.resize(bin.size() - 1);
+	{
+		std::ofstream os(trace, std::ios::binary);
+		os.write(reinterpret_cast<const char*>(bin.data()), std::streamsize(bin.size()));
+	}
+	CHECK_THROWS_AS(Core::decode(trace, text), MSXException);
+
+	FileOperations::deleteRecursive(tmp);
+}
+
+TEST_CASE("TraceRecorderCore: ring buffer wraps around")
+{
+	auto tmp = FileOperations::getTempDir() + "/tracerecorder_unittest";
+	FileOperations::deleteRecursive(tmp);
+	FileOperations::mkdirp(tmp);
+	auto trace = tmp + "/trace.bin";
+	auto text = tmp + "/trace.txt";
+
+	Core core;
+	core.start(Core::MIN_NUM_RECORDS);
+	static constexpr size_t EXTRA = 5;
+	for (auto i : xrange(Core::MIN_NUM_RECORDS + EXTRA)) {
+		// nop at increasing addresses, 4 ticks apart
+		record(core, uint16_t(i), {0x00, 0x00, 0x00, 0x00}, 1000 + 4 * i);
+	}
+	core.stop();
+	CHECK(core.size() == Core::MIN_NUM_RECORDS);
+
+	core.save(trace);
+	auto bin = readFile(trace);
+	REQUIRE(bin.size() == Core::HEADER_SIZE + Core::MIN_NUM_RECORDS * sizeof(Core::Record));
+	CHECK(Endian::read_UA_L64(&bin[24]) == Core::MIN_NUM_RECORDS);
+	CHECK(Endian::read_UA_L64(&bin[32]) == 1000 + 4 * EXTRA); // time of the oldest kept record
+
+	// records are stored oldest first
+	for (auto i : xrange(Core::MIN_NUM_RECORDS)) {
+		const auto* r = &bin[Core::HEADER_SIZE + i * sizeof(Core::Record)];
+		REQUIRE(Endian::read_UA_L16(r + 4) == i + EXTRA); // pc
+	}
+
+	Core::decode(trace, text);
+	auto lines = readLines(text);
+	REQUIRE(lines.size() == Core::MIN_NUM_RECORDS);
+	CHECK(lines.front() == "0.000000296 0-0 0-2 0-3 1-0 0005 : 00          nop                ");
+	CHECK(lines.back()  == "0.000001487 0-0 0-2 0-3 1-0 0404 : 00          nop                ");
+
+	// a new recording starts empty
+	core.start(Core::MIN_NUM_RECORDS);
+	CHECK(core.size() == 0);
+
+	FileOperations::deleteRecursive(tmp);
+}
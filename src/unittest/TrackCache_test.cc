@@ -0,0 +1,51 @@
+#include "catch.hpp"
+#include "TrackCache.hh"
+#include "xrange.hh"
+
+using namespace openmsx;
+
+static RawTrack makeTrack(uint8_t track, uint8_t side)
+{
+	RawTrack result;
+	result.write(0, track);
+	result.write(1, side);
+	return result;
+}
+
+static bool check(TrackCache& cache, uint8_t track, uint8_t side)
+{
+	RawTrack output;
+	if (!cache.get(track, side, output)) return false;
+	CHECK(output.read(0) == track);
+	CHECK(output.read(1) == side);
+	return true;
+}
+
+TEST_CASE("TrackCache")
+{
+	TrackCache cache;
+	CHECK(!check(cache, 0, 0));
+
+	cache.put(0, 0, makeTrack(0, 0));
+	cache.put(0, 1, makeTrack(0, 1));
+	CHECK(check(cache, 0, 0));
+	CHECK(check(cache, 0, 1));
+	CHECK(!check(cache, 1, 0));
+
+	// fill the cache, track 0/0 is used most recently
+	for (auto t : xrange(size_t(1), TrackCache::NUM_ENTRIES - 1)) {
+		cache.put(uint8_t(t), 0, makeTrack(uint8_t(t), 0));
+	}
+	CHECK(check(cache, 0, 0));
+	// now track 0/1 is least recently used and gets evicted
+	cache.put(50, 0, makeTrack(50, 0));
+	cache.put(51, 0, makeTrack(51, 0));
+	CHECK(!check(cache, 0, 1));
+	CHECK(check(cache, 0, 0));
+	CHECK(check(cache, 50, 0));
+	CHECK(check(cache, 51, 0));
+
+	cache.clear();
+	CHECK(!check(cache, 0, 0));
+	CHECK(!check(cache, 50, 0));
+}
@@ -0,0 +1,206 @@
+#include "catch.hpp"
+
+#include "ZipFileAdapter.hh"
+#include "CompressedFileAdapter.hh"
+#include "File.hh"
+#include "FileException.hh"
+#include "FileOperations.hh"
+#include "FilePoolCore.hh"
+#include "Timer.hh"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace openmsx;
+
+// Created with python's zipfile module, contains:
+//  - 'a.txt'     (stored):   "stored member\n"
+//  - 'dir/'      (directory entry)
+//  - 'dir/b.txt' (deflated): "deflated deflated ... deflated \n"
+static constexpr std::array<uint8_t, 315> ZIP = {
+	0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x21, 0x00, 0xd3, 0x58, 0x52, 0xff, 0x0e, 0x00, 0x00, 0x00, 0x0e, 0x00,
+	0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x73,
+	0x74, 0x6f, 0x72, 0x65, 0x64, 0x20, 0x6d, 0x65, 0x6d, 0x62, 0x65, 0x72,
+	0x0a, 0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x64, 0x69, 0x72, 0x2f, 0x50,
+	0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21,
+	0x00, 0x00, 0x47, 0x50, 0xaf, 0x0f, 0x00, 0x00, 0x00, 0x49, 0x00, 0x00,
+	0x00, 0x09, 0x00, 0x00, 0x00, 0x64, 0x69, 0x72, 0x2f, 0x62, 0x2e, 0x74,
+	0x78, 0x74, 0x4b, 0x49, 0x4d, 0xcb, 0x49, 0x2c, 0x49, 0x4d, 0x51, 0x48,
+	0xa1, 0x8c, 0xc1, 0x05, 0x00, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0xd3, 0x58, 0x52,
+	0xff, 0x0e, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00,
+	0x00, 0x00, 0x00, 0x61, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x01, 0x02,
+	0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x80, 0x01, 0x31, 0x00, 0x00, 0x00, 0x64, 0x69, 0x72, 0x2f, 0x50, 0x4b,
+	0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+	0x21, 0x00, 0x00, 0x47, 0x50, 0xaf, 0x0f, 0x00, 0x00, 0x00, 0x49, 0x00,
+	0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x01, 0x53, 0x00, 0x00, 0x00, 0x64, 0x69, 0x72, 0x2f,
+	0x62, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x05, 0x06, 0x00, 0x00, 0x00,
+	0x00, 0x03, 0x00, 0x03, 0x00, 0x9c, 0x00, 0x00, 0x00, 0x89, 0x00, 0x00,
+	0x00, 0x00, 0x00,
+};
+static constexpr std::string_view MEMBER_A = "stored member\n";
+static constexpr std::string_view MEMBER_B =
+	"deflated deflated deflated deflated deflated deflated deflated deflated \n";
+
+static void createZip(const std::string& filename)
+{
+	std::ofstream of(filename, std::ios::binary);
+	of.write(reinterpret_cast<const char*>(ZIP.data()), ZIP.size());
+}
+
+static std::string readAll(File& file)
+{
+	auto data = file.mmap();
+	return {reinterpret_cast<const char*>(data.data()), data.size()};
+}
+
+TEST_CASE("ZipFileAdapter")
+{
+	auto tmp = FileOperations::getTempDir() + "/zipfile_unittest";
+	FileOperations::deleteRecursive(tmp);
+	FileOperations::mkdirp(tmp);
+	auto zip = tmp + "/test.zip";
+	createZip(zip);
+
+	SECTION("central directory") {
+		auto members = ZipFileAdapter::readCentralDirectory(ZIP);
+		REQUIRE(members.size() == 2); // directory is skipped
+		CHECK(members[0].name == "a.txt");
+		CHECK(members[0].method == 0);
+		CHECK(members[0].size == MEMBER_A.size());
+		CHECK(members[1].name == "dir/b.txt");
+		CHECK(members[1].method == 8);
+		CHECK(members[1].size == MEMBER_B.size());
+
+		CHECK(ZipFileAdapter::getMemberNames(zip) ==
+		      std::vector<std::string>{"a.txt", "dir/b.txt"});
+		CHECK(ZipFileAdapter::getMemberNames(tmp + "/not-there.zip").empty());
+	}
+	SECTION("split member name") {
+		auto split = ZipFileAdapter::splitMemberName(zip + "#dir/b.txt");
+		REQUIRE(split);
+		CHECK(split->first == zip);
+		CHECK(split->second == "dir/b.txt");
+		CHECK(!ZipFileAdapter::splitMemberName(zip));
+		CHECK(!ZipFileAdapter::splitMemberName(tmp + "/other.zip#a.txt"));
+
+		// only split off ZIP archives: '.zip' extension or ZIP header
+		auto text = tmp + "/foo";
+		std::ofstream(text) << "not a zip file";
+		CHECK(!ZipFileAdapter::splitMemberName(text + "#bar"));
+		auto renamed = tmp + "/zip-without-extension";
+		createZip(renamed);
+		CHECK(ZipFileAdapter::splitMemberName(renamed + "#a.txt"));
+	}
+	SECTION("writing never touches the archive") {
+		{
+			File file(zip + "#a.txt", File::TRUNCATE);
+			file.write(std::span{reinterpret_cast<const uint8_t*>("x"), 1});
+		}
+		auto st = FileOperations::getStat(zip);
+		REQUIRE(st);
+		CHECK(size_t(st->st_size) == ZIP.size());
+		CHECK(FileOperations::isRegularFile(zip + "#a.txt"));
+	}
+	SECTION("first member by default") {
+		File file(zip);
+		CHECK(file.getSize() == MEMBER_A.size());
+		CHECK(readAll(file) == MEMBER_A);
+		CHECK(file.getOriginalName() == "a.txt");
+		CHECK(file.getURL() == zip);
+	}
+	SECTION("stored member") {
+		File file(zip + "#a.txt");
+		CHECK(readAll(file) == MEMBER_A);
+		CHECK(file.getURL() == zip + "#a.txt");
+	}
+	SECTION("deflated member") {
+		File file(zip + "#dir/b.txt");
+		CHECK(file.getSize() == MEMBER_B.size());
+		std::string buf(MEMBER_B.size(), '\0');
+		file.read(std::span{reinterpret_cast<uint8_t*>(buf.data()), buf.size()});
+		CHECK(buf == MEMBER_B);
+		CHECK(file.getOriginalName() == "dir/b.txt");
+	}
+	SECTION("missing member") {
+		File file(zip + "#c.txt"); // the archive is only read on first access
+		CHECK_THROWS_AS(file.getSize(), FileException);
+	}
+
+	FileOperations::deleteRecursive(tmp);
+}
+
+TEST_CASE("FilePoolCore: ZIP archive members")
+{
+	auto tmp = FileOperations::getTempDir() + "/zippool_unittest";
+	FileOperations::deleteRecursive(tmp);
+	FileOperations::mkdirp(tmp + "/pool");
+	auto zip = tmp + "/pool/test.zip";
+	createZip(zip);
+
+	std::string poolDir = tmp + "/pool";
+	auto getDirectories = [&] {
+		FilePoolCore::Directories result;
+		result.emplace_back(poolDir, FileType::ROM);
+		return result;
+	};
+	FilePoolCore pool(tmp + "/cache", getDirectories,
+	                  [](std::string_view, float) { /* report progress: nothing */});
+
+	auto checkMembers = [&] {
+		auto fileA = pool.getFile(FileType::ROM, Sha1Sum("ef1e03d23baf20f1f808ac3fc9a8584e7a4e157b"));
+		REQUIRE(fileA.is_open());
+		CHECK(fileA.getURL() == zip + "#a.txt");
+		auto fileB = pool.getFile(FileType::ROM, Sha1Sum("dc4ba18140733310239e5cc3b42a53fb01fdedf6"));
+		REQUIRE(fileB.is_open());
+		CHECK(fileB.getURL() == zip + "#dir/b.txt");
+		CHECK(readAll(fileB) == MEMBER_B);
+	};
+
+	SECTION("scan") {
+		checkMembers();
+
+		// A lookup miss doesn't parse the unmodified archive again, the
+		// database entries of its members are used instead. Check this
+		// by replacing the content while keeping the modification time.
+		auto time = std::filesystem::last_write_time(zip);
+		std::ofstream(zip, std::ios::binary) << "not a zip file";
+		std::filesystem::last_write_time(zip, time);
+		CHECK(!pool.getFile(FileType::ROM, Sha1Sum("27f28d3be2c3894529015d25b073e8dc3fe2c75f")).is_open());
+
+		// drop the cached members of the replaced archive, a new archive
+		// with the same name and modification time would reuse them
+		CompressedFileAdapter::setCacheSize(0);
+		CompressedFileAdapter::setCacheSize(64 * 1024 * 1024);
+	}
+	SECTION("background indexing") {
+		auto indexAll = [&] {
+			pool.startIndexing();
+			while (true) {
+				auto progress = pool.processIndexResults();
+				if (progress.done) return progress;
+				Timer::sleep(1'000); // 1ms
+			}
+		};
+		auto progress = indexAll();
+		CHECK(progress.toHash == 1);
+		checkMembers();
+
+		// unmodified archive isn't hashed again
+		progress = indexAll();
+		CHECK(progress.scanned == 1);
+		CHECK(progress.toHash == 0);
+	}
+
+	FileOperations::deleteRecursive(tmp);
+}
@@ -0,0 +1,196 @@
+#include "catch.hpp"
+#include "ZlibInflate.hh"
+#include "FileException.hh"
+#include "MemBuffer.hh"
+#include "Timer.hh"
+#include "components.hh"
+#include "ranges.hh"
+#include "xrange.hh"
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+using namespace openmsx;
+
+// Raw deflate stream, as found in .gz and .zip files.
+static std::vector<uint8_t> deflateRaw(std::span<const uint8_t> input)
+{
+	z_stream s = {};
+	REQUIRE(deflateInit2(&s, 9, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	std::vector<uint8_t> result(deflateBound(&s, uLong(input.size())));
+	s.next_in = const_cast<uint8_t*>(input.data());
+	s.avail_in = uInt(input.size());
+	s.next_out = result.data();
+	s.avail_out = uInt(result.size());
+	REQUIRE(deflate(&s, Z_FINISH) == Z_STREAM_END);
+	result.resize(s.total_out);
+	deflateEnd(&s);
+	return result;
+}
+
+// zlib stream, as used for the blobs in savestates.
+static std::vector<uint8_t> compressZlib(std::span<const uint8_t> input)
+{
+	auto dstLen = compressBound(uLong(input.size()));
+	std::vector<uint8_t> result(dstLen);
+	REQUIRE(compress2(result.data(), &dstLen, input.data(), uLong(input.size()), 9) == Z_OK);
+	result.resize(dstLen);
+	return result;
+}
+
+// Something that resembles a 720kB disk image: boot sector and FAT, some
+// files (a mix of binary data and text) and mostly unused (formatted) space.
+static std::vector<uint8_t> makeDiskImage()
+{
+	std::vector<uint8_t> result(720 * 1024, 0xE5);
+	std::minstd_rand rng(42);
+	for (auto i : xrange(512)) result[i] = uint8_t(rng());
+	for (auto i : xrange(512, 512 + 3 * 1024)) result[i] = uint8_t(i / 3);
+	size_t pos = 14 * 512;
+	for (auto file : xrange(20)) {
+		auto size = 4096 + rng() % 16384;
+		bool text = (file % 2) == 0;
+		for (auto i : xrange(size)) {
+			(void)i;
+			result[pos++] = text ? uint8_t("  PRINT A$:GOTO 10\r\n"[rng() % 20])
+			                     : uint8_t(rng() % 64);
+		}
+	}
+	return result;
+}
+
+// Something that resembles the XML content of a savestate.
+static std::vector<uint8_t> makeSavestate()
+{
+	std::string xml = "<?xml version=\"1.0\" ?>\n<openmsx-serialize>\n";
+	std::minstd_rand rng(7);
+	while (xml.size() < 2 * 1024 * 1024) {
+		xml += "  <device id=\"";
+		xml += std::to_string(rng() % 100);
+		xml += "\"><clock><time>";
+		xml += std::to_string(rng());
+		xml += "</time></clock><data encoding=\"gz-base64\">";
+		for (auto i : xrange(100 + rng() % 400)) {
+			(void)i;
+			xml += "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[rng() % 64];
+		}
+		xml += "</data></device>\n";
+	}
+	xml += "</openmsx-serialize>\n";
+	return {xml.begin(), xml.end()};
+}
+
+TEST_CASE("ZlibInflate: inflate")
+{
+	auto check = [](std::span<const uint8_t> data, size_t sizeHint) {
+		auto compressed = deflateRaw(data);
+		ZlibInflate zlib(compressed);
+		MemBuffer<uint8_t> buf;
+		auto size = zlib.inflate(buf, sizeHint);
+		REQUIRE(size == data.size());
+		CHECK(ranges::equal(std::span{buf.data(), size}, data));
+	};
+
+	std::vector<uint8_t> empty;
+	check(empty, 0);
+	check(empty, 100);
+
+	auto disk = makeDiskImage();
+	check(disk, disk.size());     // exact size
+	check(disk, 0);               // no hint
+	check(disk, 1000);            // hint too small
+	check(disk, 2 * disk.size()); // hint too large
+	check(disk, size_t(1) << 40); // absurd hint (corrupt input), must not allocate that
+
+	auto state = makeSavestate();
+	check(state, state.size());
+}
+
+TEST_CASE("ZlibInflate: header and data")
+{
+	// e.g. gzip: first parse a header, then inflate the remainder
+	auto disk = makeDiskImage();
+	auto compressed = deflateRaw(disk);
+	std::vector<uint8_t> input = {0x12, 0x34, 0x56, 0x78, 'a', 'b', 0};
+	input.insert(input.end(), compressed.begin(), compressed.end());
+
+	ZlibInflate zlib(input);
+	CHECK(zlib.get32LE() == 0x78563412);
+	CHECK(zlib.getCString() == "ab");
+	MemBuffer<uint8_t> buf;
+	auto size = zlib.inflate(buf, disk.size());
+	REQUIRE(size == disk.size());
+	CHECK(ranges::equal(std::span{buf.data(), size}, disk));
+}
+
+TEST_CASE("ZlibInflate: corrupt data")
+{
+	auto disk = makeDiskImage();
+	auto compressed = deflateRaw(disk);
+	compressed.resize(compressed.size() / 2); // truncated
+	compressed.push_back(0xFF);
+	ZlibInflate zlib(compressed);
+	MemBuffer<uint8_t> buf;
+	CHECK_THROWS_AS(zlib.inflate(buf, disk.size()), FileException);
+}
+
+TEST_CASE("ZlibInflate: uncompress")
+{
+	auto disk = makeDiskImage();
+	auto compressed = compressZlib(disk);
+
+	std::vector<uint8_t> out(disk.size());
+	CHECK(ZlibInflate::uncompress(compressed, out));
+	CHECK(out == disk);
+
+	// the size of the output must match exactly
+	std::vector<uint8_t> tooSmall(disk.size() - 1);
+	CHECK(!ZlibInflate::uncompress(compressed, tooSmall));
+	std::vector<uint8_t> tooLarge(disk.size() + 1);
+	CHECK(!ZlibInflate::uncompress(compressed, tooLarge));
+
+	compressed[compressed.size() / 2] ^= 0x55;
+	CHECK(!ZlibInflate::uncompress(compressed, out));
+}
+
+// Not run by default, select explicitly with:  unittest "[benchmark]"
+TEST_CASE("ZlibInflate: throughput", "[.][benchmark]")
+{
+	std::cout << "inflate backend: " << (COMPONENT_FASTINFLATE ? "libdeflate" : "zlib") << '\n';
+
+	auto bench = [](const char* name, std::span<const uint8_t> data) {
+		auto compressed = deflateRaw(data);
+		static constexpr int ITERATIONS = 100;
+		for (size_t sizeHint : {data.size(), size_t(65536)}) {
+			MemBuffer<uint8_t> buf;
+			auto start = Timer::getTime();
+			for (auto i : xrange(ITERATIONS)) {
+				(void)i;
+				ZlibInflate zlib(compressed);
+				(void)zlib.inflate(buf, sizeHint);
+			}
+			auto duration = Timer::getTime() - start; // in us
+			std::cout << name << (sizeHint == data.size() ? " (exact size hint): " : " (default size hint): ")
+			          << double(ITERATIONS * data.size()) / double(duration) << " MB/s\n";
+		}
+	};
+	bench(".dsk.gz", makeDiskImage());
+	bench(".oms", makeSavestate());
+
+	// savestate blobs, e.g. 64kB of RAM
+	auto ram = makeDiskImage();
+	ram.resize(64 * 1024);
+	auto compressed = compressZlib(ram);
+	static constexpr int ITERATIONS = 1000;
+	auto start = Timer::getTime();
+	for (auto i : xrange(ITERATIONS)) {
+		(void)i;
+		(void)ZlibInflate::uncompress(compressed, ram);
+	}
+	auto duration = Timer::getTime() - start; // in us
+	std::cout << "savestate blob: " << double(ITERATIONS * ram.size()) / double(duration) << " MB/s\n";
+}
@@ -2,12 +2,15 @@
 
 #include "sha1.hh"
 
+#include "Timer.hh"
 #include "ranges.hh"
 #include "xrange.hh"
 
 #include <bit>
 #include <cstring>
+#include <iostream>
 #include <sstream>
+#include <vector>
 
 using namespace openmsx;
 
@@ -181,3 +184,50 @@ TEST_CASE("sha1: finalize")
 		CHECK(sum.toString() == "0098ba824b5c16427bd7a1122a5a442a25ec644d");
 	}
 }
+
+static std::vector<uint8_t> makeTestData(size_t size)
+{
+	std::vector<uint8_t> result(size);
+	for (auto i : xrange(size)) {
+		result[i] = uint8_t(i * 7 + (i >> 8));
+	}
+	return result;
+}
+
+TEST_CASE("sha1: many blocks")
+{
+	// exercises the loop over multiple blocks in one transform() call
+	auto data = makeTestData(100'000);
+	const char* expected = "557878b8118e7a9bdc75bcfc419f9b082ce073e6";
+
+	SECTION("in one go") {
+		CHECK(SHA1::calc(data).toString() == expected);
+	}
+	SECTION("in chunks") {
+		SHA1 sha1;
+		size_t pos = 0;
+		for (size_t chunk = 1; pos < data.size(); chunk = chunk * 3 + 1) {
+			auto len = std::min(chunk, data.size() - pos);
+			sha1.update(std::span{data}.subspan(pos, len));
+			pos += len;
+		}
+		CHECK(sha1.digest().toString() == expected);
+	}
+}
+
+// Not run by default, select explicitly with:  unittest "[benchmark]"
+TEST_CASE("sha1: throughput", "[.][benchmark]")
+{
+	auto data = makeTestData(64 * 1024 * 1024);
+	for (size_t size : {size_t(16 * 1024), size_t(1024 * 1024), data.size()}) {
+		auto iterations = data.size() / size;
+		auto start = Timer::getTime();
+		Sha1Sum sum;
+		for (auto i : xrange(iterations)) {
+			sum = SHA1::calc(std::span{data}.subspan(i * size, size));
+		}
+		auto duration = Timer::getTime() - start; // in us
+		std::cout << "sha1 " << size / 1024 << "kB blocks: "
+		          << double(data.size()) / double(duration) << " MB/s (" << sum << ")\n";
+	}
+}
@@ -29,10 +29,19 @@ A million repetitions of "a"
 #include <bit>
 #include <cassert>
 #include <cstring>
+#include <utility>
 #ifdef __SSE2__
 #include <emmintrin.h> // SSE2
 #endif
 
+// Use the SHA extensions (SHA-NI) when the CPU supports them. Detected at
+// run-time, so a generic build can still use them.
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(_MSC_VER)
+#define OPENMSX_SHA_NI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 namespace openmsx {
 
 // Rotate x bits to the left
@@ -94,6 +103,152 @@ WorkspaceBlock::WorkspaceBlock(std::span<const uint8_t, 64> buffer)
 	memcpy(data.data(), buffer.data(), sizeof(data));
 }
 
+using SHA1State = std::array<uint32_t, 5>;
+
+// Portable version, processes one 64-byte block.
+static void transformBlock(SHA1State& state, std::span<const uint8_t, 64> buffer)
+{
+	WorkspaceBlock block(buffer);
+
+	// Copy state[] to working vars
+	uint32_t a = state[0];
+	uint32_t b = state[1];
+	uint32_t c = state[2];
+	uint32_t d = state[3];
+	uint32_t e = state[4];
+
+	// 4 rounds of 20 operations each. Loop unrolled
+	block.r0(a,b,c,d,e, 0); block.r0(e,a,b,c,d, 1); block.r0(d,e,a,b,c, 2);
+	block.r0(c,d,e,a,b, 3); block.r0(b,c,d,e,a, 4); block.r0(a,b,c,d,e, 5);
+	block.r0(e,a,b,c,d, 6); block.r0(d,e,a,b,c, 7); block.r0(c,d,e,a,b, 8);
+	block.r0(b,c,d,e,a, 9); block.r0(a,b,c,d,e,10); block.r0(e,a,b,c,d,11);
+	block.r0(d,e,a,b,c,12); block.r0(c,d,e,a,b,13); block.r0(b,c,d,e,a,14);
+	block.r0(a,b,c,d,e,15); block.r1(e,a,b,c,d,16); block.r1(d,e,a,b,c,17);
+	block.r1(c,d,e,a,b,18); block.r1(b,c,d,e,a,19); block.r2(a,b,c,d,e,20);
+	block.r2(e,a,b,c,d,21); block.r2(d,e,a,b,c,22); block.r2(c,d,e,a,b,23);
+	block.r2(b,c,d,e,a,24); block.r2(a,b,c,d,e,25); block.r2(e,a,b,c,d,26);
+	block.r2(d,e,a,b,c,27); block.r2(c,d,e,a,b,28); block.r2(b,c,d,e,a,29);
+	block.r2(a,b,c,d,e,30); block.r2(e,a,b,c,d,31); block.r2(d,e,a,b,c,32);
+	block.r2(c,d,e,a,b,33); block.r2(b,c,d,e,a,34); block.r2(a,b,c,d,e,35);
+	block.r2(e,a,b,c,d,36); block.r2(d,e,a,b,c,37); block.r2(c,d,e,a,b,38);
+	block.r2(b,c,d,e,a,39); block.r3(a,b,c,d,e,40); block.r3(e,a,b,c,d,41);
+	block.r3(d,e,a,b,c,42); block.r3(c,d,e,a,b,43); block.r3(b,c,d,e,a,44);
+	block.r3(a,b,c,d,e,45); block.r3(e,a,b,c,d,46); block.r3(d,e,a,b,c,47);
+	block.r3(c,d,e,a,b,48); block.r3(b,c,d,e,a,49); block.r3(a,b,c,d,e,50);
+	block.r3(e,a,b,c,d,51); block.r3(d,e,a,b,c,52); block.r3(c,d,e,a,b,53);
+	block.r3(b,c,d,e,a,54); block.r3(a,b,c,d,e,55); block.r3(e,a,b,c,d,56);
+	block.r3(d,e,a,b,c,57); block.r3(c,d,e,a,b,58); block.r3(b,c,d,e,a,59);
+	block.r4(a,b,c,d,e,60); block.r4(e,a,b,c,d,61); block.r4(d,e,a,b,c,62);
+	block.r4(c,d,e,a,b,63); block.r4(b,c,d,e,a,64); block.r4(a,b,c,d,e,65);
+	block.r4(e,a,b,c,d,66); block.r4(d,e,a,b,c,67); block.r4(c,d,e,a,b,68);
+	block.r4(b,c,d,e,a,69); block.r4(a,b,c,d,e,70); block.r4(e,a,b,c,d,71);
+	block.r4(d,e,a,b,c,72); block.r4(c,d,e,a,b,73); block.r4(b,c,d,e,a,74);
+	block.r4(a,b,c,d,e,75); block.r4(e,a,b,c,d,76); block.r4(d,e,a,b,c,77);
+	block.r4(c,d,e,a,b,78); block.r4(b,c,d,e,a,79);
+
+	// Add the working vars back into state[]
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+}
+
+static void transformPortable(SHA1State& state, std::span<const uint8_t> blocks)
+{
+	assert((blocks.size() % 64) == 0);
+	for (size_t i = 0; i < blocks.size(); i += 64) {
+		transformBlock(state, subspan<64>(blocks, i));
+	}
+}
+
+#ifdef OPENMSX_SHA_NI
+struct ShaNiState {
+	__m128i abcd;   // a,b,c,d in reversed order
+	__m128i e[2];   // (rotated) 'e' alternates between these two
+	__m128i msg[4]; // rotating window of the message schedule, 4 words each
+	// (plain arrays because std::array<__m128i> triggers -Wignored-attributes)
+};
+
+// Four (out of 80) rounds per step. The message schedule is calculated just in
+// time. This follows the instruction sequence described in Intel's "New
+// Instructions Supporting the Secure Hash Algorithm on Intel Architecture
+// Processors" whitepaper.
+template<int STEP>
+[[gnu::target("sha,sse4.1")]] static inline void shaNiStep(ShaNiState& s, const uint8_t* block)
+{
+	const __m128i bswap = _mm_set_epi64x(0x0001020304050607, 0x08090a0b0c0d0e0f);
+	auto& m  = s.msg[STEP % 4];
+	auto& e0 = s.e[STEP % 2];
+	auto& e1 = s.e[(STEP + 1) % 2];
+
+	if constexpr (STEP < 4) {
+		m = _mm_shuffle_epi8(_mm_loadu_si128(std::bit_cast<const __m128i*>(block + 16 * STEP)), bswap);
+	}
+	if constexpr (STEP == 0) {
+		e0 = _mm_add_epi32(e0, m);
+	} else {
+		e0 = _mm_sha1nexte_epu32(e0, m);
+	}
+	e1 = s.abcd;
+	if constexpr (3 <= STEP && STEP <= 18) {
+		s.msg[(STEP + 1) % 4] = _mm_sha1msg2_epu32(s.msg[(STEP + 1) % 4], m);
+	}
+	s.abcd = _mm_sha1rnds4_epu32(s.abcd, e0, STEP / 5);
+	if constexpr (1 <= STEP && STEP <= 16) {
+		s.msg[(STEP + 3) % 4] = _mm_sha1msg1_epu32(s.msg[(STEP + 3) % 4], m);
+	}
+	if constexpr (2 <= STEP && STEP <= 17) {
+		s.msg[(STEP + 2) % 4] = _mm_xor_si128(s.msg[(STEP + 2) % 4], m);
+	}
+}
+
+template<int... STEPS>
+[[gnu::target("sha,sse4.1")]] static inline void shaNiBlock(
+	std::integer_sequence<int, STEPS...>, ShaNiState& s, const uint8_t* block)
+{
+	(shaNiStep<STEPS>(s, block), ...);
+}
+
+[[gnu::target("sha,sse4.1")]] static void transformShaNi(SHA1State& state, std::span<const uint8_t> blocks)
+{
+	assert((blocks.size() % 64) == 0);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(std::bit_cast<const __m128i*>(state.data())), 0x1b);
+	__m128i e = _mm_set_epi32(narrow_cast<int>(state[4]), 0, 0, 0);
+
+	for (size_t i = 0; i < blocks.size(); i += 64) {
+		ShaNiState s;
+		s.abcd = abcd;
+		s.e[0] = e;
+		shaNiBlock(std::make_integer_sequence<int, 20>{}, s, &blocks[i]);
+		// after the last step, s.e[0] holds the value to add to 'e'
+		e = _mm_sha1nexte_epu32(s.e[0], e);
+		abcd = _mm_add_epi32(s.abcd, abcd);
+	}
+
+	_mm_storeu_si128(std::bit_cast<__m128i*>(state.data()), _mm_shuffle_epi32(abcd, 0x1b));
+	state[4] = narrow_cast<uint32_t>(_mm_extract_epi32(e, 3));
+}
+
+[[nodiscard]] static bool cpuHasShaNi()
+{
+	unsigned eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+	if (!(ecx & bit_SSE4_1)) return false;
+	if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+	return ebx & (1 << 29); // SHA
+}
+#endif
+
+using TransformFunc = void(*)(SHA1State&, std::span<const uint8_t>);
+[[nodiscard]] static TransformFunc selectTransform()
+{
+#ifdef OPENMSX_SHA_NI
+	if (cpuHasShaNi()) return transformShaNi;
+#endif
+	return transformPortable;
+}
+
 
 // class Sha1Sum
 
@@ -265,52 +420,10 @@ SHA1::SHA1()
 	m_state.a[4] = 0xC3D2E1F0;
 }
 
-void SHA1::transform(std::span<const uint8_t, 64> buffer)
+void SHA1::transform(std::span<const uint8_t> blocks)
 {
-	WorkspaceBlock block(buffer);
-
-	// Copy m_state[] to working vars
-	uint32_t a = m_state.a[0];
-	uint32_t b = m_state.a[1];
-	uint32_t c = m_state.a[2];
-	uint32_t d = m_state.a[3];
-	uint32_t e = m_state.a[4];
-
-	// 4 rounds of 20 operations each. Loop unrolled
-	block.r0(a,b,c,d,e, 0); block.r0(e,a,b,c,d, 1); block.r0(d,e,a,b,c, 2);
-	block.r0(c,d,e,a,b, 3); block.r0(b,c,d,e,a, 4); block.r0(a,b,c,d,e, 5);
-	block.r0(e,a,b,c,d, 6); block.r0(d,e,a,b,c, 7); block.r0(c,d,e,a,b, 8);
-	block.r0(b,c,d,e,a, 9); block.r0(a,b,c,d,e,10); block.r0(e,a,b,c,d,11);
-	block.r0(d,e,a,b,c,12); block.r0(c,d,e,a,b,13); block.r0(b,c,d,e,a,14);
-	block.r0(a,b,c,d,e,15); block.r1(e,a,b,c,d,16); block.r1(d,e,a,b,c,17);
-	block.r1(c,d,e,a,b,18); block.r1(b,c,d,e,a,19); block.r2(a,b,c,d,e,20);
-	block.r2(e,a,b,c,d,21); block.r2(d,e,a,b,c,22); block.r2(c,d,e,a,b,23);
-	block.r2(b,c,d,e,a,24); block.r2(a,b,c,d,e,25); block.r2(e,a,b,c,d,26);
-	block.r2(d,e,a,b,c,27); block.r2(c,d,e,a,b,28); block.r2(b,c,d,e,a,29);
-	block.r2(a,b,c,d,e,30); block.r2(e,a,b,c,d,31); block.r2(d,e,a,b,c,32);
-	block.r2(c,d,e,a,b,33); block.r2(b,c,d,e,a,34); block.r2(a,b,c,d,e,35);
-	block.r2(e,a,b,c,d,36); block.r2(d,e,a,b,c,37); block.r2(c,d,e,a,b,38);
-	block.r2(b,c,d,e,a,39); block.r3(a,b,c,d,e,40); block.r3(e,a,b,c,d,41);
-	block.r3(d,e,a,b,c,42); block.r3(c,d,e,a,b,43); block.r3(b,c,d,e,a,44);
-	block.r3(a,b,c,d,e,45); block.r3(e,a,b,c,d,46); block.r3(d,e,a,b,c,47);
-	block.r3(c,d,e,a,b,48); block.r3(b,c,d,e,a,49); block.r3(a,b,c,d,e,50);
-	block.r3(e,a,b,c,d,51); block.r3(d,e,a,b,c,52); block.r3(c,d,e,a,b,53);
-	block.r3(b,c,d,e,a,54); block.r3(a,b,c,d,e,55); block.r3(e,a,b,c,d,56);
-	block.r3(d,e,a,b,c,57); block.r3(c,d,e,a,b,58); block.r3(b,c,d,e,a,59);
-	block.r4(a,b,c,d,e,60); block.r4(e,a,b,c,d,61); block.r4(d,e,a,b,c,62);
-	block.r4(c,d,e,a,b,63); block.r4(b,c,d,e,a,64); block.r4(a,b,c,d,e,65);
-	block.r4(e,a,b,c,d,66); block.r4(d,e,a,b,c,67); block.r4(c,d,e,a,b,68);
-	block.r4(b,c,d,e,a,69); block.r4(a,b,c,d,e,70); block.r4(e,a,b,c,d,71);
-	block.r4(d,e,a,b,c,72); block.r4(c,d,e,a,b,73); block.r4(b,c,d,e,a,74);
-	block.r4(a,b,c,d,e,75); block.r4(e,a,b,c,d,76); block.r4(d,e,a,b,c,77);
-	block.r4(c,d,e,a,b,78); block.r4(b,c,d,e,a,79);
-
-	// Add the working vars back into m_state[]
-	m_state.a[0] += a;
-	m_state.a[1] += b;
-	m_state.a[2] += c;
-	m_state.a[3] += d;
-	m_state.a[4] += e;
+	static const TransformFunc func = selectTransform();
+	func(m_state.a, blocks);
 }
 
 // Use this function to hash in binary data and strings
@@ -327,9 +440,9 @@ void SHA1::update(std::span<const uint8_t> data)
 		i = 64 - j;
 		ranges::copy(data.subspan(0, i), subspan(m_buffer, j));
 		transform(m_buffer);
-		for (/**/; i + 63 < len; i += 64) {
-			transform(subspan<64>(data, i));
-		}
+		size_t n = (len - i) & ~size_t(63); // all remaining full blocks
+		transform(data.subspan(i, n));
+		i += n;
 		j = 0;
 	} else {
 		i = 0;
@@ -93,7 +93,7 @@ public:
 	[[nodiscard]] static Sha1Sum calc(std::span<const uint8_t> data);
 
 private:
-	void transform(std::span<const uint8_t, 64> buffer);
+	void transform(std::span<const uint8_t> blocks); // size must be a multiple of 64
 	void finalize();
 
 private:
@@ -69,13 +69,18 @@ unsigned ADVram::calcAddress(word address) const
 
 byte ADVram::readMem(word address, EmuTime::param time)
 {
-	return enabled ? vram->cpuRead(calcAddress(address), time) : 0xFF;
+	if (!enabled) return 0xFF;
+	auto addr = calcAddress(address);
+	vram->countCpuAccess(AccessStats::Type::READ, addr);
+	return vram->cpuRead(addr, time);
 }
 
 void ADVram::writeMem(word address, byte value, EmuTime::param time)
 {
 	if (enabled) {
-		vram->cpuWrite(calcAddress(address), value, time);
+		auto addr = calcAddress(address);
+		vram->countCpuAccess(AccessStats::Type::WRITE, addr);
+		vram->cpuWrite(addr, value, time);
 	}
 }
 
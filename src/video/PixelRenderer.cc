@@ -20,6 +20,7 @@ TODO:
 #include "SpeedManager.hh"
 #include "ThrottleManager.hh"
 #include "GlobalSettings.hh"
+#include "HostProfiler.hh"
 #include "MSXMotherBoard.hh"
 #include "Reactor.hh"
 #include "Timer.hh"
@@ -35,6 +36,7 @@ namespace openmsx {
 void PixelRenderer::draw(
 	int startX, int startY, int endX, int endY, DrawType drawType, bool atEnd)
 {
+	HostProfiler::Scope scope(HostProfiler::Category::RENDER, *rasterizer);
 	if (drawType == DRAW_BORDER) {
 		rasterizer->drawBorder(startX, startY, endX, endY);
 	} else {
@@ -218,6 +220,8 @@ void PixelRenderer::frameStart(EmuTime::param time)
 
 void PixelRenderer::frameEnd(EmuTime::param time)
 {
+	HostProfiler::frameEnd();
+
 	if (renderFrame) {
 		// Render changes from this last frame.
 		sync(time, true);
@@ -11,6 +11,7 @@ TODO:
 #include "SpriteChecker.hh"
 #include "RenderSettings.hh"
 #include "BooleanSetting.hh"
+#include "outer.hh"
 #include "serialize.hh"
 #include <algorithm>
 #include <bit>
@@ -24,8 +25,8 @@ SpriteChecker::SpriteChecker(VDP& vdp_, RenderSettings& renderSettings,
 	, limitSpritesSetting(renderSettings.getLimitSpritesSetting())
 	, frameStartTime(time)
 {
-	vram.spriteAttribTable.setObserver(this);
-	vram.spritePatternTable.setObserver(this);
+	vram.spriteAttribTable.setObserver(&attribTableObserver);
+	vram.spritePatternTable.setObserver(&patternTableObserver);
 }
 
 void SpriteChecker::reset(EmuTime::param time)
@@ -37,6 +38,40 @@ void SpriteChecker::reset(EmuTime::param time)
 	frameStart(time);
 
 	updateSpritesMethod = &SpriteChecker::updateSprites1;
+	planar = false;
+	invalidateCaches(); // VRAM was cleared
+}
+
+void SpriteChecker::AttribTableObserver::updateVRAM(
+	unsigned /*offset*/, EmuTime::param time)
+{
+	auto& checker = OUTER(SpriteChecker, attribTableObserver);
+	checker.checkUntil(time);
+	checker.attribCacheSize = -1;
+}
+
+void SpriteChecker::AttribTableObserver::updateWindow(
+	bool /*enabled*/, EmuTime::param time)
+{
+	auto& checker = OUTER(SpriteChecker, attribTableObserver);
+	checker.sync(time);
+	checker.attribCacheSize = -1;
+}
+
+void SpriteChecker::PatternTableObserver::updateVRAM(
+	unsigned /*offset*/, EmuTime::param time)
+{
+	auto& checker = OUTER(SpriteChecker, patternTableObserver);
+	checker.checkUntil(time);
+	checker.patternCacheValid.reset();
+}
+
+void SpriteChecker::PatternTableObserver::updateWindow(
+	bool /*enabled*/, EmuTime::param time)
+{
+	auto& checker = OUTER(SpriteChecker, patternTableObserver);
+	checker.sync(time);
+	checker.patternCacheValid.reset();
 }
 
 inline SpriteChecker::SpritePattern SpriteChecker::calculatePatternNP(
@@ -63,6 +98,70 @@ inline SpriteChecker::SpritePattern SpriteChecker::calculatePatternPlanar(
 	}
 	return !vdp.isSpriteMag() ? pattern : doublePattern(pattern);
 }
+inline SpriteChecker::SpritePattern SpriteChecker::getPattern(
+	unsigned patternNr, unsigned y)
+{
+	unsigned index = patternNr * 8 + y;
+	if (!patternCacheValid[index]) {
+		patternCache[index] = planar ? calculatePatternPlanar(patternNr, y)
+		                             : calculatePatternNP(patternNr, y);
+		patternCacheValid[index] = true;
+	}
+	return patternCache[index];
+}
+
+inline std::span<const SpriteChecker::SpriteAttribute> SpriteChecker::getAttributes1()
+{
+	if (attribCacheSize < 0) {
+		auto attributePtr = vram.spriteAttribTable.getReadArea<32 * 4>(0);
+		byte patternIndexMask = vdp.getSpriteSize() == 16 ? 0xFC : 0xFF;
+		int sprite = 0;
+		for (/**/; sprite < 32; ++sprite) {
+			byte y = attributePtr[4 * sprite + 0];
+			if (y == 208) break;
+			auto& attr = attribCache[sprite];
+			attr.y = y;
+			attr.x = attributePtr[4 * sprite + 1];
+			attr.patternNr = attributePtr[4 * sprite + 2] & patternIndexMask;
+			attr.colorAttrib = attributePtr[4 * sprite + 3];
+			if (attr.colorAttrib & 0x80) attr.x -= 32;
+		}
+		attribCacheSize = sprite;
+	}
+	return subspan(attribCache, 0, attribCacheSize);
+}
+inline std::span<const SpriteChecker::SpriteAttribute> SpriteChecker::getAttributes2()
+{
+	if (attribCacheSize < 0) {
+		byte patternIndexMask = vdp.getSpriteSize() == 16 ? 0xFC : 0xFF;
+		int sprite = 0;
+		if (planar) {
+			auto [attributePtr0, attributePtr1] =
+				vram.spriteAttribTable.getReadAreaPlanar<32 * 4>(512);
+			for (/**/; sprite < 32; ++sprite) {
+				byte y = attributePtr0[2 * sprite + 0];
+				if (y == 216) break;
+				auto& attr = attribCache[sprite];
+				attr.y = y;
+				attr.x = attributePtr1[2 * sprite + 0];
+				attr.patternNr = attributePtr0[2 * sprite + 1] & patternIndexMask;
+			}
+		} else {
+			auto attributePtr0 =
+				vram.spriteAttribTable.getReadArea<32 * 4>(512);
+			for (/**/; sprite < 32; ++sprite) {
+				byte y = attributePtr0[4 * sprite + 0];
+				if (y == 216) break;
+				auto& attr = attribCache[sprite];
+				attr.y = y;
+				attr.x = attributePtr0[4 * sprite + 1];
+				attr.patternNr = attributePtr0[4 * sprite + 2] & patternIndexMask;
+			}
+		}
+		attribCacheSize = sprite;
+	}
+	return subspan(attribCache, 0, attribCacheSize);
+}
 
 void SpriteChecker::updateSprites1(int limit)
 {
@@ -109,15 +208,14 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
 	int magSize = (mag + 1) * size;
-	auto attributePtr = vram.spriteAttribTable.getReadArea<32 * 4>(0);
-	byte patternIndexMask = size == 16 ? 0xFC : 0xFF;
+	auto attributes = getAttributes1();
 	int fifthSpriteNum  = -1;  // no 5th sprite detected yet
 	int fifthSpriteLine = 999; // larger than any possible valid line
 
 	int sprite = 0;
-	for (/**/; sprite < 32; ++sprite) {
-		int y = attributePtr[4 * sprite + 0];
-		if (y == 208) break;
+	for (/**/; sprite < int(attributes.size()); ++sprite) {
+		const auto& attr = attributes[sprite];
+		int y = attr.y;
 
 		for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
 			// Calculate line number within the sprite.
@@ -140,13 +238,10 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 			}
 
 			SpriteInfo& sip = spriteBuffer[line][visibleIndex];
-			int patternIndex = attributePtr[4 * sprite + 2] & patternIndexMask;
 			if (mag) spriteLine /= 2;
-			sip.pattern = calculatePatternNP(patternIndex, spriteLine);
-			sip.x = attributePtr[4 * sprite + 1];
-			byte colorAttrib = attributePtr[4 * sprite + 3];
-			if (colorAttrib & 0x80) sip.x -= 32;
-			sip.colorAttrib = colorAttrib;
+			sip.pattern = getPattern(attr.patternNr, spriteLine);
+			sip.x = attr.x;
+			sip.colorAttrib = attr.colorAttrib;
 
 			spriteCount[line] = visibleIndex + 1;
 		}
@@ -187,52 +282,22 @@ inline void SpriteChecker::checkSprites1(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow,
-	but there are max 4 sprites and therefore max 6 pairs.
-	If any collision is found, method returns at once.
+	Implemented by accumulating the sprite patterns in a per-line bitmap,
+	see findCollision().
 	*/
 	bool can0collide = vdp.canSpriteColor0Collide();
 	for (auto line : xrange(minLine, maxLine)) {
-		int minXCollision = 999;
-		for (int i = std::min<int>(4, spriteCount[line]); --i >= 1; /**/) {
-			auto color1 = spriteBuffer[line][i].colorAttrib & 0xf;
-			if (!can0collide && (color1 == 0)) continue;
-			int x_i = spriteBuffer[line][i].x;
-			SpritePattern pattern_i = spriteBuffer[line][i].pattern;
-			for (int j = i; --j >= 0; /**/) {
-				auto color2 = spriteBuffer[line][j].colorAttrib & 0xf;
-				if (!can0collide && (color2 == 0)) continue;
-				// Do sprite i and sprite j collide?
-				int x_j = spriteBuffer[line][j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = spriteBuffer[line][j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + std::countl_zero(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
+		int count = std::min<int>(4, spriteCount[line]);
+		if (count < 2) continue;
+		int xCollision = findCollision(subspan(spriteBuffer[line], 0, count),
+		                               0x00, can0collide);
+		if (xCollision >= 0) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// verified: collision coords are also filled
 			//           in for sprite mode 1
 			// x-coord should be increased by 12
 			// y-coord                         8
-			collisionX = minXCollision + 12;
+			collisionX = xCollision + 12;
 			collisionY = line - vdp.getLineZero() + 8;
 			return; // don't check lines with higher Y-coord
 		}
@@ -271,114 +336,66 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	int size = vdp.getSpriteSize();
 	bool mag = vdp.isSpriteMag();
 	int magSize = (mag + 1) * size;
-	int patternIndexMask = (size == 16) ? 0xFC : 0xFF;
+	auto attributes = getAttributes2();
 	int ninthSpriteNum  = -1;  // no 9th sprite detected yet
 	int ninthSpriteLine = 999; // larger than any possible valid line
 
-	// Because it gave a measurable performance boost, we duplicated the
-	// code for planar and non-planar modes.
+	// The attribute table layout (planar or not) is already handled by
+	// getAttributes2() and the pattern layout by getPattern(). Only the
+	// (per line) color attributes are still read directly from VRAM.
 	int sprite = 0;
-	if (planar) {
-		auto [attributePtr0, attributePtr1] =
-			vram.spriteAttribTable.getReadAreaPlanar<32 * 4>(512);
-		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[2 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
-				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
+	// TODO: Verify CC implementation.
+	for (/**/; sprite < int(attributes.size()); ++sprite) {
+		const auto& attr = attributes[sprite];
+		int y = attr.y;
 
-				auto visibleIndex = spriteCount[line];
-				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
-						ninthSpriteNum = sprite;
-					}
-					if (limitSprites) continue;
-				}
-
-				if (mag) spriteLine /= 2;
-				unsigned colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
-				byte colorAttrib =
-					vram.spriteAttribTable.readPlanar(colorIndex);
-
-				SpriteInfo& sip = spriteBuffer[line][visibleIndex];
-				int patternIndex = attributePtr0[2 * sprite + 1] & patternIndexMask;
-				sip.pattern = calculatePatternPlanar(patternIndex, spriteLine);
-				sip.x = attributePtr1[2 * sprite + 0];
-				if (colorAttrib & 0x80) sip.x -= 32;
-				sip.colorAttrib = colorAttrib;
-
-				// set sentinel (see below)
-				spriteBuffer[line][visibleIndex + 1].colorAttrib = 0;
-				spriteCount[line] = visibleIndex + 1;
+		for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
+			// Calculate line number within the sprite.
+			int displayLine = line + displayDelta;
+			int spriteLine = (displayLine - y) & 0xFF;
+			if (spriteLine >= magSize) {
+				// Skip ahead till sprite is visible.
+				line += 256 - spriteLine - 1;
+				continue;
 			}
-		}
-	} else {
-		auto attributePtr0 =
-			vram.spriteAttribTable.getReadArea<32 * 4>(512);
-		// TODO: Verify CC implementation.
-		for (/**/; sprite < 32; ++sprite) {
-			int y = attributePtr0[4 * sprite + 0];
-			if (y == 216) break;
-
-			for (int line = minLine; line < maxLine; ++line) { // 'line' changes in loop
-				// Calculate line number within the sprite.
-				int displayLine = line + displayDelta;
-				int spriteLine = (displayLine - y) & 0xFF;
-				if (spriteLine >= magSize) {
-					// Skip ahead till sprite is visible.
-					line += 256 - spriteLine - 1;
-					continue;
-				}
 
-				auto visibleIndex = spriteCount[line];
-				if (visibleIndex == 8) {
-					// Find earliest line where this condition occurs.
-					if (line < ninthSpriteLine) {
-						ninthSpriteLine = line;
-						ninthSpriteNum = sprite;
-					}
-					if (limitSprites) continue;
+			auto visibleIndex = spriteCount[line];
+			if (visibleIndex == 8) {
+				// Find earliest line where this condition occurs.
+				if (line < ninthSpriteLine) {
+					ninthSpriteLine = line;
+					ninthSpriteNum = sprite;
 				}
-
-				if (mag) spriteLine /= 2;
-				unsigned colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
-				byte colorAttrib =
-					vram.spriteAttribTable.readNP(colorIndex);
-				// Sprites with CC=1 are only visible if preceded by
-				// a sprite with CC=0. However they DO contribute towards
-				// the max-8-sprites-per-line limit, so we can't easily
-				// filter them here. See also
-				//    https://github.com/openMSX/openMSX/issues/497
-
-				SpriteInfo& sip = spriteBuffer[line][visibleIndex];
-				int patternIndex = attributePtr0[4 * sprite + 2] & patternIndexMask;
-				sip.pattern = calculatePatternNP(patternIndex, spriteLine);
-				sip.x = attributePtr0[4 * sprite + 1];
-				if (colorAttrib & 0x80) sip.x -= 32;
-				sip.colorAttrib = colorAttrib;
-
-				// Set sentinel. Sentinel is actually only
-				// needed for sprites with CC=1.
-				// In the past we set the sentinel (for all
-				// lines) at the end. But it's slightly faster
-				// to do it only for lines that actually
-				// contain sprites (even if sentinel gets
-				// overwritten a couple of times for lines with
-				// many sprites).
-				spriteBuffer[line][visibleIndex + 1].colorAttrib = 0;
-				spriteCount[line] = visibleIndex + 1;
+				if (limitSprites) continue;
 			}
+
+			if (mag) spriteLine /= 2;
+			unsigned colorIndex = (~0u << 10) | (sprite * 16 + spriteLine);
+			byte colorAttrib = planar
+				? vram.spriteAttribTable.readPlanar(colorIndex)
+				: vram.spriteAttribTable.readNP(colorIndex);
+			// Sprites with CC=1 are only visible if preceded by
+			// a sprite with CC=0. However they DO contribute towards
+			// the max-8-sprites-per-line limit, so we can't easily
+			// filter them here. See also
+			//    https://github.com/openMSX/openMSX/issues/497
+
+			SpriteInfo& sip = spriteBuffer[line][visibleIndex];
+			sip.pattern = getPattern(attr.patternNr, spriteLine);
+			sip.x = attr.x;
+			if (colorAttrib & 0x80) sip.x -= 32;
+			sip.colorAttrib = colorAttrib;
+
+			// Set sentinel. Sentinel is actually only
+			// needed for sprites with CC=1.
+			// In the past we set the sentinel (for all
+			// lines) at the end. But it's slightly faster
+			// to do it only for lines that actually
+			// contain sprites (even if sentinel gets
+			// overwritten a couple of times for lines with
+			// many sprites).
+			spriteBuffer[line][visibleIndex + 1].colorAttrib = 0;
+			spriteCount[line] = visibleIndex + 1;
 		}
 	}
 
@@ -419,64 +436,74 @@ inline void SpriteChecker::checkSprites2(int minLine, int maxLine)
 	  they can collide in the V9958 extra border mask. This behaviour is
 	  the same in sprite mode 1 and 2.
 
-	Implemented by checking every pair for collisions.
-	For large numbers of sprites that would be slow.
-	There are max 8 sprites and therefore max 42 pairs.
-	  TODO: Maybe this is slow... Think of something faster.
-	        Probably new approach is needed anyway for OR-ing.
+	Implemented by accumulating the sprite patterns in a per-line bitmap,
+	see findCollision().
 	*/
 	bool can0collide = vdp.canSpriteColor0Collide();
 	for (auto line : xrange(minLine, maxLine)) {
-		int minXCollision = 999; // no collision
-		std::span<SpriteInfo, 32 + 1> visibleSprites = spriteBuffer[line];
-		for (int i = std::min<int>(8, spriteCount[line]); --i >= 1; /**/) {
-			auto colorAttrib1 = visibleSprites[i].colorAttrib;
-			if (!can0collide && ((colorAttrib1 & 0xf) == 0)) continue;
-			// If CC or IC is set, this sprite cannot collide.
-			if (colorAttrib1 & 0x60) continue;
-
-			int x_i = visibleSprites[i].x;
-			SpritePattern pattern_i = visibleSprites[i].pattern;
-			for (int j = i; --j >= 0; /**/) {
-				auto colorAttrib2 = visibleSprites[j].colorAttrib;
-				if (!can0collide && ((colorAttrib2 & 0xf) == 0)) continue;
-				// If CC or IC is set, this sprite cannot collide.
-				if (colorAttrib2 & 0x60) continue;
-
-				// Do sprite i and sprite j collide?
-				int x_j = visibleSprites[j].x;
-				int dist = x_j - x_i;
-				if ((-magSize < dist) && (dist < magSize)) {
-					SpritePattern pattern_j = visibleSprites[j].pattern;
-					if (dist < 0) {
-						pattern_j <<= -dist;
-					} else {
-						pattern_j >>= dist;
-					}
-					SpritePattern colPat = pattern_i & pattern_j;
-					if (x_i < 0) {
-						assert(x_i >= -32);
-						colPat &= (1 << (32 + x_i)) - 1;
-					}
-					if (colPat) {
-						int xCollision = x_i + std::countl_zero(colPat);
-						assert(xCollision >= 0);
-						minXCollision = std::min(minXCollision, xCollision);
-					}
-				}
-			}
-		}
-		if (minXCollision < 256) {
+		int count = std::min<int>(8, spriteCount[line]);
+		if (count < 2) continue;
+		int xCollision = findCollision(subspan(spriteBuffer[line], 0, count),
+		                               0x60, can0collide);
+		if (xCollision >= 0) {
 			vdp.setSpriteStatus(vdp.getStatusReg0() | 0x20);
 			// x-coord should be increased by 12
 			// y-coord                         8
-			collisionX = minXCollision + 12;
+			collisionX = xCollision + 12;
 			collisionY = line - vdp.getLineZero() + 8;
 			return; // don't check lines with higher Y-coord
 		}
 	}
 }
 
+int SpriteChecker::findCollision(
+	std::span<const SpriteInfo> sprites, byte noCollideMask, bool can0collide)
+{
+	// Instead of checking every pair of sprites (up to 28 pairs in sprite
+	// mode 2), OR all sprite patterns together in a bitmap covering the
+	// whole line. A pixel collides when it was already set before the
+	// current sprite is added. This gives exactly the same result as
+	// taking the union of all pairwise overlaps.
+	//
+	// Bit layout: one bit per pixel for x-coordinates [-32..288), the
+	// leftmost pixel is stored in the most significant bit of word 0.
+	static constexpr int OFFSET = 32;
+	std::array<uint64_t, 5> covered = {};
+	std::array<uint64_t, 5> collided = {};
+	for (const auto& sprite : sprites) {
+		auto colorAttrib = sprite.colorAttrib;
+		if (!can0collide && ((colorAttrib & 0xf) == 0)) continue;
+		// If CC or IC is set, this sprite cannot collide.
+		if (colorAttrib & noCollideMask) continue;
+
+		assert((-32 <= sprite.x) && (sprite.x < 256));
+		auto pos = unsigned(sprite.x + OFFSET);
+		auto w = pos / 64;
+		auto s = pos % 64;
+		uint64_t pattern = uint64_t(sprite.pattern) << 32;
+		uint64_t hi = pattern >> s;
+		collided[w] |= covered[w] & hi;
+		covered[w] |= hi;
+		if (s > 32) {
+			// pattern straddles two words
+			uint64_t lo = pattern << (64 - s);
+			collided[w + 1] |= covered[w + 1] & lo;
+			covered[w + 1] |= lo;
+		}
+	}
+
+	// Sprites cannot collide in the left border ...
+	collided[0] &= 0xFFFF'FFFF;
+	for (auto w : xrange(collided.size())) {
+		if (auto c = collided[w]) {
+			int x = narrow<int>(64 * w) + std::countl_zero(c) - OFFSET;
+			// ... nor in the right border.
+			return (x < 256) ? x : -1;
+		}
+	}
+	return -1;
+}
+
 // version 1: initial version
 // version 2: bug fix: also serialize 'currentLine'
 template<typename Archive>
@@ -10,6 +10,7 @@
 #include "serialize_meta.hh"
 #include "unreachable.hh"
 #include <array>
+#include <bitset>
 #include <cstdint>
 #include <span>
 
@@ -18,7 +19,7 @@ namespace openmsx {
 class RenderSettings;
 class BooleanSetting;
 
-class SpriteChecker final : public VRAMObserver
+class SpriteChecker final
 {
 public:
 	/** Bitmap of length 32 describing a sprite pattern.
@@ -58,6 +59,20 @@ public:
 		return a | (a >> 1);             // aabbccddeeffgghhiijjkkllmmnnoopp
 	}
 
+	/** Find the left-most pixel where (at least) two sprites overlap.
+	  * Only pixels within the visible area [0..256) are considered.
+	  * @param sprites The sprites on a single line.
+	  * @param noCollideMask Sprites with any of these color attribute
+	  *   bits set are ignored (0x60 (CC, IC) in sprite mode 2, 0 in
+	  *   sprite mode 1).
+	  * @param can0collide Can sprites with color 0 collide?
+	  * @return The x-coordinate of the collision, or -1 if there's no
+	  *   collision on this line.
+	  */
+	[[nodiscard]] static int findCollision(
+		std::span<const SpriteInfo> sprites, byte noCollideMask,
+		bool can0collide);
+
 	/** Create a sprite checker.
 	  * @param vdp The VDP this sprite checker is part of.
 	  * @param renderSettings TODO
@@ -155,7 +170,9 @@ public:
 	inline void updateSpriteSizeMag(byte sizeMag, EmuTime::param time) {
 		(void)sizeMag;
 		sync(time);
-		// TODO: Precalc something?
+		// Both the masked pattern numbers and the patterns themselves
+		// depend on size and magnification.
+		invalidateCaches();
 	}
 
 	/** Informs the sprite checker of a change in the TP bit (R#8 bit 5)
@@ -260,29 +277,47 @@ public:
 		return subspan(spriteBuffer[line], 0, spriteCount[line]);
 	}
 
-	// VRAMObserver implementation:
-
-	void updateVRAM(unsigned /*offset*/, EmuTime::param time) override {
-		checkUntil(time);
-	}
-
-	void updateWindow(bool /*enabled*/, EmuTime::param time) override {
-		sync(time);
+	/** Informs the sprite checker that the VRAM content was moved around
+	  * without going through the VRAM windows (e.g. VR mode switch or
+	  * TMS99xx 4k/8k remapping).
+	  */
+	inline void updateVRAMLayout() {
+		invalidateCaches();
 	}
 
 	template<typename Archive>
 	void serialize(Archive& ar, unsigned version);
 
 private:
+	/** Sprite attribute table entry, as decoded by getAttributes1/2().
+	  */
+	struct SpriteAttribute {
+		/** X-coordinate, in sprite mode 1 already corrected for early
+		  * clock (in sprite mode 2 the EC bit is per line).
+		  */
+		int16_t x;
+		uint8_t y;
+		/** Pattern number, already masked for 16x16 sprites.
+		  */
+		uint8_t patternNr;
+		/** Only used in sprite mode 1, sprite mode 2 has a color per line.
+		  */
+		byte colorAttrib;
+	};
+
 	/** Calculate 'updateSpritesMethod' and 'planar'.
 	  */
 	inline void setDisplayMode(DisplayMode mode) {
+		// Attribute table layout differs between sprite mode 1 and 2 and
+		// between planar and non-planar modes.
+		invalidateCaches();
 		switch (mode.getSpriteMode(vdp.isMSX1VDP())) {
 		case 0:
 			updateSpritesMethod = nullptr;
 			break;
 		case 1:
 			updateSpritesMethod = &SpriteChecker::updateSprites1;
+			planar = false;
 			break;
 		case 2:
 			updateSpritesMethod = &SpriteChecker::updateSprites2;
@@ -314,6 +349,27 @@ private:
 	[[nodiscard]] inline SpritePattern calculatePatternNP(unsigned patternNr, unsigned y) const;
 	[[nodiscard]] inline SpritePattern calculatePatternPlanar(unsigned patternNr, unsigned y) const;
 
+	/** Same as calculatePatternNP() or calculatePatternPlanar() (depending
+	  * on the current display mode), but the result is cached until the
+	  * sprite pattern table changes.
+	  */
+	[[nodiscard]] inline SpritePattern getPattern(unsigned patternNr, unsigned y);
+
+	/** Get the decoded sprite attribute table, only includes the sprites
+	  * up to (excluding) the terminating sprite (Y=208 in sprite mode 1,
+	  * Y=216 in sprite mode 2).
+	  * The result is cached until the sprite attribute table changes.
+	  */
+	[[nodiscard]] inline std::span<const SpriteAttribute> getAttributes1();
+	[[nodiscard]] inline std::span<const SpriteAttribute> getAttributes2();
+
+	/** Forget all decoded sprite attributes and patterns.
+	  */
+	inline void invalidateCaches() {
+		attribCacheSize = -1;
+		patternCacheValid.reset();
+	}
+
 	/** Check sprite collision and number of sprites per line.
 	  * This routine implements sprite mode 1 (MSX1).
 	  * Separated from display code to make MSX behaviour consistent
@@ -339,6 +395,20 @@ private:
 	inline void checkSprites2(int minLine, int maxLine);
 
 private:
+	/** Observes the sprite attribute table, invalidates 'attribCache'.
+	  */
+	struct AttribTableObserver final : VRAMObserver {
+		void updateVRAM(unsigned offset, EmuTime::param time) override;
+		void updateWindow(bool enabled, EmuTime::param time) override;
+	} attribTableObserver;
+
+	/** Observes the sprite pattern table, invalidates 'patternCache'.
+	  */
+	struct PatternTableObserver final : VRAMObserver {
+		void updateVRAM(unsigned offset, EmuTime::param time) override;
+		void updateWindow(bool enabled, EmuTime::param time) override;
+	} patternTableObserver;
+
 	using UpdateSpritesMethod = void (SpriteChecker::*)(int limit);
 	UpdateSpritesMethod updateSpritesMethod;
 
@@ -393,7 +463,23 @@ private:
 	/** Is current display mode planar or not?
 	  * TODO: Introduce separate update methods for planar/non-planar modes.
 	  */
-	bool planar;
+	bool planar = false;
+
+	/** Decoded sprite attribute table, see getAttributes1/2().
+	  * Only the first 'attribCacheSize' entries are valid.
+	  */
+	std::array<SpriteAttribute, 32> attribCache;
+
+	/** Number of valid entries in 'attribCache', or -1 when it must be
+	  * (re)decoded from VRAM.
+	  */
+	int attribCacheSize = -1;
+
+	/** Decoded sprite patterns (corrected for size and magnification),
+	  * indexed by 'patternNr * 8 + y', see getPattern().
+	  */
+	std::array<SpritePattern, 256 * 8> patternCache;
+	std::bitset<256 * 8> patternCacheValid;
 };
 SERIALIZE_CLASS_VERSION(SpriteChecker, 2);
 
@@ -862,8 +862,10 @@ void VDP::executeCpuVramAccess(EmuTime::param time)
 	}();
 	if (doAccess) {
 		if (cpuVramReqIsRead) {
+			vram->countCpuAccess(AccessStats::Type::READ, addr);
 			cpuVramData = vram->cpuRead(addr, time);
 		} else {
+			vram->countCpuAccess(AccessStats::Type::WRITE, addr);
 			vram->cpuWrite(addr, cpuVramData, time);
 		}
 	} else {
@@ -1,5 +1,6 @@
 #include "VDPVRAM.hh"
 #include "SpriteChecker.hh"
+#include "MSXMotherBoard.hh"
 #include "Renderer.hh"
 #include "outer.hh"
 #include "ranges.hh"
@@ -62,6 +63,21 @@ void VDPVRAM::LogicalVRAMDebuggable::write(
 	vram.cpuWrite(transform(address), value, time);
 }
 
+void VDPVRAM::LogicalVRAMDebuggable::readBlock(unsigned start, std::span<byte> output)
+{
+	auto& vram = OUTER(VDPVRAM, logicalVRAMDebug);
+	vram.cpuReadBlock(start, output, vram.vdp.getCurrentTime(),
+	                  [&](unsigned address) { return transform(address); });
+}
+
+void VDPVRAM::LogicalVRAMDebuggable::peekBlock(unsigned start, std::span<byte> output)
+{
+	auto& vram = OUTER(VDPVRAM, logicalVRAMDebug);
+	for (auto& b : output) {
+		b = vram.data[transform(start++) & vram.sizeMask];
+	}
+}
+
 
 // class PhysicalVRAMDebuggable
 
@@ -87,6 +103,21 @@ void VDPVRAM::PhysicalVRAMDebuggable::write(
 	vram.cpuWrite(address, value, time);
 }
 
+void VDPVRAM::PhysicalVRAMDebuggable::readBlock(unsigned start, std::span<byte> output)
+{
+	auto& vram = OUTER(VDPVRAM, physicalVRAMDebug);
+	vram.cpuReadBlock(start, output, vram.vdp.getCurrentTime(),
+	                  [](unsigned address) { return address; });
+}
+
+void VDPVRAM::PhysicalVRAMDebuggable::peekBlock(unsigned start, std::span<byte> output)
+{
+	auto& vram = OUTER(VDPVRAM, physicalVRAMDebug);
+	for (auto& b : output) {
+		b = vram.data[start++ & vram.sizeMask];
+	}
+}
+
 
 // class VDPVRAM
 
@@ -105,6 +136,10 @@ VDPVRAM::VDPVRAM(VDP& vdp_, unsigned size, EmuTime::param time)
 	, data(*vdp_.getDeviceConfig2().getXML(), bufferSize(size))
 	, logicalVRAMDebug (vdp)
 	, physicalVRAMDebug(vdp, size)
+	, accessRegion(vdp.getMotherBoard().getAccessStats(),
+	               physicalVRAMDebug.getName(), data.size(),
+	               AccessStats::typeBit(AccessStats::Type::READ) |
+	               AccessStats::typeBit(AccessStats::Type::WRITE))
 	#ifdef DEBUG
 	, vramTime(EmuTime::zero())
 	#endif
@@ -216,6 +251,7 @@ void VDPVRAM::updateVRMode(bool newVRmode, EmuTime::param time)
 			std::swap(data[i], data[swapAddr(i)]);
 		}
 	}
+	spriteChecker->updateVRAMLayout();
 }
 
 void VDPVRAM::setRenderer(Renderer* newRenderer, EmuTime::param time)
@@ -297,6 +333,7 @@ void VDPVRAM::change4k8kMapping(bool mapping8k)
 	}
 	//ranges::copy(tmp, std::span{data}); // TODO error with clang-15/libc++
 	ranges::copy(tmp, std::span{data.begin(), data.end()});
+	spriteChecker->updateVRAMLayout();
 }
 
 